@@ -23,6 +23,9 @@
 #ifndef DCCLCOMPAT20131116H
 #define DCCLCOMPAT20131116H
 
+#include <iterator>
+#include <map>
+
 #include "goby/acomms/acomms_helpers.h" // for operator<< of google::protobuf::Message
 #include "goby/acomms/protobuf/dccl.pb.h"
 #include "goby/common/logger.h"
@@ -171,10 +174,15 @@ class DCCLCodec
     static const std::string& glog_encode_group() { return glog_encode_group_; }
     static const std::string& glog_decode_group() { return glog_decode_group_; }
 
-    void encode(std::string* bytes, const google::protobuf::Message& msg, bool header_only = false)
+    /// \brief Encode a message
+    ///
+    /// \return the encoded size in bytes (no separate call to size() is needed)
+    unsigned encode(std::string* bytes, const google::protobuf::Message& msg,
+                    bool header_only = false)
     {
         bytes->clear();
         codec_->encode(bytes, msg, header_only);
+        return bytes->size();
     }
 
     void decode(const std::string& bytes, google::protobuf::Message* msg, bool header_only = false)
@@ -182,12 +190,48 @@ class DCCLCodec
         codec_->decode(bytes, msg, header_only);
     }
 
+    /// \brief Decode the message at the beginning of [begin, end), which may be followed by other data
+    ///
+    /// \return the number of bytes consumed (the encoded size of the message)
+    template <typename CharIterator>
+    unsigned decode(CharIterator begin, CharIterator end, google::protobuf::Message* msg,
+                    bool header_only = false)
+    {
+        return std::distance(begin, codec_->decode(begin, end, msg, header_only));
+    }
+
+    /// \brief Decode the message at the beginning of [begin, end) into a new message of the type given by its DCCL id
+    ///
+    /// \param consumed set to the number of bytes consumed (the encoded size of the message)
+    template <typename GoogleProtobufMessagePointer, typename CharIterator>
+    GoogleProtobufMessagePointer decode(CharIterator begin, CharIterator end, unsigned* consumed,
+                                        bool header_only = false)
+    {
+        unsigned this_id = codec_->id(begin, end);
+        std::map<unsigned, const google::protobuf::Descriptor*>::const_iterator it =
+            id2desc_.find(this_id);
+        if (it == id2desc_.end())
+        {
+            // loaded directly through codec(), so let dccl find the type (or throw)
+            GoogleProtobufMessagePointer header = codec_->decode<GoogleProtobufMessagePointer>(
+                std::string(begin, end), true);
+            it = id2desc_.insert(std::make_pair(this_id, header->GetDescriptor())).first;
+        }
+
+        GoogleProtobufMessagePointer msg =
+            dccl::DynamicProtobufManager::new_protobuf_message<GoogleProtobufMessagePointer>(
+                it->second);
+        *consumed = decode(begin, end, &(*msg), header_only);
+        return msg;
+    }
+
     unsigned id_from_encoded(const std::string& bytes) { return codec_->id(bytes); }
 
     void validate(const google::protobuf::Descriptor* desc)
     {
         codec_->load(desc);
         loaded_msgs_.insert(desc);
+        id2desc_[id(desc)] = desc;
     }
 
     void validate_repeated(const std::list<const google::protobuf::Descriptor*>& descs)
@@ -232,9 +276,9 @@ class DCCLCodec
     std::string encode_repeated(const std::list<GoogleProtobufMessagePointer>& msgs)
     {
         std::string out;
+        std::string piece;
         BOOST_FOREACH (const GoogleProtobufMessagePointer& msg, msgs)
         {
-            std::string piece;
             encode(&piece, *msg);
             out += piece;
         }
@@ -243,19 +287,21 @@ class DCCLCodec
     }
 
     template <typename GoogleProtobufMessagePointer>
-    std::list<GoogleProtobufMessagePointer> decode_repeated(const std::string& orig_bytes)
+    std::list<GoogleProtobufMessagePointer> decode_repeated(const std::string& bytes)
     {
-        std::string bytes = orig_bytes;
         std::list<GoogleProtobufMessagePointer> out;
-        while (!bytes.empty())
+        std::string::const_iterator it = bytes.begin(), end = bytes.end();
+        while (it != end)
         {
             try
             {
-                out.push_back(decode<GoogleProtobufMessagePointer>(bytes));
-                unsigned last_size = size(*out.back());
+                unsigned last_size = 0;
+                out.push_back(decode<GoogleProtobufMessagePointer>(it, end, &last_size));
                 glog.is(common::logger::DEBUG1) && glog << "last message size was: " << last_size
                                                         << std::endl;
-                bytes.erase(0, last_size);
+                if (last_size == 0)
+                    throw(DCCLException("Decoded message consumed no bytes"));
+                it += last_size;
             }
             catch (dccl::Exception& e)
             {
@@ -264,7 +310,7 @@ class DCCLCodec
                 else
                 {
                     glog.is(common::logger::WARN) &&
-                        glog << "failed to decode " << goby::util::hex_encode(bytes)
+                        glog << "failed to decode " << goby::util::hex_encode(std::string(it, end))
                              << " but returning parts already decoded" << std::endl;
                     return out;
                 }
@@ -358,6 +404,8 @@ class DCCLCodec
 
     std::set<void*> loaded_libs_;
     std::set<const google::protobuf::Descriptor*> loaded_msgs_;
+    // DCCL id to Descriptor for the messages we have decoded or loaded
+    std::map<unsigned, const google::protobuf::Descriptor*> id2desc_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const DCCLCodec& codec)
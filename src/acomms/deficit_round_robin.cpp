@@ -0,0 +1,92 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include "deficit_round_robin.h"
+
+bool goby::acomms::DeficitRoundRobin::choose(const std::map<int, Backlog>& backlog, int* dest)
+{
+    // unused credit is dropped once a queue empties (debt is kept)
+    for (std::map<int, int>::iterator it = deficit_.begin(); it != deficit_.end();)
+    {
+        if (it->second >= 0 && !backlog.count(it->first))
+            deficit_.erase(it++);
+        else
+            ++it;
+    }
+
+    if (backlog.empty())
+        return false;
+
+    typedef std::map<int, Backlog>::const_iterator Iterator;
+    const Iterator first = backlog.lower_bound(next_dest_);
+    order_.clear();
+    for (Iterator it = first, end = backlog.end(); it != end; ++it) order_.push_back(it);
+    for (Iterator it = backlog.begin(); it != first; ++it) order_.push_back(it);
+
+    // a destination that is part way through its turn gets no new credit on its first visit
+    const bool in_turn = in_turn_ && order_.front()->first == next_dest_;
+    in_turn_ = false;
+
+    // visit v (counting from 0) goes to order_[v % n]: find the first visit at which a
+    // destination has enough credit, rather than stepping through the rounds one at a time
+    const long n = order_.size();
+    long win_visit = -1;
+    long win = 0;
+    for (long k = 0; k < n; ++k)
+    {
+        const Backlog& b = order_[k]->second;
+        long quantum = std::max(1, b.quantum);
+        long need = static_cast<long>(b.head_size) - deficit(order_[k]->first);
+        long credits = need > 0 ? (need + quantum - 1) / quantum : 0;
+        long rounds = (k == 0 && in_turn) ? credits : std::max(credits, 1L) - 1;
+        long visit = rounds * n + k;
+        if (win_visit < 0 || visit < win_visit)
+        {
+            win_visit = visit;
+            win = k;
+        }
+    }
+
+    // credit every destination for the visits made up to and including the winning one
+    for (long k = 0; k < n && k <= win_visit; ++k)
+    {
+        long visits = (win_visit - k) / n + 1;
+        if (k == 0 && in_turn)
+            --visits;
+        if (visits > 0)
+            deficit_[order_[k]->first] += visits * std::max(1, order_[k]->second.quantum);
+    }
+
+    *dest = order_[win]->first;
+    return true;
+}
+
+void goby::acomms::DeficitRoundRobin::end_turn(int dest, int next_head_size)
+{
+    if (next_head_size == 0 && deficit(dest) > 0)
+        deficit_.erase(dest);
+
+    in_turn_ = next_head_size > 0 && deficit(dest) >= next_head_size;
+    next_dest_ = in_turn_ ? dest : dest + 1;
+}
@@ -0,0 +1,86 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DeficitRoundRobin20190312H
+#define DeficitRoundRobin20190312H
+
+#include <map>
+#include <vector>
+
+namespace goby
+{
+namespace acomms
+{
+/// \brief Deficit round robin choice of the destination to serve next (used by goby_ip_gateway).
+///
+/// Each visit credits a backlogged destination its quantum (bytes); the first destination whose
+/// credit covers the packet at the front of its queue is served. The visits needed are added up
+/// in one step, so a quantum much smaller than the packets costs no more than one the size of
+/// the MTU.
+class DeficitRoundRobin
+{
+  public:
+    struct Backlog
+    {
+        Backlog(int head_size = 0, int quantum = 1) : head_size(head_size), quantum(quantum) {}
+        int head_size; // bytes of the packet at the front of the queue
+        int quantum;   // credit per visit (bytes), values below one are treated as one
+    };
+
+    DeficitRoundRobin() : next_dest_(0), in_turn_(false) {}
+
+    /// \brief Choose the destination to serve next and credit the visits made to reach it
+    ///
+    /// \param backlog destinations with at least one packet queued (keyed by destination)
+    /// \param dest set to the chosen destination
+    /// \return false if backlog is empty
+    bool choose(const std::map<int, Backlog>& backlog, int* dest);
+
+    /// \brief Charge `dest` for a packet sent (may overdraw the credit)
+    void sent(int dest, int bytes) { deficit_[dest] -= bytes; }
+
+    /// \brief Finish serving `dest`, keeping its turn while the remaining credit covers the next
+    /// packet
+    ///
+    /// \param next_head_size bytes of the packet now at the front of the queue (0 if empty)
+    void end_turn(int dest, int next_head_size);
+
+    /// \brief Current credit of `dest` (bytes), negative after overdrawing
+    int deficit(int dest) const
+    {
+        std::map<int, int>::const_iterator it = deficit_.find(dest);
+        return it == deficit_.end() ? 0 : it->second;
+    }
+
+  private:
+    std::map<int, int> deficit_;
+    // the round resumes from the first destination >= this one
+    int next_dest_;
+    // true if next_dest_ is part way through its turn (already credited)
+    bool in_turn_;
+    // backlogged destinations in visiting order, reused between calls
+    std::vector<std::map<int, Backlog>::const_iterator> order_;
+};
+} // namespace acomms
+} // namespace goby
+
+#endif
@@ -0,0 +1,191 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <vector>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAS_LZMA
+#include <lzma.h>
+#endif
+
+#include "goby/common/exception.h"
+#include "goby/util/as.h"
+
+#include "file_compression.h"
+
+using goby::acomms::protobuf::TransferRequest;
+
+namespace
+{
+#ifdef HAS_ZLIB
+// the zlib container (rather than raw deflate) costs six bytes but lets the adler32 checksum
+// catch a file that was reassembled incorrectly
+bool zlib_compress(const std::string& in, std::string* out)
+{
+    uLongf out_size = compressBound(in.size());
+    std::vector<Bytef> buffer(out_size);
+    if (compress2(&buffer[0], &out_size, reinterpret_cast<const Bytef*>(in.data()), in.size(),
+                  Z_BEST_COMPRESSION) != Z_OK)
+        return false;
+    out->assign(buffer.begin(), buffer.begin() + out_size);
+    return true;
+}
+
+void zlib_decompress(const std::string& in, std::string* out, std::size_t max_size)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    stream.avail_in = in.size();
+    if (inflateInit(&stream) != Z_OK)
+        throw goby::Exception("Failed to initialize zlib");
+
+    // one byte of headroom distinguishes "exactly max_size" from "too large"
+    std::vector<Bytef> buffer(max_size + 1);
+    stream.next_out = &buffer[0];
+    stream.avail_out = buffer.size();
+
+    int result = inflate(&stream, Z_FINISH);
+    std::size_t size = stream.total_out;
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END || size > max_size)
+        throw goby::Exception("Invalid zlib data or uncompressed size exceeds " +
+                              goby::util::as<std::string>(max_size) + " bytes");
+
+    out->assign(buffer.begin(), buffer.begin() + size);
+}
+#endif
+
+#ifdef HAS_LZMA
+// raw LZMA2 with a fixed dictionary avoids the ~60 bytes of .xz container overhead, which is
+// a whole fragment; both sides must agree on the filter chain
+struct LZMAFilters
+{
+    LZMAFilters()
+    {
+        lzma_lzma_preset(&options, 9);
+        options.dict_size = 1 << 20;
+        filters[0].id = LZMA_FILTER_LZMA2;
+        filters[0].options = &options;
+        filters[1].id = LZMA_VLI_UNKNOWN;
+        filters[1].options = NULL;
+    }
+    lzma_options_lzma options;
+    lzma_filter filters[2];
+};
+
+bool lzma_compress(const std::string& in, std::string* out)
+{
+    LZMAFilters lzma;
+    // worst case expansion for LZMA2 is well under 1%
+    std::vector<uint8_t> buffer(in.size() + in.size() / 64 + 64);
+    size_t out_pos = 0;
+    if (lzma_raw_buffer_encode(lzma.filters, NULL, reinterpret_cast<const uint8_t*>(in.data()),
+                               in.size(), &buffer[0], &out_pos, buffer.size()) != LZMA_OK)
+        return false;
+    out->assign(buffer.begin(), buffer.begin() + out_pos);
+    return true;
+}
+
+void lzma_decompress(const std::string& in, std::string* out, std::size_t max_size)
+{
+    LZMAFilters lzma;
+    std::vector<uint8_t> buffer(max_size + 1);
+    size_t in_pos = 0, out_pos = 0;
+    if (lzma_raw_buffer_decode(lzma.filters, NULL, reinterpret_cast<const uint8_t*>(in.data()),
+                               &in_pos, in.size(), &buffer[0], &out_pos,
+                               buffer.size()) != LZMA_OK ||
+        out_pos > max_size)
+        throw goby::Exception("Invalid LZMA data or uncompressed size exceeds " +
+                              goby::util::as<std::string>(max_size) + " bytes");
+
+    out->assign(buffer.begin(), buffer.begin() + out_pos);
+}
+#endif
+} // namespace
+
+bool goby::acomms::compression_available(TransferRequest::Compression compression)
+{
+    switch (compression)
+    {
+        case TransferRequest::UNCOMPRESSED: return true;
+#ifdef HAS_ZLIB
+        case TransferRequest::ZLIB: return true;
+#endif
+#ifdef HAS_LZMA
+        case TransferRequest::LZMA: return true;
+#endif
+        default: return false;
+    }
+}
+
+TransferRequest::Compression goby::acomms::compress(TransferRequest::Compression compression,
+                                                    const std::string& in, std::string* out)
+{
+    bool compressed = false;
+    switch (compression)
+    {
+#ifdef HAS_ZLIB
+        case TransferRequest::ZLIB: compressed = zlib_compress(in, out); break;
+#endif
+#ifdef HAS_LZMA
+        case TransferRequest::LZMA: compressed = lzma_compress(in, out); break;
+#endif
+        default: break;
+    }
+
+    // already compressed (or random) data usually grows slightly, so send it as is
+    if (compressed && out->size() < in.size())
+        return compression;
+
+    *out = in;
+    return TransferRequest::UNCOMPRESSED;
+}
+
+void goby::acomms::decompress(TransferRequest::Compression compression, const std::string& in,
+                              std::string* out, std::size_t max_size)
+{
+    switch (compression)
+    {
+        case TransferRequest::UNCOMPRESSED:
+            if (in.size() > max_size)
+                throw goby::Exception("Data size exceeds " +
+                                      goby::util::as<std::string>(max_size) + " bytes");
+            *out = in;
+            break;
+#ifdef HAS_ZLIB
+        case TransferRequest::ZLIB: zlib_decompress(in, out, max_size); break;
+#endif
+#ifdef HAS_LZMA
+        case TransferRequest::LZMA: lzma_decompress(in, out, max_size); break;
+#endif
+        default:
+            throw goby::Exception("Compression " + TransferRequest::Compression_Name(compression) +
+                                  " is not supported by this build");
+    }
+}
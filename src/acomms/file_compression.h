@@ -0,0 +1,58 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FileCompression20181120H
+#define FileCompression20181120H
+
+#include <string>
+
+#include "goby/acomms/protobuf/file_transfer.pb.h"
+
+namespace goby
+{
+namespace acomms
+{
+/// \brief Whether this build of Goby can compress and decompress using the given algorithm (zlib and LZMA support depend on the libraries found at configure time).
+bool compression_available(protobuf::TransferRequest::Compression compression);
+
+/// \brief Compress a file payload before it is fragmented.
+///
+/// \param compression Algorithm to try
+/// \param in Uncompressed data
+/// \param out Set to the bytes to send
+/// \return Algorithm actually applied to `out`. This is protobuf::TransferRequest::UNCOMPRESSED (and `out` is a copy of `in`) if the requested algorithm is unavailable or does not make the data smaller.
+protobuf::TransferRequest::Compression compress(protobuf::TransferRequest::Compression compression,
+                                                const std::string& in, std::string* out);
+
+/// \brief Reverse compress()
+///
+/// \param compression Algorithm returned by compress()
+/// \param in Compressed data
+/// \param out Set to the uncompressed data
+/// \param max_size Largest uncompressed size accepted
+/// \throw goby::Exception Data are corrupt, larger than `max_size` or the algorithm is unavailable
+void decompress(protobuf::TransferRequest::Compression compression, const std::string& in,
+                std::string* out, std::size_t max_size);
+} // namespace acomms
+} // namespace goby
+
+#endif
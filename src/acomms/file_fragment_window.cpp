@@ -0,0 +1,315 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+
+#include "file_fragment_window.h"
+
+using goby::acomms::protobuf::FileFragment;
+using goby::acomms::protobuf::FileFragmentNack;
+using goby::acomms::protobuf::TransferRequest;
+
+namespace
+{
+int max_length(const google::protobuf::Descriptor* desc, const std::string& field)
+{
+    return desc->FindFieldByName(field)->options().GetExtension(dccl::field).max_length();
+}
+
+// fragments covered by the FileFragmentNack::missing bitmap
+int nack_bits()
+{
+    static const int bits = 8 * max_length(FileFragmentNack::descriptor(), "missing");
+    return bits;
+}
+} // namespace
+
+int goby::acomms::FileFragmentSender::fragment_size()
+{
+    static const int size = max_length(FileFragment::descriptor(), "data");
+    return size;
+}
+
+goby::acomms::FileFragmentSender::FileFragmentSender()
+    : compression_(TransferRequest::UNCOMPRESSED), window_size_(0), retransmit_timeout_(0),
+      num_fragments_(0), next_new_(0), acked_through_(0), in_flight_(0), num_acked_(0), seq_(0),
+      rto_backoff_(1), last_feedback_time_(0), retransmit_time_(0), nack_received_through_(-1),
+      nack_highest_received_(-1), nack_seq_(0)
+{
+}
+
+goby::acomms::FileFragmentSender::FileFragmentSender(const std::string& data,
+                                                     TransferRequest::Compression compression,
+                                                     int window_size, double retransmit_timeout,
+                                                     double now)
+    : data_(data), compression_(compression), window_size_(window_size),
+      retransmit_timeout_(retransmit_timeout),
+      num_fragments_(std::ceil(static_cast<double>(data.size()) / fragment_size())),
+      state_(num_fragments_, UNSENT), send_seq_(num_fragments_, 0), next_new_(0),
+      acked_through_(0), in_flight_(0), num_acked_(0), seq_(0), rto_backoff_(1),
+      last_feedback_time_(0), retransmit_time_(0), nack_received_through_(-1),
+      nack_highest_received_(-1), nack_seq_(0)
+{
+    reset_timer(now);
+}
+
+void goby::acomms::FileFragmentSender::reset_timer(double now)
+{
+    last_feedback_time_ = now;
+    restart_timer(now);
+}
+
+void goby::acomms::FileFragmentSender::restart_timer(double now)
+{
+    rto_backoff_ = 1;
+    retransmit_time_ = now + retransmit_timeout_;
+}
+
+void goby::acomms::FileFragmentSender::ack(int index)
+{
+    if (state_[index] == IN_FLIGHT)
+        --in_flight_;
+    if (state_[index] != ACKED)
+    {
+        state_[index] = ACKED;
+        ++num_acked_;
+    }
+}
+
+void goby::acomms::FileFragmentSender::lose(int index)
+{
+    if (state_[index] == IN_FLIGHT)
+    {
+        --in_flight_;
+        state_[index] = LOST;
+        lost_.push_back(index);
+    }
+}
+
+bool goby::acomms::FileFragmentSender::next_fragment(int* index)
+{
+    if (in_flight_ >= window_size_)
+        return false;
+
+    // retransmissions take priority over new data
+    int next = -1;
+    while (next < 0 && !lost_.empty())
+    {
+        if (state_[lost_.front()] == LOST)
+            next = lost_.front();
+        lost_.pop_front();
+    }
+
+    if (next < 0)
+    {
+        // skip fragments the receiver already holds from an earlier attempt
+        while (next_new_ < num_fragments_ && state_[next_new_] != UNSENT) ++next_new_;
+        if (next_new_ == num_fragments_)
+            return false;
+        next = next_new_++;
+    }
+
+    state_[next] = IN_FLIGHT;
+    send_seq_[next] = ++seq_;
+    ++in_flight_;
+    *index = next;
+    return true;
+}
+
+void goby::acomms::FileFragmentSender::get_fragment(int index, FileFragment* fragment) const
+{
+    const int begin = index * fragment_size();
+    const int bytes = std::min<int>(fragment_size(), data_.size() - begin);
+
+    fragment->set_fragment(index);
+    fragment->set_is_last_fragment(index == num_fragments_ - 1);
+    fragment->set_num_bytes(bytes);
+    fragment->set_data(data_.substr(begin, bytes));
+    fragment->set_compression(compression_);
+}
+
+bool goby::acomms::FileFragmentSender::handle_nack(const FileFragmentNack& nack, double now)
+{
+    if (nack.received_through() > num_fragments_ || nack.highest_received() >= num_fragments_)
+        return false;
+
+    last_feedback_time_ = now;
+
+    // NACKs are also repeated while the receiver hears nothing, so only progress holds off the
+    // retransmission timer
+    if (nack.received_through() > nack_received_through_ ||
+        nack.highest_received() > nack_highest_received_)
+    {
+        nack_received_through_ = std::max(nack_received_through_, nack.received_through());
+        nack_highest_received_ = std::max(nack_highest_received_, nack.highest_received());
+        restart_timer(now);
+    }
+
+    // the receiver has heard nothing for a while, so fragments past the highest received that
+    // were already sent by the previous NACK are lost (e.g. the end of the file). Other NACKs
+    // can't tell these from fragments still waiting in the queue.
+    if (nack.idle())
+    {
+        for (int i = nack.highest_received() + 1; i < num_fragments_; ++i)
+        {
+            if (state_[i] == IN_FLIGHT && send_seq_[i] <= nack_seq_)
+                lose(i);
+        }
+    }
+    nack_seq_ = seq_;
+
+    for (; acked_through_ < nack.received_through(); ++acked_through_) ack(acked_through_);
+
+    // a missing fragment is only lost if something sent after it has already arrived;
+    // otherwise it is most likely still waiting in the queue
+    const std::string& missing = nack.missing();
+    const unsigned newest_seq = send_seq_[nack.highest_received()];
+    const int span = std::min(nack.highest_received() - nack.received_through() + 1, nack_bits());
+    for (int i = 0; i < span; ++i)
+    {
+        const int index = nack.received_through() + i;
+        const bool is_missing =
+            i / 8 < static_cast<int>(missing.size()) && (missing[i / 8] & (1 << (i % 8)));
+        if (!is_missing)
+            ack(index);
+        else if (send_seq_[index] < newest_seq)
+            lose(index);
+    }
+    return true;
+}
+
+void goby::acomms::FileFragmentSender::handle_fragment_ack(int index, double now)
+{
+    if (index < 0 || index >= num_fragments_)
+        return;
+
+    last_feedback_time_ = now;
+    if (state_[index] != ACKED)
+    {
+        ack(index);
+        restart_timer(now);
+    }
+}
+
+goby::acomms::FileFragmentSender::TimerAction
+goby::acomms::FileFragmentSender::check_timer(double now)
+{
+    if (now <= retransmit_time_)
+        return TIMER_NONE;
+
+    TimerAction action = TIMER_NONE;
+    if (in_flight_ > 0)
+    {
+        for (int i = 0; i < num_fragments_; ++i) lose(i);
+        action = TIMER_RESEND;
+    }
+    else if (num_acked_ == num_fragments_ && num_fragments_ > 0)
+    {
+        action = TIMER_PROBE;
+    }
+
+    rto_backoff_ = std::min(2 * rto_backoff_, 64);
+    retransmit_time_ = now + rto_backoff_ * retransmit_timeout_;
+    return action;
+}
+
+goby::acomms::FileFragmentReceiver::FileFragmentReceiver()
+    : received_through_(0), highest_received_(-1), last_fragment_(-1), new_since_nack_(0),
+      last_rx_time_(0), last_nack_time_(0)
+{
+}
+
+bool goby::acomms::FileFragmentReceiver::add_fragment(const FileFragment& fragment,
+                                                      int nack_interval, double now)
+{
+    const int previous_highest = highest_received_;
+    const bool duplicate =
+        !fragments_.insert(std::make_pair(fragment.fragment(), fragment)).second;
+
+    last_rx_time_ = now;
+    if (fragment.is_last_fragment())
+        last_fragment_ = fragment.fragment();
+    highest_received_ = std::max(highest_received_, fragment.fragment());
+    while (fragments_.count(received_through_)) ++received_through_;
+
+    // a duplicate means the sender has not heard from us; a gap means a loss
+    return duplicate || fragment.fragment() > previous_highest + 1 ||
+           ++new_since_nack_ >= nack_interval;
+}
+
+bool goby::acomms::FileFragmentReceiver::nack_due(double now, double nack_timeout,
+                                                  double request_timeout) const
+{
+    return !fragments_.empty() && !all_received() &&
+           now > std::max(last_rx_time_, last_nack_time_) + nack_timeout &&
+           now < last_rx_time_ + request_timeout;
+}
+
+void goby::acomms::FileFragmentReceiver::make_nack(FileFragmentNack* nack, double now, bool idle)
+{
+    nack->set_received_through(received_through_);
+    nack->set_highest_received(std::max(highest_received_, 0));
+    nack->clear_missing();
+
+    // start with every fragment in range marked missing and clear the ones we hold
+    const int span = std::min(highest_received_ - received_through_ + 1, nack_bits());
+    if (span > 0)
+    {
+        std::string missing((span + 7) / 8, 0);
+        for (int i = 0; i < span; ++i) missing[i / 8] |= (1 << (i % 8));
+
+        for (std::map<int, FileFragment>::const_iterator
+                 it = fragments_.lower_bound(received_through_),
+                 end = fragments_.lower_bound(received_through_ + span);
+             it != end; ++it)
+        {
+            const int i = it->first - received_through_;
+            missing[i / 8] &= ~(1 << (i % 8));
+        }
+
+        std::string::size_type used = missing.find_last_not_of('\0');
+        if (used != std::string::npos)
+            nack->set_missing(missing.substr(0, used + 1));
+    }
+
+    if (idle)
+        nack->set_idle(true);
+    else
+        nack->clear_idle();
+
+    new_since_nack_ = 0;
+    last_nack_time_ = now;
+}
+
+TransferRequest::Compression
+goby::acomms::FileFragmentReceiver::assemble(std::string* data) const
+{
+    data->clear();
+    for (std::map<int, FileFragment>::const_iterator it = fragments_.begin(),
+                                                     end = fragments_.end();
+         it != end; ++it)
+        data->append(it->second.data(), 0, it->second.num_bytes());
+
+    return fragments_.empty() ? TransferRequest::UNCOMPRESSED
+                              : fragments_.rbegin()->second.compression();
+}
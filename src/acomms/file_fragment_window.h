@@ -0,0 +1,166 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FileFragmentWindow20181126H
+#define FileFragmentWindow20181126H
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "goby/acomms/protobuf/file_transfer.pb.h"
+
+namespace goby
+{
+namespace acomms
+{
+/// \brief Sender side of goby_file_transfer's selective-repeat protocol.
+///
+/// Fragments are cut on demand from the (possibly compressed) file contents and at most
+/// window_size are outstanding at once. Feedback comes from the receiver's FileFragmentNack
+/// messages and, if the link provides them, acknowledgments of individual fragments.
+class FileFragmentSender
+{
+  public:
+    enum TimerAction
+    {
+        TIMER_NONE,
+        // nothing was heard for a retransmission timeout: all fragments in flight are lost
+        TIMER_RESEND,
+        // everything is acknowledged but no TransferResponse arrived: repeat the last fragment
+        TIMER_PROBE
+    };
+
+    FileFragmentSender();
+    FileFragmentSender(const std::string& data, protobuf::TransferRequest::Compression compression,
+                       int window_size, double retransmit_timeout, double now);
+
+    /// \brief Bytes of data carried by a single FileFragment
+    static int fragment_size();
+
+    int num_fragments() const { return num_fragments_; }
+    int num_acked() const { return num_acked_; }
+    int num_lost() const { return lost_.size(); }
+    int in_flight() const { return in_flight_; }
+    protobuf::TransferRequest::Compression compression() const { return compression_; }
+    double last_feedback_time() const { return last_feedback_time_; }
+
+    /// \brief Restart the feedback and retransmission timers (e.g. once the receiver accepts)
+    void reset_timer(double now);
+
+    /// \brief Choose the next fragment to publish, retransmissions first
+    /// \return false if the window is full or every fragment has been sent
+    bool next_fragment(int* index);
+
+    /// \brief Fill in everything but the source and destination of fragment `index`
+    void get_fragment(int index, protobuf::FileFragment* fragment) const;
+
+    /// \return false if the NACK does not match this file
+    bool handle_nack(const protobuf::FileFragmentNack& nack, double now);
+    void handle_fragment_ack(int index, double now);
+
+    /// \brief Check the retransmission timer, backing it off when it expires
+    TimerAction check_timer(double now);
+
+  private:
+    enum FragmentState
+    {
+        UNSENT = 0,
+        IN_FLIGHT,
+        LOST,
+        ACKED
+    };
+
+    void ack(int index);
+    void lose(int index);
+    void restart_timer(double now);
+
+  private:
+    std::string data_;
+    protobuf::TransferRequest::Compression compression_;
+    int window_size_;
+    double retransmit_timeout_;
+    int num_fragments_;
+    std::vector<char> state_;
+    // order in which each fragment was last published, for deciding which gaps are real
+    std::vector<unsigned> send_seq_;
+    std::deque<int> lost_;
+    int next_new_;
+    int acked_through_;
+    int in_flight_;
+    int num_acked_;
+    unsigned seq_;
+    int rto_backoff_;
+    double last_feedback_time_;
+    double retransmit_time_;
+
+    // progress reported by the NACKs so far, and seq_ when the last one arrived
+    int nack_received_through_;
+    int nack_highest_received_;
+    unsigned nack_seq_;
+};
+
+/// \brief Receiver side of goby_file_transfer's selective-repeat protocol.
+class FileFragmentReceiver
+{
+  public:
+    FileFragmentReceiver();
+
+    /// \brief Store a fragment
+    /// \return true if a NACK should be sent now (unless all_received())
+    bool add_fragment(const protobuf::FileFragment& fragment, int nack_interval, double now);
+
+    bool empty() const { return fragments_.empty(); }
+    int size() const { return fragments_.size(); }
+    bool all_received() const
+    {
+        return last_fragment_ >= 0 && received_through_ == last_fragment_ + 1;
+    }
+
+    /// \brief Whether a NACK is due because nothing has arrived for nack_timeout seconds (and the
+    /// sender has not yet given up after request_timeout seconds)
+    bool nack_due(double now, double nack_timeout, double request_timeout) const;
+
+    /// \brief Fill in everything but the source and destination of a NACK for the fragments held
+    /// \param idle Whether the NACK is sent because nack_due()
+    void make_nack(protobuf::FileFragmentNack* nack, double now, bool idle = false);
+
+    /// \brief Concatenate the data of all fragments
+    /// \return Compression the data were sent with
+    protobuf::TransferRequest::Compression assemble(std::string* data) const;
+
+    void clear() { *this = FileFragmentReceiver(); }
+
+  private:
+    std::map<int, protobuf::FileFragment> fragments_;
+    int received_through_;
+    int highest_received_;
+    int last_fragment_;
+    int new_since_nack_;
+    double last_rx_time_;
+    double last_nack_time_;
+};
+} // namespace acomms
+} // namespace goby
+
+#endif
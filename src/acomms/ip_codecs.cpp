@@ -39,10 +39,15 @@ std::string goby::acomms::IPv4AddressCodec::post_decode(const dccl::uint32& wire
 }
 
 uint16_t goby::acomms::net_checksum(const std::string& data)
+{
+    return net_checksum(data.data(), data.size());
+}
+
+uint16_t goby::acomms::net_checksum(const char* data, std::size_t size)
 {
     uint32_t sum = 0;
-    int len = data.size();
-    uint16_t* p = (uint16_t*)&data[0];
+    int len = size;
+    const uint16_t* p = (const uint16_t*)data;
 
     while (len > 1)
     {
@@ -52,7 +57,7 @@ uint16_t goby::acomms::net_checksum(const std::string& data)
 
     // last byte is large byte (LSB is padded with zeros)
     if (len)
-        sum += (*(uint8_t*)p << 8) & 0xFF00;
+        sum += (*(const uint8_t*)p << 8) & 0xFF00;
 
     while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
 
@@ -107,6 +107,7 @@ class IPGatewayEmptyIdentifierCodec : public dccl::TypedFixedFieldCodec<dccl::ui
 };
 
 uint16_t net_checksum(const std::string& data);
+uint16_t net_checksum(const char* data, std::size_t size);
 
 } // namespace acomms
 } // namespace goby
@@ -149,6 +149,9 @@ void goby::acomms::ModemDriverBase::modem_start(const protobuf::DriverConfig& cf
         }
     }
 
+    if (data_ready_callback_)
+        modem_->set_read_callback(data_ready_callback_);
+
     modem_->start();
 
     // give it this much startup time
@@ -23,6 +23,7 @@
 #ifndef DriverBase20091214H
 #define DriverBase20091214H
 
+#include <boost/function.hpp>
 #include <boost/signals2.hpp>
 #include <boost/thread.hpp>
 
@@ -66,6 +67,14 @@ class ModemDriverBase
     /// Should be called regularly to perform the work of the driver as the driver *does not* run in its own thread. This allows us to guarantee that no signals are called except inside this method. Does not block.
     virtual void do_work() = 0;
 
+    /// \brief Registers a function to be called when new data from the modem is waiting for do_work(). Must be called before startup().
+    ///
+    /// This lets the owner of the driver call do_work() as soon as data arrives rather than waiting for its next poll. The callback is called from the thread that reads the physical connection, so it must be thread-safe and should only wake up the thread that calls do_work(). Drivers that do not support this never call it and must still be polled.
+    void set_data_ready_callback(const boost::function<void()>& callback)
+    {
+        data_ready_callback_ = callback;
+    }
+
     //@}
 
     /// \name MAC Slots
@@ -157,6 +166,10 @@ class ModemDriverBase
     util::LineBasedInterface& modem() { return *modem_; }
 
     //@}
+
+    /// \brief function set by set_data_ready_callback() (empty if none)
+    const boost::function<void()>& data_ready_callback() const { return data_ready_callback_; }
+
   protected:
     static int count_;
 
@@ -167,6 +180,8 @@ class ModemDriverBase
     // represents the line based communications interface to the modem
     boost::shared_ptr<util::LineBasedInterface> modem_;
 
+    boost::function<void()> data_ready_callback_;
+
     std::string glog_out_group_;
     std::string glog_in_group_;
 
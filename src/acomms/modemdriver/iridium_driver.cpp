@@ -338,7 +338,9 @@ void goby::acomms::IridiumDriver::send(const protobuf::ModemTransmission& msg)
             serialize_iridium_modem_message(&iridium_packet, msg);
 
             std::string rudics_packet;
-            serialize_rudics_packet(iridium_packet, &rudics_packet);
+            serialize_rudics_packet(
+                iridium_packet, &rudics_packet,
+                driver_cfg_.GetExtension(IridiumDriverConfig::rudics_encoding));
             fsm_.process_event(fsm::EvSBDBeginData(rudics_packet));
         }
     }
@@ -151,7 +151,9 @@ void goby::acomms::fsm::Command::handle_sbd_rx(const std::string& in)
         {
             std::string sbd_rx_data = sbd_rx_buffer_.substr(SBD_FIELD_SIZE_BYTES, sbd_rx_size);
             std::string bytes;
-            parse_rudics_packet(&bytes, sbd_rx_data);
+            parse_rudics_packet(&bytes, sbd_rx_data,
+                                context<IridiumDriverFSM>().driver_cfg().GetExtension(
+                                    IridiumDriverConfig::rudics_encoding));
             protobuf::ModemTransmission msg;
             parse_iridium_modem_message(bytes, &msg);
             context<IridiumDriverFSM>().received().push_back(msg);
@@ -344,7 +346,9 @@ void goby::acomms::fsm::OnCall::in_state_react(const EvRxOnCallSerial& e)
         std::string bytes;
         try
         {
-            parse_rudics_packet(&bytes, in);
+            parse_rudics_packet(&bytes, in,
+                                context<IridiumDriverFSM>().driver_cfg().GetExtension(
+                                    IridiumDriverConfig::rudics_encoding));
 
             protobuf::ModemTransmission msg;
             parse_iridium_modem_message(bytes, &msg);
@@ -378,7 +382,9 @@ void goby::acomms::fsm::OnCall::in_state_react(const EvTxOnCallSerial&)
 
         // frame message
         std::string rudics_packet;
-        serialize_rudics_packet(bytes, &rudics_packet);
+        serialize_rudics_packet(bytes, &rudics_packet,
+                                context<IridiumDriverFSM>().driver_cfg().GetExtension(
+                                    IridiumDriverConfig::rudics_encoding));
 
         context<IridiumDriverFSM>().serial_tx_buffer().push_back(rudics_packet);
         data_out.pop_front();
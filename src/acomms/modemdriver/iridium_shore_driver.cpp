@@ -197,7 +197,8 @@ void goby::acomms::IridiumShoreDriver::send(const protobuf::ModemTransmission& m
 
         // frame message
         std::string rudics_packet;
-        serialize_rudics_packet(bytes, &rudics_packet);
+        serialize_rudics_packet(bytes, &rudics_packet,
+                                driver_cfg_.GetExtension(IridiumDriverConfig::rudics_encoding));
         rudics_send(rudics_packet, msg.dest());
         boost::shared_ptr<OnCallBase> on_call_base = remote.on_call;
         on_call_base->set_last_tx_time(goby_time<double>());
@@ -209,7 +210,8 @@ void goby::acomms::IridiumShoreDriver::send(const protobuf::ModemTransmission& m
         serialize_iridium_modem_message(&bytes, msg);
 
         std::string sbd_packet;
-        serialize_rudics_packet(bytes, &sbd_packet);
+        serialize_rudics_packet(bytes, &sbd_packet,
+                                driver_cfg_.GetExtension(IridiumDriverConfig::rudics_encoding));
 
         if (modem_id_to_imei_.count(msg.dest()))
             send_sbd_mt(sbd_packet, modem_id_to_imei_[msg.dest()]);
@@ -305,7 +307,8 @@ void goby::acomms::IridiumShoreDriver::rudics_line(const std::string& data,
         }
         else
         {
-            parse_rudics_packet(&decoded_line, data);
+            parse_rudics_packet(&decoded_line, data,
+                                driver_cfg_.GetExtension(IridiumDriverConfig::rudics_encoding));
 
             protobuf::ModemTransmission modem_msg;
             parse_iridium_modem_message(decoded_line, &modem_msg);
@@ -364,7 +367,9 @@ void goby::acomms::IridiumShoreDriver::receive_sbd_mo()
             std::string bytes;
             try
             {
-                parse_rudics_packet(&bytes, (*it)->message().body().payload());
+                parse_rudics_packet(
+                    &bytes, (*it)->message().body().payload(),
+                    driver_cfg_.GetExtension(IridiumDriverConfig::rudics_encoding));
                 parse_iridium_modem_message(bytes, &modem_msg);
 
                 glog.is(DEBUG1) && glog << "Rx SBD ModemTransmission: "
@@ -495,8 +495,8 @@ void goby::acomms::MMDriver::do_work()
         // try to handle the received message, posting appropriate signals
         try
         {
-            NMEASentence nmea(in, NMEASentence::VALIDATE);
-            process_receive(nmea);
+            nmea_in_.parse(in, NMEASentence::VALIDATE);
+            process_receive(nmea_in_);
         }
         catch (std::exception& e)
         {
@@ -969,7 +969,8 @@ void goby::acomms::MMDriver::mm_write(const util::NMEASentence& nmea)
 {
     protobuf::ModemRaw raw_msg;
     raw_msg.set_raw(nmea.message());
-    raw_msg.set_description(description_map_[nmea.front()]);
+    const std::string* description = description_map_.find(nmea.front());
+    raw_msg.set_description(description ? *description : std::string());
 
     glog.is(DEBUG1) && glog << group(glog_out_group()) << hydroid_gateway_modem_prefix_
                             << raw_msg.raw() << "\n"
@@ -1019,15 +1020,22 @@ void goby::acomms::MMDriver::pop_out()
 // INCOMING NMEA
 //
 
-void goby::acomms::MMDriver::process_receive(const NMEASentence& nmea)
+void goby::acomms::MMDriver::process_receive(const util::NMEATokenizer& nmea)
 {
+    SentenceIDs sentence_id = sentence_id_map_.find_or(nmea.sentence_id(), SENTENCE_NOT_DEFINED);
+
     // need to print this first so raw log messages appear causal (as they are)
     protobuf::ModemRaw raw_msg;
-    raw_msg.set_raw(nmea.message());
-    raw_msg.set_description(description_map_[nmea.front()]);
+    nmea.message_cs(raw_msg.mutable_raw());
+
+    const std::string* description = description_map_.find(nmea.front());
+    raw_msg.set_description(description ? *description : std::string());
 
-    if (sentence_id_map_[nmea.sentence_id()] == CFG)
-        *raw_msg.mutable_description() += ":  " + cfg_map_[nmea.at(1)];
+    if (sentence_id == CFG)
+    {
+        std::map<std::string, std::string>::const_iterator it = cfg_map_.find(nmea.at(1).str());
+        *raw_msg.mutable_description() += ":  " + (it != cfg_map_.end() ? it->second : "");
+    }
 
     glog.is(DEBUG1) && glog << group(glog_in_group()) << hydroid_gateway_modem_prefix_
                             << raw_msg.raw() << "\n"
@@ -1037,47 +1045,52 @@ void goby::acomms::MMDriver::process_receive(const NMEASentence& nmea)
 
     global_fail_count_ = 0;
 
+    // $CADRQ is answered straight from the tokens, the other handlers take an NMEASentence
+    if (sentence_id != DRQ && sentence_id != SENTENCE_NOT_DEFINED)
+        nmea.to_sentence(&nmea_in_sentence_);
+    const NMEASentence& sentence = nmea_in_sentence_;
+
     // look at the sentence id (last three characters of the NMEA 0183 talker)
-    switch (sentence_id_map_[nmea.sentence_id()])
+    switch (sentence_id)
     {
         //
         // local modem
         //
-        case REV: carev(nmea); break;                // software revision
-        case ERR: caerr(nmea); break;                // error message
-        case DRQ: cadrq(nmea, transmit_msg_); break; // data request
-        case CFG: cacfg(nmea); break;                // configuration
-        case CLK: receive_time(nmea, CLK); break;    // clock
-        case TMS: receive_time(nmea, TMS); break;    // clock (MM2)
+        case REV: carev(sentence); break;             // software revision
+        case ERR: caerr(sentence); break;             // error message
+        case DRQ: cadrq(nmea, transmit_msg_); break;  // data request
+        case CFG: cacfg(sentence); break;             // configuration
+        case CLK: receive_time(sentence, CLK); break; // clock
+        case TMS: receive_time(sentence, TMS); break; // clock (MM2)
         case TMQ:
-            receive_time(nmea, TMQ);
+            receive_time(sentence, TMQ);
             break; // clock (MM2)
 
             //
             // data cycle
             //
-        case CYC: cacyc(nmea, &transmit_msg_); break; // cycle init
-        case XST: caxst(nmea, &transmit_msg_); break; // transmit stats for clock mode
-        case RXD: carxd(nmea, &receive_msg_); break;  // data receive
-        case MSG: camsg(nmea, &receive_msg_); break;  // for picking up BAD_CRC
-        case CST: cacst(nmea, &receive_msg_); break;  // transmit stats for clock mode
-        case MUA: camua(nmea, &receive_msg_); break;  // mini-packet receive
-        case RDP: cardp(nmea, &receive_msg_); break;  // FDP receive
+        case CYC: cacyc(sentence, &transmit_msg_); break; // cycle init
+        case XST: caxst(sentence, &transmit_msg_); break; // transmit stats for clock mode
+        case RXD: carxd(sentence, &receive_msg_); break;  // data receive
+        case MSG: camsg(sentence, &receive_msg_); break;  // for picking up BAD_CRC
+        case CST: cacst(sentence, &receive_msg_); break;  // transmit stats for clock mode
+        case MUA: camua(sentence, &receive_msg_); break;  // mini-packet receive
+        case RDP: cardp(sentence, &receive_msg_); break;  // FDP receive
         case ACK:
-            caack(nmea, &receive_msg_);
+            caack(sentence, &receive_msg_);
             break; // acknowledge
 
             //
             // ranging
             //
-        case MPR: campr(nmea, &receive_msg_); break; // two way ping
-        case MPA: campa(nmea, &receive_msg_); break; // hear request for two way ping
+        case MPR: campr(sentence, &receive_msg_); break; // two way ping
+        case MPA: campa(sentence, &receive_msg_); break; // hear request for two way ping
         case TTA:
-            sntta(nmea, &receive_msg_);
+            sntta(sentence, &receive_msg_);
             break; // remus / narrowband lbl times
 
             // hardware control
-        case MER: camer(nmea, &receive_msg_); break; // reply to hardware control
+        case MER: camer(sentence, &receive_msg_); break; // reply to hardware control
 
         default: break;
     }
@@ -1101,7 +1114,7 @@ void goby::acomms::MMDriver::process_receive(const NMEASentence& nmea)
         {
             pop_out();
         }
-        else if (out_.front().sentence_id() == nmea.sentence_id()) // general matching sentence id
+        else if (nmea.sentence_id() == out_.front().sentence_id()) // general matching sentence id
         {
             pop_out();
         }
@@ -1185,7 +1198,7 @@ void goby::acomms::MMDriver::camer(const NMEASentence& nmea, protobuf::ModemTran
         signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::cadrq(const NMEASentence& nmea_in,
+void goby::acomms::MMDriver::cadrq(const util::NMEATokenizer& nmea_in,
                                    const protobuf::ModemTransmission& m)
 {
     //$CADRQ,HHMMSS,SRC,DEST,ACK,N,F#*CS
@@ -1193,7 +1206,7 @@ void goby::acomms::MMDriver::cadrq(const NMEASentence& nmea_in,
     NMEASentence nmea_out("$CCTXD", NMEASentence::IGNORE);
 
     // WHOI counts frames from 1, we count from 0
-    int frame = as<int>(nmea_in[6]) - 1;
+    int frame = nmea_in.as<int>(6) - 1;
 
     if (frame < m.frame_size() && !m.frame(frame).empty())
     {
@@ -1216,9 +1229,9 @@ void goby::acomms::MMDriver::cadrq(const NMEASentence& nmea_in,
     else
     {
         // send a blank message to supress further DRQ
-        nmea_out.push_back(nmea_in[2]); // SRC
-        nmea_out.push_back(nmea_in[3]); // DEST
-        nmea_out.push_back(nmea_in[4]); // ACK
+        nmea_out.push_back(nmea_in.at(2).str()); // SRC
+        nmea_out.push_back(nmea_in.at(3).str()); // DEST
+        nmea_out.push_back(nmea_in.at(4).str()); // ACK
         nmea_out.push_back("");         // no data
     }
     append_to_write_queue(nmea_out);
@@ -30,6 +30,8 @@
 #include "driver_base.h"
 #include "goby/acomms/acomms_helpers.h"
 #include "goby/acomms/protobuf/mm_driver.pb.h"
+#include "goby/util/linebasedcomms/nmea_id_map.h"
+#include "goby/util/linebasedcomms/nmea_tokenizer.h"
 
 namespace goby
 {
@@ -164,7 +166,7 @@ class MMDriver : public ModemDriverBase
 
     // input
     void process_receive(
-        const util::NMEASentence& nmea); // parse a receive message and call proper method
+        const util::NMEATokenizer& nmea); // parse a receive message and call proper method
 
     // data cycle
     void cacyc(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CACYC
@@ -196,7 +198,7 @@ class MMDriver : public ModemDriverBase
     void cacfg(const util::NMEASentence& nmea);
     void receive_time(const util::NMEASentence& nmea, SentenceIDs sentence_id);       // $CACLK
     void catms(const util::NMEASentence& nmea);                                       // $CATMS
-    void cadrq(const util::NMEASentence& nmea, const protobuf::ModemTransmission& m); // $CADRQ
+    void cadrq(const util::NMEATokenizer& nmea, const protobuf::ModemTransmission& m); // $CADRQ
 
     void validate_transmission_start(const protobuf::ModemTransmission& message);
 
@@ -290,10 +292,15 @@ class MMDriver : public ModemDriverBase
     };
 
     std::map<std::string, TalkerIDs> talker_id_map_;
-    std::map<std::string, SentenceIDs> sentence_id_map_;
-    std::map<std::string, std::string> description_map_;
+    util::NMEAIDMap<SentenceIDs> sentence_id_map_;
+    util::NMEAIDMap<std::string> description_map_;
     std::map<std::string, std::string> cfg_map_;
 
+    // incoming sentence: split in place by nmea_in_, copied to nmea_in_sentence_ for the
+    // handlers that take an NMEASentence (all but $CADRQ)
+    util::NMEATokenizer nmea_in_;
+    util::NMEASentence nmea_in_sentence_;
+
     //
     // stuff to deal with the non-standard Hydroid gateway buoy
     //
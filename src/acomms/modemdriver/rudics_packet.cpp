@@ -23,12 +23,233 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/crc.hpp>
 #include <netinet/in.h>
+#include <algorithm>
+#include <vector>
 
 #include "goby/util/base_convert.h"
 #include "goby/util/binary.h"
+#include "goby/util/primitive_types.h"
 #include "rudics_packet.h"
 
+namespace
+{
+// fixed width unsigned integer of 32-bit limbs (least significant first) used to convert a
+// single block
+typedef std::vector<goby::uint32> Limbs;
+
+// base^DIGITS_PER_LIMB fits in a limb, so blocks are converted this many digits per pass
+const int DIGITS_PER_LIMB = 4;
+
+goby::uint64 power(int base, int exponent)
+{
+    goby::uint64 result = 1;
+    for (int i = 0; i < exponent; ++i) result *= base;
+    return result;
+}
+
+// number of base "base" digits needed to hold any "bytes" byte value, for bytes in
+// [0, RUDICS_BLOCK_BYTES]: the smallest n where base^n >= 256^bytes
+void block_digits(int base, std::vector<int>* digits)
+{
+    digits->assign(goby::acomms::RUDICS_BLOCK_BYTES + 1, 0);
+
+    // base^n, with room for a block and one extra digit
+    Limbs power(goby::acomms::RUDICS_BLOCK_BYTES / 4 + 2, 0);
+    power[0] = 1;
+    int top = 0;
+    int n = 0;
+    int power_bits = 1;
+    for (int bytes = 1; bytes <= goby::acomms::RUDICS_BLOCK_BYTES; ++bytes)
+    {
+        while (power_bits <= 8 * bytes)
+        {
+            goby::uint64 carry = 0;
+            for (int i = 0; i <= top; ++i)
+            {
+                carry += static_cast<goby::uint64>(power[i]) * base;
+                power[i] = carry & 0xFFFFFFFF;
+                carry >>= 32;
+            }
+            if (carry)
+                power[++top] = carry;
+            ++n;
+
+            power_bits = 32 * top;
+            for (goby::uint32 limb = power[top]; limb; limb >>= 1) ++power_bits;
+        }
+        (*digits)[bytes] = n;
+    }
+}
+
+// digit value -> character, avoiding reserved characters the same way as the BASE_CONVERT
+// framing
+void digit_table(int base, const std::string& reserved, char* table)
+{
+    for (int d = 0; d < base; ++d) table[d] = static_cast<char>(d);
+    for (int i = 0, n = reserved.size(); i < n; ++i)
+    {
+        int r = reserved[i] & 0xFF;
+        if (r < base)
+            table[r] = static_cast<char>(base + i);
+    }
+}
+
+void block_encode(const std::string& bytes, std::string* rudics_pkt, const std::string& reserved)
+{
+    const int base = 256 - reserved.size();
+    std::vector<int> digits;
+    block_digits(base, &digits);
+    char table[256];
+    digit_table(base, reserved, table);
+
+    const int size = bytes.size();
+    const int full_blocks = size / goby::acomms::RUDICS_BLOCK_BYTES;
+    const int last_block_bytes = size % goby::acomms::RUDICS_BLOCK_BYTES;
+    rudics_pkt->resize(full_blocks * digits[goby::acomms::RUDICS_BLOCK_BYTES] +
+                       digits[last_block_bytes]);
+
+    Limbs value;
+    std::string::iterator out = rudics_pkt->begin();
+    for (int begin = 0; begin < size; begin += goby::acomms::RUDICS_BLOCK_BYTES)
+    {
+        const int block_bytes = std::min<int>(goby::acomms::RUDICS_BLOCK_BYTES, size - begin);
+
+        // first byte is most significant
+        value.assign((block_bytes + 3) / 4, 0);
+        for (int i = 0; i < block_bytes; ++i)
+        {
+            int shift = block_bytes - 1 - i;
+            value[shift / 4] |= static_cast<goby::uint32>(bytes[begin + i] & 0xFF)
+                                << (8 * (shift % 4));
+        }
+
+        // least significant digits first, DIGITS_PER_LIMB at a time
+        const int block_digits = digits[block_bytes];
+        int top = value.size() - 1;
+        for (int j = block_digits; j > 0; j -= DIGITS_PER_LIMB)
+        {
+            const int group = std::min<int>(DIGITS_PER_LIMB, j);
+            const goby::uint64 divisor = power(base, group);
+            goby::uint64 remainder = 0;
+            for (int i = top; i >= 0; --i)
+            {
+                remainder = (remainder << 32) | value[i];
+                value[i] = remainder / divisor;
+                remainder %= divisor;
+            }
+            while (top > 0 && value[top] == 0) --top;
+
+            for (int g = 1; g <= group; ++g)
+            {
+                out[j - g] = table[remainder % base];
+                remainder /= base;
+            }
+        }
+        out += block_digits;
+    }
+}
+
+void block_decode(const std::string& rudics_pkt, std::string* bytes, const std::string& reserved)
+{
+    using goby::acomms::RudicsPacketException;
+
+    const int base = 256 - reserved.size();
+    std::vector<int> digits;
+    block_digits(base, &digits);
+    char table[256];
+    digit_table(base, reserved, table);
+
+    // character -> digit value, or -1 for reserved characters (junk), -2 for invalid
+    int values[256];
+    std::fill(values, values + 256, -2);
+    for (int d = 0; d < base; ++d) values[table[d] & 0xFF] = d;
+    for (int i = 0, n = reserved.size(); i < n; ++i) values[reserved[i] & 0xFF] = -1;
+
+    std::vector<int> in;
+    in.reserve(rudics_pkt.size());
+    for (std::string::const_iterator it = rudics_pkt.begin(), end = rudics_pkt.end(); it != end;
+         ++it)
+    {
+        int d = values[*it & 0xFF];
+        if (d == -2)
+            throw(RudicsPacketException("Invalid character in block"));
+        else if (d >= 0)
+            in.push_back(d);
+    }
+
+    const int full_block_digits = digits[goby::acomms::RUDICS_BLOCK_BYTES];
+    const int full_blocks = in.size() / full_block_digits;
+    const int last_block_digits = in.size() % full_block_digits;
+    int last_block_bytes = 0;
+    while (digits[last_block_bytes] < last_block_digits) ++last_block_bytes;
+    if (digits[last_block_bytes] != last_block_digits)
+        throw(RudicsPacketException("Invalid number of digits for final block"));
+
+    bytes->resize(full_blocks * goby::acomms::RUDICS_BLOCK_BYTES + last_block_bytes);
+
+    Limbs value;
+    std::string::iterator out = bytes->begin();
+    for (int begin = 0, n = in.size(); begin < n;)
+    {
+        const int block_bytes = (begin + full_block_digits <= n)
+                                    ? static_cast<int>(goby::acomms::RUDICS_BLOCK_BYTES)
+                                    : last_block_bytes;
+        const int block_digits = digits[block_bytes];
+
+        // most significant digits first, DIGITS_PER_LIMB at a time
+        value.assign((block_bytes + 3) / 4, 0);
+        int top = 0;
+        for (int j = 0; j < block_digits;)
+        {
+            const int group = std::min<int>(DIGITS_PER_LIMB, block_digits - j);
+            const goby::uint64 multiplier = power(base, group);
+            goby::uint64 carry = 0;
+            for (int g = 0; g < group; ++g, ++j) carry = carry * base + in[begin + j];
+
+            for (int i = 0; i <= top; ++i)
+            {
+                carry += static_cast<goby::uint64>(value[i]) * multiplier;
+                value[i] = carry & 0xFFFFFFFF;
+                carry >>= 32;
+            }
+            if (carry)
+            {
+                if (++top == static_cast<int>(value.size()))
+                    throw(RudicsPacketException("Block value too large"));
+                value[top] = carry;
+            }
+        }
+        if (block_bytes % 4 && (value.back() >> (8 * (block_bytes % 4))))
+            throw(RudicsPacketException("Block value too large"));
+
+        for (int i = 0; i < block_bytes; ++i)
+        {
+            int shift = block_bytes - 1 - i;
+            out[i] = static_cast<char>((value[shift / 4] >> (8 * (shift % 4))) & 0xFF);
+        }
+
+        out += block_bytes;
+        begin += block_digits;
+    }
+}
+} // namespace
+
+void goby::acomms::serialize_rudics_packet(std::string bytes, std::string* rudics_pkt,
+                                           const std::string& reserved, bool include_crc)
+{
+    serialize_rudics_packet(bytes, rudics_pkt, IridiumDriverConfig::BASE_CONVERT, reserved,
+                            include_crc);
+}
+
+void goby::acomms::parse_rudics_packet(std::string* bytes, std::string rudics_pkt,
+                                       const std::string& reserved, bool include_crc)
+{
+    parse_rudics_packet(bytes, rudics_pkt, IridiumDriverConfig::BASE_CONVERT, reserved,
+                        include_crc);
+}
+
 void goby::acomms::serialize_rudics_packet(std::string bytes, std::string* rudics_pkt,
+                                           IridiumDriverConfig::RudicsEncoding encoding,
                                            const std::string& reserved, bool include_crc)
 {
     if (include_crc)
@@ -39,16 +260,24 @@ void goby::acomms::serialize_rudics_packet(std::string bytes, std::string* rudic
         bytes += uint32_to_byte_string(crc.checksum());
     }
 
-    // 2. convert to base (256 minus reserved)
-    const int reduced_base = 256 - reserved.size();
+    if (encoding == IridiumDriverConfig::BLOCK_BASE_CONVERT)
+    {
+        // 2. & 3. convert each block to base (256 minus reserved), avoiding reserved characters
+        block_encode(bytes, rudics_pkt, reserved);
+    }
+    else
+    {
+        // 2. convert to base (256 minus reserved)
+        const int reduced_base = 256 - reserved.size();
 
-    goby::util::base_convert(bytes, rudics_pkt, 256, reduced_base);
+        goby::util::base_convert(bytes, rudics_pkt, 256, reduced_base);
 
-    // 3. replace reserved characters
-    for (int i = 0, n = reserved.size(); i < n; ++i)
-    {
-        std::replace(rudics_pkt->begin(), rudics_pkt->end(), reserved[i],
-                     static_cast<char>(reduced_base + i));
+        // 3. replace reserved characters
+        for (int i = 0, n = reserved.size(); i < n; ++i)
+        {
+            std::replace(rudics_pkt->begin(), rudics_pkt->end(), reserved[i],
+                         static_cast<char>(reduced_base + i));
+        }
     }
 
     // 4. append CR
@@ -56,6 +285,7 @@ void goby::acomms::serialize_rudics_packet(std::string bytes, std::string* rudic
 }
 
 void goby::acomms::parse_rudics_packet(std::string* bytes, std::string rudics_pkt,
+                                       IridiumDriverConfig::RudicsEncoding encoding,
                                        const std::string& reserved, bool include_crc)
 {
     const unsigned CR_SIZE = 1;
@@ -65,22 +295,30 @@ void goby::acomms::parse_rudics_packet(std::string* bytes, std::string rudics_pk
     // 4. remove CR
     rudics_pkt = rudics_pkt.substr(0, rudics_pkt.size() - 1);
 
-    const int reduced_base = 256 - reserved.size();
-
-    // get rid of extra junk
-    rudics_pkt.erase(
-        std::remove_if(rudics_pkt.begin(), rudics_pkt.end(), boost::is_any_of(reserved)),
-        rudics_pkt.end());
-
-    // 3. replace reserved characters
-    for (int i = 0, n = reserved.size(); i < n; ++i)
+    if (encoding == IridiumDriverConfig::BLOCK_BASE_CONVERT)
     {
-        std::replace(rudics_pkt.begin(), rudics_pkt.end(), static_cast<char>(reduced_base + i),
-                     reserved[i]);
+        // 3. & 2. (ignoring extra junk) convert each block back to base 256
+        block_decode(rudics_pkt, bytes, reserved);
     }
+    else
+    {
+        const int reduced_base = 256 - reserved.size();
+
+        // get rid of extra junk
+        rudics_pkt.erase(
+            std::remove_if(rudics_pkt.begin(), rudics_pkt.end(), boost::is_any_of(reserved)),
+            rudics_pkt.end());
 
-    // 2. convert to base
-    goby::util::base_convert(rudics_pkt, bytes, reduced_base, 256);
+        // 3. replace reserved characters
+        for (int i = 0, n = reserved.size(); i < n; ++i)
+        {
+            std::replace(rudics_pkt.begin(), rudics_pkt.end(),
+                         static_cast<char>(reduced_base + i), reserved[i]);
+        }
+
+        // 2. convert to base
+        goby::util::base_convert(rudics_pkt, bytes, reduced_base, 256);
+    }
 
     if (include_crc)
     {
@@ -27,6 +27,8 @@
 #include <stdint.h>
 #include <string>
 
+#include "goby/acomms/protobuf/iridium_driver.pb.h"
+
 namespace goby
 {
 namespace acomms
@@ -45,6 +47,24 @@ void parse_rudics_packet(std::string* bytes, std::string rudics_pkt,
                          const std::string& reserved = std::string("\0\r\n", 3) +
                                                        std::string(1, 0xff),
                          bool include_crc = true);
+
+/// \brief As above, but with the given framing. BLOCK_BASE_CONVERT converts each RUDICS_BLOCK_BYTES of input separately (into one more digit, for up to ten reserved characters), so its cost is linear in the packet size rather than quadratic.
+void serialize_rudics_packet(std::string bytes, std::string* rudics_pkt,
+                             IridiumDriverConfig::RudicsEncoding encoding,
+                             const std::string& reserved = std::string("\0\r\n", 3) +
+                                                           std::string(1, 0xff),
+                             bool include_crc = true);
+void parse_rudics_packet(std::string* bytes, std::string rudics_pkt,
+                         IridiumDriverConfig::RudicsEncoding encoding,
+                         const std::string& reserved = std::string("\0\r\n", 3) +
+                                                       std::string(1, 0xff),
+                         bool include_crc = true);
+
+enum
+{
+    RUDICS_BLOCK_BYTES = 128
+};
+
 std::string uint32_to_byte_string(uint32_t i);
 uint32_t byte_string_to_uint32(std::string s);
 } // namespace acomms
@@ -41,7 +41,15 @@ goby::acomms::UDPDriver::UDPDriver(boost::asio::io_service* io_service)
 {
 }
 
-goby::acomms::UDPDriver::~UDPDriver() {}
+goby::acomms::UDPDriver::~UDPDriver()
+{
+    if (io_thread_)
+    {
+        io_service_->stop();
+        io_thread_->join();
+    }
+    driver_work_.reset();
+}
 
 void goby::acomms::UDPDriver::startup(const protobuf::DriverConfig& cfg)
 {
@@ -64,11 +72,25 @@ void goby::acomms::UDPDriver::startup(const protobuf::DriverConfig& cfg)
 
     start_receive();
     io_service_->reset();
+
+    if (data_ready_callback())
+    {
+        driver_io_service_.reset();
+        driver_work_.reset(new boost::asio::io_service::work(driver_io_service_));
+        io_thread_.reset(new boost::thread(
+            boost::bind(&boost::asio::io_service::run, io_service_)));
+    }
 }
 
 void goby::acomms::UDPDriver::shutdown()
 {
     io_service_->stop();
+    if (io_thread_)
+    {
+        io_thread_->join();
+        io_thread_.reset();
+    }
+    driver_work_.reset();
     socket_.close();
 }
 
@@ -95,7 +117,13 @@ void goby::acomms::UDPDriver::handle_initiate_transmission(
         start_send(msg);
 }
 
-void goby::acomms::UDPDriver::do_work() { io_service_->poll(); }
+void goby::acomms::UDPDriver::do_work()
+{
+    if (io_thread_)
+        driver_io_service_.poll();
+    else
+        io_service_->poll();
+}
 
 void goby::acomms::UDPDriver::receive_message(const protobuf::ModemTransmission& msg)
 {
@@ -118,22 +146,38 @@ void goby::acomms::UDPDriver::receive_message(const protobuf::ModemTransmission&
 void goby::acomms::UDPDriver::start_send(const google::protobuf::Message& msg)
 {
     // send the message
-    std::string bytes;
-    msg.SerializeToString(&bytes);
+    boost::shared_ptr<std::string> bytes(new std::string);
+    msg.SerializeToString(bytes.get());
 
     glog.is(DEBUG1) && glog << group(glog_out_group())
-                            << "Sending hex: " << goby::util::hex_encode(bytes) << std::endl;
+                            << "Sending hex: " << goby::util::hex_encode(*bytes) << std::endl;
 
     protobuf::ModemRaw raw_msg;
-    raw_msg.set_raw(bytes);
+    raw_msg.set_raw(*bytes);
     signal_raw_outgoing(raw_msg);
 
-    socket_.async_send_to(boost::asio::buffer(bytes), receiver_,
-                          boost::bind(&UDPDriver::send_complete, this, _1, _2));
+    // the socket belongs to the thread running io_service_
+    if (io_thread_)
+        io_service_->post(boost::bind(&UDPDriver::async_send, this, bytes));
+    else
+        async_send(bytes);
+}
+
+void goby::acomms::UDPDriver::async_send(boost::shared_ptr<std::string> bytes)
+{
+    // bytes is kept alive by the handler until the send completes
+    if (io_thread_)
+        socket_.async_send_to(
+            boost::asio::buffer(*bytes), receiver_,
+            driver_io_service_.wrap(boost::bind(&UDPDriver::send_complete, this, _1, _2, bytes)));
+    else
+        socket_.async_send_to(boost::asio::buffer(*bytes), receiver_,
+                              boost::bind(&UDPDriver::send_complete, this, _1, _2, bytes));
 }
 
 void goby::acomms::UDPDriver::send_complete(const boost::system::error_code& error,
-                                            std::size_t bytes_transferred)
+                                            std::size_t bytes_transferred,
+                                            boost::shared_ptr<std::string> /*bytes*/)
 {
     if (error)
     {
@@ -155,25 +199,50 @@ void goby::acomms::UDPDriver::start_receive()
 void goby::acomms::UDPDriver::receive_complete(const boost::system::error_code& error,
                                                std::size_t bytes_transferred)
 {
+    if (io_thread_)
+    {
+        // no logging or signals from the I/O thread: hand off to do_work()
+        if (error)
+            driver_io_service_.post(boost::bind(&UDPDriver::receive_error, this, error));
+        else
+            driver_io_service_.post(
+                boost::bind(&UDPDriver::handle_receive, this,
+                            std::string(&receive_buffer_[0], bytes_transferred), sender_));
+        data_ready_callback()();
+        start_receive();
+        return;
+    }
+
     if (error)
     {
-        glog.is(DEBUG1) && glog << group(glog_in_group()) << warn
-                                << "Receive error: " << error.message() << std::endl;
+        receive_error(error);
         start_receive();
         return;
     }
 
+    handle_receive(std::string(&receive_buffer_[0], bytes_transferred), sender_);
+
+    start_receive();
+}
+
+void goby::acomms::UDPDriver::receive_error(const boost::system::error_code& error)
+{
+    glog.is(DEBUG1) && glog << group(glog_in_group()) << warn
+                            << "Receive error: " << error.message() << std::endl;
+}
+
+void goby::acomms::UDPDriver::handle_receive(const std::string& bytes,
+                                             const boost::asio::ip::udp::endpoint& sender)
+{
     protobuf::ModemRaw raw_msg;
-    raw_msg.set_raw(std::string(&receive_buffer_[0], bytes_transferred));
+    raw_msg.set_raw(bytes);
     signal_raw_incoming(raw_msg);
 
-    glog.is(DEBUG1) && glog << group(glog_in_group()) << "Received " << bytes_transferred
-                            << " bytes from " << sender_.address().to_string() << ":"
-                            << sender_.port() << std::endl;
+    glog.is(DEBUG1) && glog << group(glog_in_group()) << "Received " << bytes.size()
+                            << " bytes from " << sender.address().to_string() << ":"
+                            << sender.port() << std::endl;
 
     protobuf::ModemTransmission msg;
-    msg.ParseFromArray(&receive_buffer_[0], bytes_transferred);
+    msg.ParseFromString(bytes);
     receive_message(msg);
-
-    start_receive();
 }
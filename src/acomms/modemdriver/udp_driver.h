@@ -47,9 +47,13 @@ class UDPDriver : public ModemDriverBase
 
   private:
     void start_send(const google::protobuf::Message& msg);
-    void send_complete(const boost::system::error_code& error, std::size_t bytes_transferred);
+    void async_send(boost::shared_ptr<std::string> bytes);
+    void send_complete(const boost::system::error_code& error, std::size_t bytes_transferred,
+                       boost::shared_ptr<std::string> bytes);
     void start_receive();
     void receive_complete(const boost::system::error_code& error, std::size_t bytes_transferred);
+    void receive_error(const boost::system::error_code& error);
+    void handle_receive(const std::string& bytes, const boost::asio::ip::udp::endpoint& sender);
     void receive_message(const protobuf::ModemTransmission& m);
 
   private:
@@ -60,6 +64,13 @@ class UDPDriver : public ModemDriverBase
     boost::asio::ip::udp::endpoint sender_;
     std::vector<char> receive_buffer_;
     goby::uint32 next_frame_;
+
+    // if data_ready_callback() is set, io_service_ is run by io_thread_ and completed
+    // sends and receives are posted to driver_io_service_ to be handled in do_work()
+    boost::shared_ptr<boost::thread> io_thread_;
+    boost::asio::io_service driver_io_service_;
+    // keeps driver_io_service_ from stopping when do_work() finds it empty
+    boost::shared_ptr<boost::asio::io_service::work> driver_work_;
 };
 } // namespace acomms
 } // namespace goby
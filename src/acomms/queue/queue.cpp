@@ -144,6 +144,7 @@ bool goby::acomms::Queue::push_message(boost::shared_ptr<google::protobuf::Messa
         messages_.erase(it_to_erase);
     }
 
+    update_sendable();
     return true;
 }
 
@@ -315,6 +316,12 @@ goby::acomms::QueuedMessage goby::acomms::Queue::give_data(unsigned frame)
     last_send_time_ = goby_time();
     it_to_give->meta.set_last_sent_time(util::as<goby::uint64>(last_send_time_));
 
+    // encode on first send only, keeping the bytes for retransmissions (encrypted bodies are
+    // passed through as is)
+    if (it_to_give->encoded.empty() && !it_to_give->meta.has_encoded_message())
+        parent_->cache_encoded(&*it_to_give);
+
+    update_sendable();
     return *it_to_give;
 }
 
@@ -324,13 +331,18 @@ bool goby::acomms::Queue::get_priority_values(double* priority,
                                               const protobuf::ModemTransmission& request_msg,
                                               const std::string& data)
 {
-    *priority = common::time_duration2double((goby_time() - last_send_time_)) /
-                queue_message_options().ttl() * queue_message_options().value_base();
-
+    boost::posix_time::ptime now = goby_time();
+    *priority = this->priority(now);
     *last_send_time = last_send_time_;
 
+    return can_send(request_msg, data, now);
+}
+
+bool goby::acomms::Queue::can_send(const protobuf::ModemTransmission& request_msg,
+                                   const std::string& data, boost::posix_time::ptime now)
+{
     // no messages left to send
-    if (messages_.size() <= waiting_for_ack_.size())
+    if (!sendable())
         return false;
 
     protobuf::QueuedMessageMeta& next_msg = next_message_it()->meta;
@@ -339,7 +351,7 @@ bool goby::acomms::Queue::get_priority_values(double* priority,
     // or the same as the first user-frame
 
     if (last_send_time_ + boost::posix_time::seconds(queue_message_options().blackout_time()) >
-        goby_time())
+        now)
     {
         glog.is(DEBUG1) && glog << group(parent_->glog_priority_group()) << "\t" << name()
                                 << " is in blackout" << std::endl;
@@ -379,7 +391,7 @@ bool goby::acomms::Queue::get_priority_values(double* priority,
     {
         glog.is(DEBUG1) && glog << group(parent_->glog_priority_group()) << "\t" << name() << " ("
                                 << next_msg.non_repeated_size() << "B) has priority value"
-                                << ": " << *priority << std::endl;
+                                << ": " << priority(now) << std::endl;
         return true;
     }
 }
@@ -400,6 +412,7 @@ bool goby::acomms::Queue::pop_message(unsigned frame)
         {
             stream_for_pop(*it);
             messages_.erase(it);
+            update_sendable();
             return true;
         }
 
@@ -433,6 +446,7 @@ bool goby::acomms::Queue::pop_message_ack(unsigned frame,
         return false;
     }
 
+    update_sendable();
     return true;
 }
 
@@ -473,10 +487,11 @@ std::vector<boost::shared_ptr<google::protobuf::Message> > goby::acomms::Queue::
         }
         else
         {
-            return expired_msgs;
+            break;
         }
     }
 
+    update_sendable();
     return expired_msgs;
 }
 
@@ -507,6 +522,13 @@ void goby::acomms::Queue::flush()
                             << " (qsize 0)" << std::endl;
     messages_.clear();
     waiting_for_ack_.clear();
+    update_sendable();
+}
+
+void goby::acomms::Queue::clear_encoded()
+{
+    for (messages_it it = messages_.begin(), end = messages_.end(); it != end; ++it)
+        it->encoded.clear();
 }
 
 bool goby::acomms::Queue::clear_ack_queue(unsigned start_frame)
@@ -538,9 +560,12 @@ bool goby::acomms::Queue::clear_ack_queue(unsigned start_frame)
             ++it;
         }
     }
+    update_sendable();
     return waiting_for_ack_.empty();
 }
 
+void goby::acomms::Queue::update_sendable() { parent_->update_sendable(this); }
+
 std::ostream& goby::acomms::operator<<(std::ostream& os, const goby::acomms::Queue& oq)
 {
     oq.info(&os);
@@ -52,6 +52,8 @@ struct QueuedMessage
 {
     boost::shared_ptr<google::protobuf::Message> dccl_msg;
     protobuf::QueuedMessageMeta meta;
+    // DCCL encoded dccl_msg, cached when first given for a frame (empty if not yet encoded)
+    std::string encoded;
 };
 
 typedef std::list<QueuedMessage>::iterator messages_it;
@@ -83,11 +85,28 @@ class Queue
                              const protobuf::ModemTransmission& request_msg,
                              const std::string& data);
 
+    // time-decayed priority value at the given time
+    double priority(boost::posix_time::ptime now) const
+    {
+        return common::time_duration2double((now - last_send_time_)) /
+               cfg_.ttl() * cfg_.value_base();
+    }
+
+    // true if there are messages not already waiting for an ack
+    bool sendable() const { return messages_.size() > waiting_for_ack_.size(); }
+
+    // true if the next message can be sent in the frame requested
+    bool can_send(const protobuf::ModemTransmission& request_msg, const std::string& data,
+                  boost::posix_time::ptime now);
+
     // returns true if empty
     bool clear_ack_queue(unsigned start_frame);
 
     void flush();
 
+    // discards the cached encodings (e.g. when the crypto passphrases change)
+    void clear_encoded();
+
     size_t size() const { return messages_.size(); }
 
     boost::posix_time::ptime last_send_time() const { return last_send_time_; }
@@ -117,6 +136,8 @@ class Queue
 
   private:
     waiting_for_ack_it find_ack_value(messages_it it_to_find);
+    // keeps the QueueManager's index of sendable queues up to date
+    void update_sendable();
     messages_it next_message_it();
 
     void set_latest_metadata(const google::protobuf::FieldDescriptor* field,
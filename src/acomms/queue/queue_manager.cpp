@@ -20,6 +20,8 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+
 #include <boost/foreach.hpp>
 
 #include "goby/common/logger.h"
@@ -250,6 +252,8 @@ void goby::acomms::QueueManager::handle_modem_data_request(protobuf::ModemTransm
         else
         {
             std::list<QueuedMessage> dccl_msgs;
+            // running total of the encoded size of dccl_msgs
+            unsigned repeated_size_bytes = 0;
 
             // set true if we are passing on encrypted data untouched
             bool using_encrypted_body = false;
@@ -338,8 +342,9 @@ void goby::acomms::QueueManager::handle_modem_data_request(protobuf::ModemTransm
                 //                        static_cast<char>((next_user_frame.data().size()-DCCL_NUM_HEADER_BYTES)));
                 // new_data.insert(DCCL_NUM_HEADER_BYTES, frame_size);
 
-                // fix the destination
-                next_user_frame.meta = meta_from_msg(*next_user_frame.dccl_msg);
+                // fix the destination (only used to choose the passphrase if not yet encoded)
+                if (next_user_frame.encoded.empty())
+                    next_user_frame.meta = meta_from_msg(*next_user_frame.dccl_msg);
                 dccl_msgs.push_back(next_user_frame);
 
                 //
@@ -350,7 +355,9 @@ void goby::acomms::QueueManager::handle_modem_data_request(protobuf::ModemTransm
                 }
                 else
                 {
-                    unsigned repeated_size_bytes = size_repeated(dccl_msgs);
+                    // empty only if encoding failed, in which case encode_repeated() below
+                    // fails again and the frame is discarded
+                    repeated_size_bytes += next_user_frame.encoded.size();
 
                     glog.is(DEBUG2) && glog << group(glog_out_group_) << "Size repeated "
                                             << repeated_size_bytes << std::endl;
@@ -416,42 +423,74 @@ std::string goby::acomms::QueueManager::encode_repeated(const std::list<QueuedMe
     std::string out;
     BOOST_FOREACH (const QueuedMessage& msg, msgs)
     {
-        if (encrypt_rules_.size())
+        if (!msg.encoded.empty())
+        {
+            out += msg.encoded;
+        }
+        else
         {
-            protobuf::DCCLConfig cfg;
-            std::map<ModemId, std::string>::const_iterator it =
-                encrypt_rules_.find(msg.meta.dest());
+            std::string piece;
+            encode(*(msg.dccl_msg), msg.meta.dest(), &piece);
+            out += piece;
+        }
+    }
+    return out;
+}
 
-            if (it != encrypt_rules_.end())
-            {
-                cfg.set_crypto_passphrase(it->second);
-            }
+void goby::acomms::QueueManager::encode(const google::protobuf::Message& dccl_msg, int dest,
+                                        std::string* bytes)
+{
+    if (encrypt_rules_.size())
+    {
+        protobuf::DCCLConfig cfg;
+        std::map<ModemId, std::string>::const_iterator it = encrypt_rules_.find(dest);
 
-            codec_->merge_cfg(cfg);
+        if (it != encrypt_rules_.end())
+        {
+            cfg.set_crypto_passphrase(it->second);
         }
 
-        std::string piece;
-        codec_->encode(&piece, *(msg.dccl_msg));
-        out += piece;
+        codec_->merge_cfg(cfg);
+    }
+
+    codec_->encode(bytes, dccl_msg);
+}
+
+void goby::acomms::QueueManager::cache_encoded(QueuedMessage* msg)
+{
+    try
+    {
+        // the destination used by encode_repeated() is that of the message itself, which may
+        // differ from msg->meta if it was rerouted
+        int dest = encrypt_rules_.size() ? meta_from_msg(*msg->dccl_msg).dest() : 0;
+        encode(*msg->dccl_msg, dest, &msg->encoded);
+    }
+    catch (DCCLException& e)
+    {
+        // encode_repeated() tries again and reports the failure
+        msg->encoded.clear();
+        glog.is(DEBUG2) && glog << group(glog_out_group_)
+                                << "Could not encode message: " << e.what() << std::endl;
     }
-    return out;
 }
 
 std::list<goby::acomms::QueuedMessage>
-goby::acomms::QueueManager::decode_repeated(const std::string& orig_bytes)
+goby::acomms::QueueManager::decode_repeated(const std::string& bytes)
 {
-    std::string bytes = orig_bytes;
     std::list<QueuedMessage> out;
-    while (!bytes.empty())
+    std::string::const_iterator begin = bytes.begin(), end = bytes.end();
+    while (begin != end)
     {
         try
         {
             QueuedMessage msg;
+            unsigned last_size = 0;
 
             if (encrypt_rules_.size())
             {
                 boost::shared_ptr<google::protobuf::Message> header =
-                    codec_->decode<boost::shared_ptr<google::protobuf::Message> >(bytes, true);
+                    codec_->decode<boost::shared_ptr<google::protobuf::Message> >(
+                        begin, end, &last_size, true);
 
                 msg.meta = meta_from_msg(*header);
 
@@ -467,17 +506,20 @@ goby::acomms::QueueManager::decode_repeated(const std::string& orig_bytes)
                 codec_->merge_cfg(cfg);
             }
 
-            msg.dccl_msg = codec_->decode<boost::shared_ptr<google::protobuf::Message> >(bytes);
+            msg.dccl_msg =
+                codec_->decode<boost::shared_ptr<google::protobuf::Message> >(begin, end,
+                                                                               &last_size);
 
             if (!encrypt_rules_.size())
                 msg.meta = meta_from_msg(*(msg.dccl_msg));
 
             out.push_back(msg);
-            unsigned last_size = codec_->size(*(out.back().dccl_msg));
             glog.is(common::logger::DEBUG1) && glog << group(glog_in_group_)
                                                     << "last message size was: " << last_size
                                                     << std::endl;
-            bytes.erase(0, last_size);
+            if (last_size == 0)
+                throw(DCCLException("Decoded message consumed no bytes"));
+            begin += last_size;
         }
         catch (dccl::Exception& e)
         {
@@ -487,8 +529,8 @@ goby::acomms::QueueManager::decode_repeated(const std::string& orig_bytes)
             {
                 glog.is(common::logger::WARN) &&
                     glog << group(glog_in_group_) << "failed to decode "
-                         << goby::util::hex_encode(bytes) << " but returning parts already decoded"
-                         << std::endl;
+                         << goby::util::hex_encode(std::string(begin, end))
+                         << " but returning parts already decoded" << std::endl;
                 return out;
             }
         }
@@ -496,14 +538,6 @@ goby::acomms::QueueManager::decode_repeated(const std::string& orig_bytes)
     return out;
 }
 
-unsigned goby::acomms::QueueManager::size_repeated(const std::list<QueuedMessage>& msgs)
-{
-    unsigned out = 0;
-    BOOST_FOREACH (const QueuedMessage& msg, msgs)
-        out += codec_->size(*(msg.dccl_msg));
-    return out;
-}
-
 void goby::acomms::QueueManager::clear_packet(const protobuf::ModemTransmission& message)
 {
     for (std::multimap<unsigned, Queue*>::iterator it = waiting_for_ack_.begin(),
@@ -520,32 +554,52 @@ void goby::acomms::QueueManager::clear_packet(const protobuf::ModemTransmission&
     packet_dest_ = message.dest();
 }
 
+namespace
+{
+// an entry in the priority contest of QueueManager::find_next_sender
+struct PriorityCandidate
+{
+    double priority;
+    boost::posix_time::ptime last_send_time;
+    unsigned dccl_id;
+    goby::acomms::Queue* queue;
+
+    // true if this loses to other: lower priority, or equal priority and more recently sent,
+    // and finally the higher DCCL id (the order the queues were once checked in)
+    bool operator<(const PriorityCandidate& other) const
+    {
+        if (priority != other.priority)
+            return priority < other.priority;
+        else if (last_send_time != other.last_send_time)
+            return last_send_time > other.last_send_time;
+        else
+            return dccl_id > other.dccl_id;
+    }
+};
+} // namespace
+
 goby::acomms::Queue*
 goby::acomms::QueueManager::find_next_sender(const protobuf::ModemTransmission& request_msg,
                                              const std::string& data, bool first_user_frame)
 {
-    // competition between variable about who gets to send
-    double winning_priority;
-    boost::posix_time::ptime winning_last_send_time;
-
-    Queue* winning_queue = 0;
-
     glog.is(DEBUG1) && glog << group(glog_priority_group_) << "Starting priority contest\n"
                             << "\tRequesting " << request_msg.max_num_frames() << " frame(s), have "
                             << data.size() << "/" << request_msg.max_frame_bytes() << "B"
                             << std::endl;
 
-    for (std::map<unsigned, boost::shared_ptr<Queue> >::iterator it = queues_.begin(),
-                                                                 n = queues_.end();
+    // encode on demand
+    const std::set<unsigned>& on_demand_ids = manip_manager_.ids(protobuf::ON_DEMAND);
+    for (std::set<unsigned>::const_iterator it = on_demand_ids.begin(), n = on_demand_ids.end();
          it != n; ++it)
     {
-        Queue& q = *(it->second);
+        std::map<unsigned, boost::shared_ptr<Queue> >::iterator q_it = queues_.find(*it);
+        if (q_it == queues_.end())
+            continue;
 
-        // encode on demand
-        if (manip_manager_.has(codec_->id(q.descriptor()), protobuf::ON_DEMAND) &&
-            (!q.size() || q.newest_msg_time() + boost::posix_time::microseconds(
-                                                    cfg_.on_demand_skew_seconds() * 1e6) <
-                              common::goby_time()))
+        Queue& q = *(q_it->second);
+        if (!q.size() || q.newest_msg_time() + boost::posix_time::microseconds(
+                                                   cfg_.on_demand_skew_seconds() * 1e6) <
+                             common::goby_time())
         {
             boost::shared_ptr<google::protobuf::Message> new_msg =
                 goby::util::DynamicProtobufManager::new_protobuf_message(q.descriptor());
@@ -554,6 +608,69 @@ goby::acomms::QueueManager::find_next_sender(const protobuf::ModemTransmission&
             if (new_msg->IsInitialized())
                 push_message(*new_msg);
         }
+    }
+
+    // only queues with sendable messages can win; of these, check the remaining conditions
+    // (blackout, size, destination, ack) in order of priority, so the first that passes wins
+    boost::posix_time::ptime now = common::goby_time();
+    std::vector<PriorityCandidate> candidates;
+    candidates.reserve(sendable_queues_.size());
+    for (std::map<unsigned, Queue*>::const_iterator it = sendable_queues_.begin(),
+                                                    n = sendable_queues_.end();
+         it != n; ++it)
+    {
+        PriorityCandidate candidate;
+        candidate.priority = it->second->priority(now);
+        candidate.last_send_time = it->second->last_send_time();
+        candidate.dccl_id = it->first;
+        candidate.queue = it->second;
+        candidates.push_back(candidate);
+    }
+    std::make_heap(candidates.begin(), candidates.end());
+
+    Queue* winning_queue = 0;
+    while (!candidates.empty())
+    {
+        std::pop_heap(candidates.begin(), candidates.end());
+        if (candidates.back().queue->can_send(request_msg, data, now))
+        {
+            winning_queue = candidates.back().queue;
+            break;
+        }
+        candidates.pop_back();
+    }
+
+    if (winning_queue)
+    {
+        glog.is(DEBUG1) && glog << group(glog_priority_group_) << winning_queue->name()
+                                << " has highest priority." << std::endl;
+    }
+    else
+    {
+        glog.is(DEBUG1) && glog << group(glog_priority_group_) << "\t"
+                                << "all other queues have no messages" << std::endl;
+        glog.is(DEBUG1) && glog << group(glog_priority_group_) << "ending priority contest"
+                                << std::endl;
+    }
+
+    return winning_queue;
+}
+
+goby::acomms::Queue*
+goby::acomms::QueueManager::find_next_sender_linear(const protobuf::ModemTransmission& request_msg,
+                                                    const std::string& data)
+{
+    // competition between variable about who gets to send
+    double winning_priority;
+    boost::posix_time::ptime winning_last_send_time;
+
+    Queue* winning_queue = 0;
+
+    for (std::map<unsigned, boost::shared_ptr<Queue> >::iterator it = queues_.begin(),
+                                                                 n = queues_.end();
+         it != n; ++it)
+    {
+        Queue& q = *(it->second);
 
         double priority;
         boost::posix_time::ptime last_send_time;
@@ -570,21 +687,16 @@ goby::acomms::QueueManager::find_next_sender(const protobuf::ModemTransmission&
         }
     }
 
-    glog.is(DEBUG1) && glog << group(glog_priority_group_) << "\t"
-                            << "all other queues have no messages" << std::endl;
+    return winning_queue;
+}
 
-    if (winning_queue)
-    {
-        glog.is(DEBUG1) && glog << group(glog_priority_group_) << winning_queue->name()
-                                << " has highest priority." << std::endl;
-    }
+void goby::acomms::QueueManager::update_sendable(Queue* q)
+{
+    unsigned dccl_id = codec_->id(q->descriptor());
+    if (q->sendable())
+        sendable_queues_[dccl_id] = q;
     else
-    {
-        glog.is(DEBUG1) && glog << group(glog_priority_group_) << "ending priority contest"
-                                << std::endl;
-    }
-
-    return winning_queue;
+        sendable_queues_.erase(dccl_id);
 }
 
 void goby::acomms::QueueManager::process_modem_ack(const protobuf::ModemTransmission& ack_msg)
@@ -809,6 +921,12 @@ void goby::acomms::QueueManager::process_cfg()
 
         encrypt_rules_[cfg_.encrypt_rule(i).id()] = cfg_.encrypt_rule(i).crypto_passphrase();
     }
+
+    // cached encodings may have used the old passphrases
+    for (std::map<unsigned, boost::shared_ptr<Queue> >::iterator it = queues_.begin(),
+                                                                 end = queues_.end();
+         it != end; ++it)
+        it->second->clear_encoded();
 }
 
 void goby::acomms::QueueManager::qsize(Queue* q)
@@ -222,6 +222,16 @@ class QueueManager
     /// queue_simple.cpp
     /// \example acomms/chat/chat.cpp
 
+  protected:
+    // finds the %queue with the highest priority
+    Queue* find_next_sender(const protobuf::ModemTransmission& message, const std::string& data,
+                            bool first_user_frame);
+
+    // reference implementation of the priority contest of find_next_sender() (checks every
+    // %queue, does not encode on demand), used to verify it
+    Queue* find_next_sender_linear(const protobuf::ModemTransmission& message,
+                                   const std::string& data);
+
   private:
     QueueManager(const QueueManager&);
     QueueManager& operator=(const QueueManager&);
@@ -229,9 +239,8 @@ class QueueManager
 
     void qsize(Queue* q);
 
-    // finds the %queue with the highest priority
-    Queue* find_next_sender(const protobuf::ModemTransmission& message, const std::string& data,
-                            bool first_user_frame);
+    // called by Queue when it may have gained or lost sendable messages
+    void update_sendable(Queue* q);
 
     // clears the destination and ack values for the packet to reset for next $CADRQ
     void clear_packet(const protobuf::ModemTransmission& message);
@@ -243,8 +252,12 @@ class QueueManager
 
     // "overload" those from DCCLCodec to allow changing of crypto passphrase
     std::string encode_repeated(const std::list<QueuedMessage>& msgs);
-    std::list<QueuedMessage> decode_repeated(const std::string& orig_bytes);
-    unsigned size_repeated(const std::list<QueuedMessage>& msgs);
+    std::list<QueuedMessage> decode_repeated(const std::string& bytes);
+
+    // encodes using the crypto passphrase (if any) for the given destination
+    void encode(const google::protobuf::Message& dccl_msg, int dest, std::string* bytes);
+    // fills in msg->encoded, leaving it empty if the message cannot be encoded
+    void cache_encoded(QueuedMessage* msg);
 
   private:
     friend class Queue;
@@ -266,6 +279,10 @@ class QueueManager
     // maps id to crypto passphrase
     std::map<ModemId, std::string> encrypt_rules_;
 
+    // queues with messages not waiting for an ack (the only ones that can win a priority
+    // contest), keyed by DCCL id
+    std::map<unsigned, Queue*> sendable_queues_;
+
     protobuf::QueueManagerConfig cfg_;
 
     goby::acomms::DCCLCodec* codec_;
@@ -284,6 +301,16 @@ class QueueManager
         void add(unsigned id, goby::acomms::protobuf::Manipulator manip)
         {
             manips_.insert(std::make_pair(id, manip));
+            ids_[manip].insert(id);
+        }
+
+        /// DCCL ids of queues with a given manipulator
+        const std::set<unsigned>& ids(goby::acomms::protobuf::Manipulator manip) const
+        {
+            static const std::set<unsigned> empty;
+            std::map<goby::acomms::protobuf::Manipulator, std::set<unsigned> >::const_iterator it =
+                ids_.find(manip);
+            return (it != ids_.end()) ? it->second : empty;
         }
 
         bool has(unsigned id, goby::acomms::protobuf::Manipulator manip) const
@@ -301,12 +328,18 @@ class QueueManager
             return false;
         }
 
-        void clear() { manips_.clear(); }
+        void clear()
+        {
+            manips_.clear();
+            ids_.clear();
+        }
 
       private:
         // manipulator multimap (no_encode, no_decode, etc)
         // maps DCCL ID (unsigned) onto Manipulator enumeration (xml_config.proto)
         std::multimap<unsigned, goby::acomms::protobuf::Manipulator> manips_;
+        // reverse of manips_
+        std::map<goby::acomms::protobuf::Manipulator, std::set<unsigned> > ids_;
     };
 
     ManipulatorManager manip_manager_;
@@ -19,6 +19,7 @@
 // You should have received a copy of the GNU General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -28,6 +29,10 @@
 
 #include "goby/pb/application.h"
 
+#include "goby/acomms/file_compression.h"
+#include "goby/acomms/file_fragment_window.h"
+#include "goby/common/exception.h"
+
 #include "file_transfer_config.pb.h"
 #include "goby/acomms/protobuf/file_transfer.pb.h"
 
@@ -45,24 +50,46 @@ class FileTransfer : public goby::pb::Application
     ~FileTransfer();
 
   private:
-    void loop() {}
+    typedef int ModemId;
+
+    /// \brief Receiver side of a transfer. Kept after a failed or interrupted transfer so that a
+    /// repeated request for the same file resumes from the fragments already held.
+    struct IncomingFile
+    {
+        IncomingFile() : complete(false) {}
+
+        FileFragmentReceiver fragments;
+        bool complete;
+        protobuf::TransferResponse response;
+    };
+
+    void loop();
 
     void push_file();
     void pull_file();
 
-    int send_file(const std::string& path);
+    int send_file(const std::string& path, ModemId dest,
+                  protobuf::TransferRequest::Compression compression);
+    void fill_window(ModemId dest, FileFragmentSender& out);
+    void publish_fragment(ModemId dest, const FileFragmentSender& out, int index);
 
     void handle_remote_transfer_request(const protobuf::TransferRequest& request);
     void handle_receive_fragment(const protobuf::FileFragment& fragment);
+    void handle_receive_nack(const protobuf::FileFragmentNack& nack);
 
     void handle_receive_response(const protobuf::TransferResponse& response);
 
+    void send_nack(ModemId src, IncomingFile& in, bool idle = false);
+    void write_file(ModemId src, IncomingFile& in);
+
     void handle_ack(const protobuf::TransferRequest& request)
     {
         std::cout << "Got ack for request: " << request.DebugString() << std::endl;
         waiting_for_request_ack_ = false;
     }
 
+    void handle_fragment_ack(const protobuf::FileFragment& fragment);
+
   private:
     protobuf::FileTransferConfig& cfg_;
 
@@ -71,9 +98,8 @@ class FileTransfer : public goby::pb::Application
         MAX_FILE_TRANSFER_BYTES = 1024 * 1024
     };
 
-    typedef int ModemId;
-
-    std::map<ModemId, std::map<int, protobuf::FileFragment> > receive_files_;
+    std::map<ModemId, IncomingFile> receive_files_;
+    std::map<ModemId, FileFragmentSender> send_files_;
     std::map<ModemId, protobuf::TransferRequest> requests_;
     bool waiting_for_request_ack_;
 };
@@ -128,12 +154,18 @@ goby::acomms::FileTransfer::FileTransfer(protobuf::FileTransferConfig* cfg)
     subscribe(&FileTransfer::handle_ack, this,
               "QueueAckOrig" + goby::util::as<std::string>(cfg_.local_id()));
 
+    subscribe(&FileTransfer::handle_fragment_ack, this,
+              "QueueAckOrig" + goby::util::as<std::string>(cfg_.local_id()));
+
     subscribe(&FileTransfer::handle_remote_transfer_request, this,
               "QueueRx" + goby::util::as<std::string>(cfg_.local_id()));
 
     subscribe(&FileTransfer::handle_receive_fragment, this,
               "QueueRx" + goby::util::as<std::string>(cfg_.local_id()));
 
+    subscribe(&FileTransfer::handle_receive_nack, this,
+              "QueueRx" + goby::util::as<std::string>(cfg_.local_id()));
+
     subscribe(&FileTransfer::handle_receive_response, this,
               "QueueRx" + goby::util::as<std::string>(cfg_.local_id()));
 
@@ -159,12 +191,65 @@ goby::acomms::FileTransfer::FileTransfer(protobuf::FileTransferConfig* cfg)
     }
 }
 
+void goby::acomms::FileTransfer::loop()
+{
+    double now = goby::common::goby_time<double>();
+
+    for (std::map<ModemId, FileFragmentSender>::iterator it = send_files_.begin(),
+                                                         end = send_files_.end();
+         it != end;)
+    {
+        FileFragmentSender& out = it->second;
+        if (now > out.last_feedback_time() + cfg_.request_timeout())
+        {
+            glog.is(WARN) && glog << "File transfer action failed: no feedback from " << it->first
+                                  << " in " << cfg_.request_timeout() << " seconds"
+                                  << std::endl;
+            send_files_.erase(it++);
+            if (!cfg_.daemon())
+                exit(EXIT_FAILURE);
+            continue;
+        }
+
+        const int in_flight = out.in_flight();
+        switch (out.check_timer(now))
+        {
+            case FileFragmentSender::TIMER_NONE: break;
+            case FileFragmentSender::TIMER_RESEND:
+                glog.is(VERBOSE) && glog << "No feedback from " << it->first << ", resending "
+                                         << in_flight << " fragments" << std::endl;
+                break;
+            case FileFragmentSender::TIMER_PROBE:
+                // a duplicate of the last fragment makes the receiver repeat its response
+                publish_fragment(it->first, out, out.num_fragments() - 1);
+                break;
+        }
+
+        fill_window(it->first, out);
+        ++it;
+    }
+
+    for (std::map<ModemId, IncomingFile>::iterator it = receive_files_.begin(),
+                                                   end = receive_files_.end();
+         it != end; ++it)
+    {
+        IncomingFile& in = it->second;
+        if (!in.complete &&
+            in.fragments.nack_due(now, cfg_.nack_timeout(), cfg_.request_timeout()))
+            send_nack(it->first, in, true);
+    }
+}
+
 void goby::acomms::FileTransfer::push_file()
 {
+    // read the file before asking the remote to expect it
+    send_file(cfg_.local_file(), cfg_.remote_id(), cfg_.compression());
+
     protobuf::TransferRequest request;
     request.set_src(cfg_.local_id());
     request.set_dest(cfg_.remote_id());
     request.set_push_or_pull(protobuf::TransferRequest::PUSH);
+    request.set_compression(send_files_[cfg_.remote_id()].compression());
     request.set_file(cfg_.remote_file());
 
     publish(request, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
@@ -175,11 +260,17 @@ void goby::acomms::FileTransfer::push_file()
     {
         zeromq_service().poll(10000);
         if (!waiting_for_request_ack_)
-        {
-            send_file(cfg_.local_file());
             break;
-        }
     }
+
+    if (waiting_for_request_ack_)
+    {
+        send_files_.erase(cfg_.remote_id());
+        throw protobuf::TransferResponse::TIMEOUT;
+    }
+
+    // fragments are streamed from loop() from here on
+    send_files_[cfg_.remote_id()].reset_timer(goby::common::goby_time<double>());
 }
 
 void goby::acomms::FileTransfer::pull_file()
@@ -188,6 +279,8 @@ void goby::acomms::FileTransfer::pull_file()
     request.set_src(cfg_.local_id());
     request.set_dest(cfg_.remote_id());
     request.set_push_or_pull(protobuf::TransferRequest::PULL);
+    if (compression_available(cfg_.compression()))
+        request.set_compression(cfg_.compression());
     request.set_file(cfg_.remote_file());
 
     publish(request, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
@@ -196,11 +289,12 @@ void goby::acomms::FileTransfer::pull_file()
     request.set_file(cfg_.local_file());
     request.set_src(cfg_.remote_id());
     request.set_dest(cfg_.local_id());
-    receive_files_[request.src()].clear();
+    receive_files_[request.src()] = IncomingFile();
     requests_[request.src()] = request;
 }
 
-int goby::acomms::FileTransfer::send_file(const std::string& path)
+int goby::acomms::FileTransfer::send_file(const std::string& path, ModemId dest,
+                                          protobuf::TransferRequest::Compression compression)
 {
     std::ifstream send_file(path.c_str(), std::ios::binary | std::ios::ate);
 
@@ -224,55 +318,43 @@ int goby::acomms::FileTransfer::send_file(const std::string& path)
     // seek to front
     send_file.seekg(0, send_file.beg);
 
-    int size_acquired = 0;
-    // fragment into little bits
-
-    int fragment_size = protobuf::FileFragment::descriptor()
-                            ->FindFieldByName("data")
-                            ->options()
-                            .GetExtension(dccl::field)
-                            .max_length();
+    const int file_size = size;
+    std::string contents(file_size, 0);
+    if (file_size > 0)
+        send_file.read(&contents[0], file_size);
 
-    protobuf::FileFragment reference_fragment;
-    reference_fragment.set_src(cfg_.local_id());
-    reference_fragment.set_dest(cfg_.remote_id());
-
-    std::vector<protobuf::FileFragment> fragments(std::ceil((double)size / fragment_size),
-                                                  reference_fragment);
+    if (send_file.gcount() != file_size)
+        throw protobuf::TransferResponse::ERROR_WHILE_READING;
 
-    std::vector<protobuf::FileFragment>::iterator fragments_it = fragments.begin();
-    std::vector<char> buffer(fragment_size);
-    int fragment_idx = 0;
-    while (send_file.good())
-    {
-        protobuf::FileFragment& fragment = *(fragments_it++);
-        send_file.read(&buffer[0], fragment_size);
-        int bytes_read = send_file.gcount();
-        size_acquired += bytes_read;
-        fragment.set_fragment(fragment_idx++);
-        if (size_acquired == size)
-            fragment.set_is_last_fragment(true);
-        else
-            fragment.set_is_last_fragment(false);
-        fragment.set_num_bytes(bytes_read);
+    std::string data;
+    const protobuf::TransferRequest::Compression applied = compress(compression, contents, &data);
+    glog.is(VERBOSE) && glog << "Sending " << data.size() << " bytes ("
+                             << protobuf::TransferRequest::Compression_Name(applied) << ")"
+                             << std::endl;
 
-        fragment.set_data(std::string(buffer.begin(), buffer.begin() + bytes_read));
-    }
+    FileFragmentSender& out = send_files_[dest];
+    out = FileFragmentSender(data, applied, cfg_.window_size(), cfg_.retransmit_timeout(),
+                             goby::common::goby_time<double>());
+    return out.num_fragments();
+}
 
-    if (!send_file.eof())
-        throw protobuf::TransferResponse::ERROR_WHILE_READING;
+void goby::acomms::FileTransfer::fill_window(ModemId dest, FileFragmentSender& out)
+{
+    int index = 0;
+    while (out.next_fragment(&index)) publish_fragment(dest, out, index);
+}
 
-    // FOR TESTING!
-    // fragments.resize(fragments.size()*2);
-    // std::copy_backward(fragments.begin(), fragments.begin()+fragments.size()/2, fragments.end());
-    // std::random_shuffle(fragments.begin(), fragments.end());
-    for (int i = 0, n = fragments.size(); i < n; ++i)
-    {
-        glog.is(VERBOSE) && glog << fragments[i].ShortDebugString() << std::endl;
-        publish(fragments[i], "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
-    }
+void goby::acomms::FileTransfer::publish_fragment(ModemId dest, const FileFragmentSender& out,
+                                                  int index)
+{
+    protobuf::FileFragment fragment;
+    fragment.set_src(cfg_.local_id());
+    fragment.set_dest(dest);
+    out.get_fragment(index, &fragment);
 
-    return fragment_idx;
+    glog.is(VERBOSE) && glog << "Sending fragment #" << index << " of " << out.num_fragments()
+                             << std::endl;
+    publish(fragment, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
 }
 
 goby::acomms::FileTransfer::~FileTransfer() {}
@@ -285,8 +367,38 @@ void goby::acomms::FileTransfer::handle_remote_transfer_request(
 
     if (request.push_or_pull() == protobuf::TransferRequest::PUSH)
     {
+        if (!compression_available(request.compression()))
+        {
+            glog.is(WARN) && glog << "Cannot receive file: compression "
+                                  << protobuf::TransferRequest::Compression_Name(
+                                         request.compression())
+                                  << " is not supported by this build" << std::endl;
+            protobuf::TransferResponse response;
+            response.set_src(request.dest());
+            response.set_dest(request.src());
+            response.set_transfer_successful(false);
+            response.set_error(protobuf::TransferResponse::UNSUPPORTED_COMPRESSION);
+            publish(response, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
+            return;
+        }
+
+        IncomingFile& in = receive_files_[request.src()];
+        std::map<ModemId, protobuf::TransferRequest>::const_iterator previous =
+            requests_.find(request.src());
+
+        if (!in.complete && !in.fragments.empty() && previous != requests_.end() &&
+            previous->second.file() == request.file() &&
+            previous->second.compression() == request.compression())
+        {
+            glog.is(VERBOSE) && glog << "Resuming receive of file with " << in.fragments.size()
+                                     << " fragments already held" << std::endl;
+            requests_[request.src()] = request;
+            send_nack(request.src(), in);
+            return;
+        }
+
         glog.is(VERBOSE) && glog << "Preparing to receive file..." << std::endl;
-        receive_files_[request.src()].clear();
+        in = IncomingFile();
     }
     else if (request.push_or_pull() == protobuf::TransferRequest::PULL)
     {
@@ -295,7 +407,8 @@ void goby::acomms::FileTransfer::handle_remote_transfer_request(
         response.set_dest(request.src());
         try
         {
-            response.set_num_fragments(send_file(request.file()));
+            response.set_num_fragments(
+                send_file(request.file(), request.src(), request.compression()));
             response.set_transfer_successful(true);
         }
         catch (protobuf::TransferResponse::ErrorCode& c)
@@ -323,69 +436,137 @@ void goby::acomms::FileTransfer::handle_remote_transfer_request(
 
 void goby::acomms::FileTransfer::handle_receive_fragment(const protobuf::FileFragment& fragment)
 {
-    std::map<int, protobuf::FileFragment>& receive = receive_files_[fragment.src()];
+    IncomingFile& in = receive_files_[fragment.src()];
 
-    receive.insert(std::make_pair(fragment.fragment(), fragment));
+    if (in.complete)
+    {
+        // the sender is probing because our response was lost
+        publish(in.response, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
+        return;
+    }
+
+    const bool nack_now = in.fragments.add_fragment(fragment, cfg_.nack_interval(),
+                                                    goby::common::goby_time<double>());
 
     glog.is(VERBOSE) && glog << "Received fragment #" << fragment.fragment()
-                             << ", total received: " << receive.size() << std::endl;
+                             << ", total received: " << in.fragments.size() << std::endl;
+
+    if (in.fragments.all_received())
+    {
+        write_file(fragment.src(), in);
+    }
+    else
+    {
+        glog.is(VERBOSE) && glog << "Still waiting on some fragments..." << std::endl;
+        if (nack_now)
+            send_nack(fragment.src(), in);
+    }
+}
 
-    if (receive.rbegin()->second.is_last_fragment())
+void goby::acomms::FileTransfer::send_nack(ModemId src, IncomingFile& in, bool idle)
+{
+    protobuf::FileFragmentNack nack;
+    nack.set_src(cfg_.local_id());
+    nack.set_dest(src);
+    in.fragments.make_nack(&nack, goby::common::goby_time<double>(), idle);
+
+    glog.is(VERBOSE) && glog << "Sending NACK: " << nack.ShortDebugString() << std::endl;
+    publish(nack, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
+}
+
+void goby::acomms::FileTransfer::write_file(ModemId src, IncomingFile& in)
+{
+    protobuf::TransferResponse response;
+    response.set_src(requests_[src].dest());
+    response.set_dest(requests_[src].src());
+
+    try
     {
-        if ((int)receive.size() == receive.rbegin()->second.fragment() + 1)
+        glog.is(VERBOSE) && glog << "Received all fragments!" << std::endl;
+        glog.is(VERBOSE) && glog << "Writing to " << requests_[src].file() << std::endl;
+        std::string data;
+        const protobuf::TransferRequest::Compression compression = in.fragments.assemble(&data);
+        std::string contents;
+        try
         {
-            protobuf::TransferResponse response;
-            response.set_src(requests_[fragment.src()].dest());
-            response.set_dest(requests_[fragment.src()].src());
-
-            try
-            {
-                glog.is(VERBOSE) && glog << "Received all fragments!" << std::endl;
-                glog.is(VERBOSE) && glog << "Writing to " << requests_[fragment.src()].file()
-                                         << std::endl;
-                std::ofstream receive_file(requests_[fragment.src()].file().c_str(),
-                                           std::ios::binary);
-
-                // check open
-                if (!receive_file.is_open())
-                    throw(protobuf::TransferResponse::COULD_NOT_WRITE_FILE);
-
-                for (std::map<int, protobuf::FileFragment>::const_iterator it = receive.begin(),
-                                                                           end = receive.end();
-                     it != end; ++it)
-                { receive_file.write(it->second.data().c_str(), it->second.num_bytes()); }
-
-                receive_file.close();
-                response.set_transfer_successful(true);
-                if (!cfg_.daemon())
-                    exit(EXIT_SUCCESS);
-            }
-            catch (protobuf::TransferResponse::ErrorCode& c)
-            {
-                glog.is(WARN) && glog << "File transfer action failed: "
-                                      << protobuf::TransferResponse::ErrorCode_Name(c) << std::endl;
-                response.set_transfer_successful(false);
-                response.set_error(c);
-
-                if (!cfg_.daemon())
-                    exit(EXIT_FAILURE);
-            }
-            catch (std::exception& e)
-            {
-                glog.is(WARN) && glog << "File transfer action failed: " << e.what() << std::endl;
-                if (!cfg_.daemon())
-                    exit(EXIT_FAILURE);
-
-                response.set_transfer_successful(false);
-                response.set_error(protobuf::TransferResponse::OTHER_ERROR);
-            }
-            publish(response, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
+            decompress(compression, data, &contents, MAX_FILE_TRANSFER_BYTES);
         }
-        else
+        catch (goby::Exception& e)
         {
-            glog.is(VERBOSE) && glog << "Still waiting on some fragments..." << std::endl;
+            glog.is(WARN) && glog << e.what() << std::endl;
+            throw(protobuf::TransferResponse::DECOMPRESSION_FAILED);
         }
+
+        glog.is(VERBOSE) && glog << "Received " << data.size() << " bytes ("
+                                 << protobuf::TransferRequest::Compression_Name(compression)
+                                 << ") for " << contents.size() << " byte file" << std::endl;
+
+        std::ofstream receive_file(requests_[src].file().c_str(), std::ios::binary);
+
+        // check open
+        if (!receive_file.is_open())
+            throw(protobuf::TransferResponse::COULD_NOT_WRITE_FILE);
+
+        receive_file.write(contents.data(), contents.size());
+        receive_file.close();
+        response.set_transfer_successful(true);
+        if (!cfg_.daemon())
+            exit(EXIT_SUCCESS);
+    }
+    catch (protobuf::TransferResponse::ErrorCode& c)
+    {
+        glog.is(WARN) && glog << "File transfer action failed: "
+                              << protobuf::TransferResponse::ErrorCode_Name(c) << std::endl;
+        response.set_transfer_successful(false);
+        response.set_error(c);
+
+        if (!cfg_.daemon())
+            exit(EXIT_FAILURE);
+    }
+    catch (std::exception& e)
+    {
+        glog.is(WARN) && glog << "File transfer action failed: " << e.what() << std::endl;
+        if (!cfg_.daemon())
+            exit(EXIT_FAILURE);
+
+        response.set_transfer_successful(false);
+        response.set_error(protobuf::TransferResponse::OTHER_ERROR);
     }
+
+    // keep the response so it can be repeated if the sender probes again
+    in.complete = true;
+    in.response = response;
+    in.fragments.clear();
+
+    publish(response, "QueuePush" + goby::util::as<std::string>(cfg_.local_id()));
+}
+
+void goby::acomms::FileTransfer::handle_receive_nack(const protobuf::FileFragmentNack& nack)
+{
+    std::map<ModemId, FileFragmentSender>::iterator it = send_files_.find(nack.src());
+    if (it == send_files_.end())
+        return;
+
+    FileFragmentSender& out = it->second;
+    if (!out.handle_nack(nack, goby::common::goby_time<double>()))
+    {
+        glog.is(WARN) && glog << "Ignoring NACK that does not match the file being sent: "
+                              << nack.ShortDebugString() << std::endl;
+        return;
+    }
+
+    glog.is(VERBOSE) && glog << "Received NACK: " << nack.ShortDebugString() << std::endl;
+    glog.is(VERBOSE) && glog << "Acknowledged " << out.num_acked() << "/" << out.num_fragments()
+                             << " fragments, " << out.num_lost() << " to resend" << std::endl;
+
+    fill_window(it->first, out);
+}
+
+void goby::acomms::FileTransfer::handle_fragment_ack(const protobuf::FileFragment& fragment)
+{
+    std::map<ModemId, FileFragmentSender>::iterator it = send_files_.find(fragment.dest());
+    if (it != send_files_.end())
+        it->second.handle_fragment_ack(fragment.fragment(), goby::common::goby_time<double>());
 }
 
 void goby::acomms::FileTransfer::handle_receive_response(const protobuf::TransferResponse& response)
@@ -393,6 +574,10 @@ void goby::acomms::FileTransfer::handle_receive_response(const protobuf::Transfe
     glog.is(VERBOSE) && glog << "Received response for file transfer: " << response.DebugString()
                              << std::flush;
 
+    // the response to a pull request only announces the fragment count
+    if (!response.has_num_fragments())
+        send_files_.erase(response.src());
+
     if (!response.transfer_successful())
         glog.is(WARN) && glog << "Transfer failed: "
                               << protobuf::TransferResponse::ErrorCode_Name(response.error())
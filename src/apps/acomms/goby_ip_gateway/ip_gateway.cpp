@@ -19,18 +19,24 @@
 // You should have received a copy of the GNU General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <fcntl.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 
 #include <boost/bimap.hpp>
 #include <boost/circular_buffer.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include "dccl/arithmetic/field_codec_arithmetic.h"
 
 #include "goby/acomms/acomms_constants.h"
 #include "goby/acomms/amac.h"
 #include "goby/acomms/connect.h"
+#include "goby/acomms/deficit_round_robin.h"
 #include "goby/acomms/ip_codecs.h"
 #include "goby/acomms/protobuf/modem_message.pb.h"
 #include "goby/pb/application.h"
@@ -69,11 +75,13 @@ class IPGateway : public goby::pb::Application
     void init_tun();
 
     void loop();
+    void tun_read_thread();
     void receive_packets();
+    bool handle_tun_packet(const char* buffer, int len);
 
     void handle_udp_packet(const goby::acomms::protobuf::IPv4Header& ip_hdr,
                            const goby::acomms::protobuf::UDPHeader& udp_hdr,
-                           const std::string& payload);
+                           const char* payload, int payload_size);
     void write_udp_packet(goby::acomms::protobuf::IPv4Header& ip_hdr,
                           goby::acomms::protobuf::UDPHeader& udp_hdr, const std::string& payload);
     void write_icmp_control_message(const protobuf::IPGatewayICMPControl& control_msg);
@@ -96,6 +104,8 @@ class IPGateway : public goby::pb::Application
 
     int ac_freq(int srcdest);
 
+    int drr_quantum(int dest);
+
   private:
     goby::acomms::protobuf::IPGatewayConfig& cfg_;
     dccl::Codec dccl_goby_nh_, dccl_ip_, dccl_udp_, dccl_icmp_;
@@ -114,8 +124,48 @@ class IPGateway : public goby::pb::Application
 
     int ip_mtu_; // the MTU on the tun interface, which is slightly different than the Goby MTU specified in the config file since the IP and Goby NetworkHeader are different sizes.
 
+    struct OutgoingQueue
+    {
+        OutgoingQueue(int queue_size)
+            : packets(queue_size), bytes_sent(0), packets_sent(0)
+        {
+        }
+        boost::circular_buffer<std::string> packets;
+        goby::uint64 bytes_sent;
+        goby::uint64 packets_sent;
+    };
+
     // maps destination goby address to message buffer
-    std::map<int, boost::circular_buffer<std::string> > outgoing_;
+    std::map<int, OutgoingQueue> outgoing_;
+    // storage of frames already sent, reused for new frames
+    std::vector<std::string> spare_frames_;
+    // shares QUERY_DESTINATION_ID transmissions among the destinations
+    DeficitRoundRobin drr_;
+    std::map<int, DeficitRoundRobin::Backlog> drr_backlog_;
+
+    // tun_read_thread() drains the tun device into a pool of tun_pool_size() slots of ip_mtu_
+    // bytes each, handing the filled slots to receive_packets() in batches
+    std::vector<char> tun_pool_;
+    std::vector<int> tun_pool_len_;
+    std::vector<int> tun_free_slots_;
+    std::vector<int> tun_ready_slots_;
+    std::vector<int> tun_batch_;
+    boost::mutex tun_mutex_;
+    boost::condition_variable tun_slot_free_;
+    bool tun_quit_;
+    bool tun_eof_;
+    bool tun_wait_failed_;
+    int tun_read_errors_;
+    int tun_epoll_fd_;
+    int tun_wake_fd_; // eventfd to stop tun_read_thread()
+    boost::scoped_ptr<boost::thread> tun_thread_;
+
+    // reused for each packet
+    goby::acomms::protobuf::IPv4Header tun_ip_hdr_;
+    goby::acomms::protobuf::UDPHeader tun_udp_hdr_;
+    goby::acomms::protobuf::ICMPHeader tun_icmp_hdr_;
+    goby::acomms::protobuf::NetworkHeader tun_net_header_;
+    std::string tun_nh_;
 };
 } // namespace acomms
 } // namespace goby
@@ -127,7 +177,8 @@ goby::acomms::IPGateway::IPGateway(goby::acomms::protobuf::IPGatewayConfig* cfg)
       total_addresses_((1 << (IPV4_ADDRESS_BITS - cfg_.cidr_netmask_prefix())) -
                        1), // minus one since we don't need to use .255 as broadcast
       local_address_(0), local_modem_id_(0), netmask_(0),
-      dynamic_port_index_(cfg_.static_udp_port_size())
+      dynamic_port_index_(cfg_.static_udp_port_size()), tun_quit_(false), tun_eof_(false),
+      tun_wait_failed_(false), tun_read_errors_(0), tun_epoll_fd_(-1), tun_wake_fd_(-1)
 {
     for (int d = 0; d < total_addresses_; ++d)
     {
@@ -151,6 +202,12 @@ goby::acomms::IPGateway::IPGateway(goby::acomms::protobuf::IPGatewayConfig* cfg)
     init_dccl();
     init_tun();
 
+    for (int i = 0, n = cfg_.destination_weight_size(); i < n; ++i)
+    {
+        if (cfg_.destination_weight(i).weight() <= 0)
+            glog.is(DIE) && glog << "destination_weight.weight must be > 0" << std::endl;
+    }
+
     Application::subscribe(&IPGateway::handle_data_request, this,
                            "DataRequest" + goby::util::as<std::string>(local_modem_id_));
     Application::subscribe(&IPGateway::handle_modem_receive, this,
@@ -160,6 +217,8 @@ goby::acomms::IPGateway::IPGateway(goby::acomms::protobuf::IPGatewayConfig* cfg)
                           &IPGateway::handle_initiate_transmission);
     cfg_.mutable_mac_cfg()->set_modem_id(local_modem_id_);
     mac_.startup(cfg_.mac_cfg());
+
+    tun_thread_.reset(new boost::thread(boost::bind(&IPGateway::tun_read_thread, this)));
 }
 void goby::acomms::IPGateway::init_dccl()
 {
@@ -277,9 +336,58 @@ void goby::acomms::IPGateway::init_tun()
     local_address_ = ntohl(local_addr.s_addr);
     netmask_ = 0xFFFFFFFF - ((1 << (IPV4_ADDRESS_BITS - cfg_.cidr_netmask_prefix())) - 1);
     local_modem_id_ = ipv4_to_goby_address(cfg_.local_ipv4_address());
+
+    // non-blocking so that tun_read_thread() can drain all the queued packets on each wakeup
+    if (fcntl(tun_fd_, F_SETFL, fcntl(tun_fd_, F_GETFL) | O_NONBLOCK) < 0)
+        glog.is(DIE) && glog << "Could not set tun interface to non-blocking" << std::endl;
+
+    tun_wake_fd_ = eventfd(0, EFD_NONBLOCK);
+    tun_epoll_fd_ = epoll_create(2);
+    if (tun_wake_fd_ < 0 || tun_epoll_fd_ < 0)
+        glog.is(DIE) && glog << "Could not create epoll instance for tun interface" << std::endl;
+
+    epoll_event tun_event = {0};
+    tun_event.events = EPOLLIN;
+    tun_event.data.fd = tun_fd_;
+    epoll_event wake_event = {0};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = tun_wake_fd_;
+    if (epoll_ctl(tun_epoll_fd_, EPOLL_CTL_ADD, tun_fd_, &tun_event) < 0 ||
+        epoll_ctl(tun_epoll_fd_, EPOLL_CTL_ADD, tun_wake_fd_, &wake_event) < 0)
+        glog.is(DIE) && glog << "Could not add tun interface to epoll instance" << std::endl;
+
+    const int pool_size = cfg_.tun_pool_size();
+    if (pool_size < 1)
+        glog.is(DIE) && glog << "tun_pool_size must be > 0" << std::endl;
+    tun_pool_.resize(pool_size * ip_mtu_);
+    tun_pool_len_.resize(pool_size);
+    tun_free_slots_.reserve(pool_size);
+    for (int i = pool_size - 1; i >= 0; --i) tun_free_slots_.push_back(i);
+    tun_ready_slots_.reserve(pool_size);
+    tun_batch_.reserve(pool_size);
 }
 
-goby::acomms::IPGateway::~IPGateway() { dccl_arithmetic_unload(&dccl_goby_nh_); }
+goby::acomms::IPGateway::~IPGateway()
+{
+    if (tun_thread_)
+    {
+        {
+            boost::mutex::scoped_lock lock(tun_mutex_);
+            tun_quit_ = true;
+        }
+        tun_slot_free_.notify_all();
+        goby::uint64 one = 1;
+        if (write(tun_wake_fd_, &one, sizeof(one)) < 0)
+            glog.is(WARN) && glog << "Could not wake tun reader thread" << std::endl;
+        tun_thread_->join();
+    }
+    if (tun_epoll_fd_ >= 0)
+        close(tun_epoll_fd_);
+    if (tun_wake_fd_ >= 0)
+        close(tun_wake_fd_);
+
+    dccl_arithmetic_unload(&dccl_goby_nh_);
+}
 
 void goby::acomms::IPGateway::loop()
 {
@@ -289,16 +397,19 @@ void goby::acomms::IPGateway::loop()
 
 void goby::acomms::IPGateway::handle_udp_packet(const goby::acomms::protobuf::IPv4Header& ip_hdr,
                                                 const goby::acomms::protobuf::UDPHeader& udp_hdr,
-                                                const std::string& payload)
+                                                const char* payload, int payload_size)
 {
     glog.is(VERBOSE) && glog << "Received UDP Packet. IPv4 Header: " << ip_hdr.DebugString()
-                             << "UDP Header: " << udp_hdr << "Payload (" << payload.size()
-                             << " bytes): " << goby::util::hex_encode(payload) << std::endl;
+                             << "UDP Header: " << udp_hdr << "Payload (" << payload_size
+                             << " bytes): "
+                             << goby::util::hex_encode(std::string(payload, payload_size))
+                             << std::endl;
 
     int src = ipv4_to_goby_address(ip_hdr.source_ip_address());
     int dest = ipv4_to_goby_address(ip_hdr.dest_ip_address());
 
-    goby::acomms::protobuf::NetworkHeader net_header;
+    goby::acomms::protobuf::NetworkHeader& net_header = tun_net_header_;
+    net_header.Clear();
     net_header.set_protocol(goby::acomms::protobuf::NetworkHeader::UDP);
     net_header.set_srcdest_addr(from_src_dest_pair(std::make_pair(src, dest)));
 
@@ -352,20 +463,33 @@ void goby::acomms::IPGateway::handle_udp_packet(const goby::acomms::protobuf::IP
 
     glog.is(VERBOSE) && glog << "NetHeader: " << net_header.DebugString() << std::endl;
 
-    std::string nh;
-    dccl_goby_nh_.encode(&nh, net_header);
+    tun_nh_.clear();
+    dccl_goby_nh_.encode(&tun_nh_, net_header);
 
-    std::map<int, boost::circular_buffer<std::string> >::iterator it = outgoing_.find(dest);
+    std::map<int, OutgoingQueue>::iterator it = outgoing_.find(dest);
     if (it == outgoing_.end())
+        it = outgoing_.insert(std::make_pair(dest, OutgoingQueue(cfg_.queue_size()))).first;
+
+    // build the frame in reused storage
+    boost::circular_buffer<std::string>& packets = it->second.packets;
+    if (packets.full())
     {
-        std::pair<std::map<int, boost::circular_buffer<std::string> >::iterator, bool> itboolpair =
-            outgoing_.insert(
-                std::make_pair(dest, boost::circular_buffer<std::string>(cfg_.queue_size())));
-        it = itboolpair.first;
+        if (spare_frames_.size() < packets.capacity())
+        {
+            spare_frames_.push_back(std::string());
+            spare_frames_.back().swap(packets.front());
+        }
+        packets.pop_front();
     }
-
-    it->second.push_back(nh + payload);
-    icmp_report_queue();
+    packets.push_back(std::string());
+    std::string& frame = packets.back();
+    if (!spare_frames_.empty())
+    {
+        frame.swap(spare_frames_.back());
+        spare_frames_.pop_back();
+    }
+    frame.assign(tun_nh_);
+    frame.append(payload, payload_size);
 }
 
 void goby::acomms::IPGateway::handle_initiate_transmission(const protobuf::ModemTransmission& m)
@@ -373,84 +497,173 @@ void goby::acomms::IPGateway::handle_initiate_transmission(const protobuf::Modem
     publish(m, "Tx" + goby::util::as<std::string>(local_modem_id_));
 }
 
-void goby::acomms::IPGateway::receive_packets()
+void goby::acomms::IPGateway::tun_read_thread()
 {
     while (true)
     {
-        fd_set rd_set;
-        FD_ZERO(&rd_set);
-        FD_SET(tun_fd_, &rd_set);
-
-        timeval tout = {0};
-        int ret = select(tun_fd_ + 1, &rd_set, 0, 0, &tout);
-
-        if (ret < 0 && errno != EINTR)
+        epoll_event events[2];
+        int n = epoll_wait(tun_epoll_fd_, events, 2, -1);
+        if (n < 0 && errno != EINTR)
         {
-            glog.is(WARN) && glog << "Could not select on tun fd." << std::endl;
+            // nothing more will be read, so receive_packets() shuts us down
+            boost::mutex::scoped_lock lock(tun_mutex_);
+            tun_wait_failed_ = true;
             return;
         }
-        else if (ret > 0)
-        {
-            char buffer[ip_mtu_ + 1];
-            int len = read(tun_fd_, buffer, ip_mtu_);
 
-            if (len < 0)
+        // drain everything the tun device has queued
+        while (true)
+        {
+            int slot;
             {
-                glog.is(WARN) && glog << "tun read error." << std::endl;
+                boost::mutex::scoped_lock lock(tun_mutex_);
+                while (tun_free_slots_.empty() && !tun_quit_) tun_slot_free_.wait(lock);
+                if (tun_quit_)
+                    return;
+                slot = tun_free_slots_.back();
+                tun_free_slots_.pop_back();
             }
-            else if (len == 0)
+
+            int len = read(tun_fd_, &tun_pool_[slot * ip_mtu_], ip_mtu_);
+
+            boost::mutex::scoped_lock lock(tun_mutex_);
+            if (len > 0)
             {
-                glog.is(DIE) && glog << "tun reached EOF." << std::endl;
+                tun_pool_len_[slot] = len;
+                tun_ready_slots_.push_back(slot);
             }
             else
             {
-                goby::acomms::protobuf::IPv4Header ip_hdr;
-                unsigned short ip_header_size = (buffer[0] & 0xF) * 4;
-                unsigned short version = ((buffer[0] >> 4) & 0xF);
-                if (version == 4)
+                tun_free_slots_.push_back(slot);
+                if (len == 0)
                 {
-                    std::string header_data(buffer, ip_header_size);
-                    dccl_ip_.decode(header_data, &ip_hdr);
-                    glog.is(DEBUG2) && glog << "Received " << len << " bytes. " << std::endl;
-                    switch (ip_hdr.protocol())
-                    {
-                        default:
-                            glog.is(DEBUG1) && glog << "IPv4 Protocol " << ip_hdr.protocol()
-                                                    << " is not supported." << std::endl;
-                            break;
-                        case IPPROTO_UDP:
-                        {
-                            goby::acomms::protobuf::UDPHeader udp_hdr;
-                            std::string udp_header_data(&buffer[ip_header_size], UDP_HEADER_SIZE);
-                            dccl_udp_.decode(udp_header_data, &udp_hdr);
-                            handle_udp_packet(ip_hdr, udp_hdr,
-                                              std::string(&buffer[ip_header_size + UDP_HEADER_SIZE],
-                                                          ip_hdr.total_length() - ip_header_size -
-                                                              UDP_HEADER_SIZE));
-                            break;
-                        }
-                        case IPPROTO_ICMP:
-                        {
-                            goby::acomms::protobuf::ICMPHeader icmp_hdr;
-                            std::string icmp_header_data(&buffer[ip_header_size], ICMP_HEADER_SIZE);
-                            dccl_icmp_.decode(icmp_header_data, &icmp_hdr);
-                            glog.is(DEBUG1) && glog << "Received ICMP Packet with header: "
-                                                    << icmp_hdr.ShortDebugString() << std::endl;
-                            glog.is(DEBUG1) && glog << "ICMP sending is not supported."
-                                                    << std::endl;
-
-                            break;
-                        }
-                    }
+                    tun_eof_ = true;
+                    return;
                 }
+                else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    ++tun_read_errors_;
+                break;
             }
         }
-        else
+    }
+}
+
+void goby::acomms::IPGateway::receive_packets()
+{
+    {
+        boost::mutex::scoped_lock lock(tun_mutex_);
+        tun_batch_.swap(tun_ready_slots_);
+
+        if (tun_read_errors_)
         {
-            // no select items
-            return;
+            glog.is(WARN) && glog << "tun read error." << std::endl;
+            tun_read_errors_ = 0;
         }
+        if (tun_eof_)
+            glog.is(DIE) && glog << "tun reached EOF." << std::endl;
+        if (tun_wait_failed_)
+            glog.is(DIE) && glog << "Could not wait on tun interface." << std::endl;
     }
+
+    if (tun_batch_.empty())
+        return;
+
+    glog.is(DEBUG2) && glog << "Handling " << tun_batch_.size() << " packets from tun."
+                            << std::endl;
+
+    bool queued = false;
+    for (std::vector<int>::const_iterator it = tun_batch_.begin(), end = tun_batch_.end();
+         it != end; ++it)
+    {
+        try
+        {
+            if (handle_tun_packet(&tun_pool_[*it * ip_mtu_], tun_pool_len_[*it]))
+                queued = true;
+        }
+        catch (std::exception& e)
+        {
+            glog.is(WARN) && glog << "Could not handle packet from tun: " << e.what()
+                                  << std::endl;
+        }
+    }
+
+    {
+        boost::mutex::scoped_lock lock(tun_mutex_);
+        tun_free_slots_.insert(tun_free_slots_.end(), tun_batch_.begin(), tun_batch_.end());
+    }
+    tun_slot_free_.notify_one();
+    tun_batch_.clear();
+
+    if (queued)
+        icmp_report_queue();
+}
+
+bool goby::acomms::IPGateway::handle_tun_packet(const char* buffer, int len)
+{
+    unsigned short ip_header_size = (buffer[0] & 0xF) * 4;
+    unsigned short version = ((buffer[0] >> 4) & 0xF);
+    if (version != 4)
+        return false;
+
+    if (len < ip_header_size || ip_header_size < MIN_IPV4_HEADER_LENGTH * 4)
+    {
+        glog.is(DEBUG1) && glog << "Truncated IPv4 packet." << std::endl;
+        return false;
+    }
+
+    if (net_checksum(buffer, ip_header_size) != 0)
+    {
+        glog.is(DEBUG1) && glog << "Bad IPv4 header checksum." << std::endl;
+        return false;
+    }
+
+    goby::acomms::protobuf::IPv4Header& ip_hdr = tun_ip_hdr_;
+    ip_hdr.Clear();
+    dccl_ip_.decode(buffer, buffer + ip_header_size, &ip_hdr);
+    glog.is(DEBUG2) && glog << "Received " << len << " bytes. " << std::endl;
+
+    if (ip_hdr.total_length() > static_cast<unsigned>(len))
+    {
+        glog.is(DEBUG1) && glog << "Truncated IPv4 packet." << std::endl;
+        return false;
+    }
+
+    switch (ip_hdr.protocol())
+    {
+        default:
+            glog.is(DEBUG1) && glog << "IPv4 Protocol " << ip_hdr.protocol()
+                                    << " is not supported." << std::endl;
+            break;
+        case IPPROTO_UDP:
+        {
+            if (ip_hdr.total_length() < ip_header_size + UDP_HEADER_SIZE)
+                return false;
+
+            goby::acomms::protobuf::UDPHeader& udp_hdr = tun_udp_hdr_;
+            udp_hdr.Clear();
+            dccl_udp_.decode(buffer + ip_header_size, buffer + ip_header_size + UDP_HEADER_SIZE,
+                             &udp_hdr);
+            handle_udp_packet(ip_hdr, udp_hdr, buffer + ip_header_size + UDP_HEADER_SIZE,
+                              ip_hdr.total_length() - ip_header_size - UDP_HEADER_SIZE);
+            return true;
+        }
+        case IPPROTO_ICMP:
+        {
+            if (ip_hdr.total_length() < ip_header_size + ICMP_HEADER_SIZE)
+                return false;
+
+            goby::acomms::protobuf::ICMPHeader& icmp_hdr = tun_icmp_hdr_;
+            icmp_hdr.Clear();
+            dccl_icmp_.decode(buffer + ip_header_size,
+                              buffer + ip_header_size + ICMP_HEADER_SIZE, &icmp_hdr);
+            glog.is(DEBUG1) && glog << "Received ICMP Packet with header: "
+                                    << icmp_hdr.ShortDebugString() << std::endl;
+            glog.is(DEBUG1) && glog << "ICMP sending is not supported." << std::endl;
+
+            break;
+        }
+    }
+    return false;
 }
 
 void goby::acomms::IPGateway::handle_data_request(const protobuf::ModemTransmission& orig_msg)
@@ -460,53 +673,61 @@ void goby::acomms::IPGateway::handle_data_request(const protobuf::ModemTransmiss
 
     protobuf::ModemTransmission msg = orig_msg;
 
-    bool had_data = false;
-    while ((unsigned)msg.frame_size() < msg.max_num_frames())
+    std::map<int, OutgoingQueue>::iterator it = outgoing_.end();
+    if (msg.dest() != goby::acomms::QUERY_DESTINATION_ID)
+    {
+        it = outgoing_.find(msg.dest());
+    }
+    else
     {
-        if (msg.dest() != goby::acomms::QUERY_DESTINATION_ID)
+        // deficit round robin among the destinations with packets queued
+        drr_backlog_.clear();
+        for (std::map<int, OutgoingQueue>::const_iterator q_it = outgoing_.begin(),
+                                                          end = outgoing_.end();
+             q_it != end; ++q_it)
         {
-            std::map<int, boost::circular_buffer<std::string> >::iterator it =
-                outgoing_.find(msg.dest());
-            if (it == outgoing_.end())
-            {
-                break;
-            }
-            else if (it->second.size() == 0)
-            {
-                break;
-            }
-            else
-            {
-                msg.set_ack_requested(false);
-                msg.add_frame(it->second.front());
-                it->second.pop_front();
-                had_data = true;
-            }
+            if (!q_it->second.packets.empty())
+                drr_backlog_.insert(std::make_pair(
+                    q_it->first, DeficitRoundRobin::Backlog(q_it->second.packets.front().size(),
+                                                            drr_quantum(q_it->first))));
         }
-        else
+
+        int dest;
+        if (drr_.choose(drr_backlog_, &dest))
         {
-            // TODO: not fair - prioritizes lower valued destinations
-            for (std::map<int, boost::circular_buffer<std::string> >::iterator
-                     it = outgoing_.begin(),
-                     end = outgoing_.end();
-                 it != end; ++it)
+            it = outgoing_.find(dest);
+            msg.set_dest(dest);
+        }
+    }
+
+    bool had_data = false;
+    if (it != outgoing_.end())
+    {
+        // once chosen, a destination fills the whole transmission, overdrawing its credit
+        // if need be (only one destination per transmission)
+        OutgoingQueue& queue = it->second;
+        while ((unsigned)msg.frame_size() < msg.max_num_frames() && !queue.packets.empty())
+        {
+            std::string& packet = queue.packets.front();
+            msg.set_ack_requested(false);
+            msg.add_frame(packet);
+
+            if (orig_msg.dest() == goby::acomms::QUERY_DESTINATION_ID)
+                drr_.sent(it->first, packet.size());
+            queue.bytes_sent += packet.size();
+            ++queue.packets_sent;
+
+            if (spare_frames_.size() < queue.packets.capacity())
             {
-                if (it->second.size() == 0)
-                {
-                    continue;
-                }
-                else
-                {
-                    msg.set_dest(it->first);
-                    msg.set_ack_requested(false);
-                    msg.add_frame(it->second.front());
-                    it->second.pop_front();
-                    had_data = true;
-                    break;
-                }
+                spare_frames_.push_back(std::string());
+                spare_frames_.back().swap(packet);
             }
-            break;
+            queue.packets.pop_front();
+            had_data = true;
         }
+
+        if (orig_msg.dest() == goby::acomms::QUERY_DESTINATION_ID)
+            drr_.end_turn(it->first, queue.packets.empty() ? 0 : queue.packets.front().size());
     }
 
     publish(msg, "DataResponse" + goby::util::as<std::string>(local_modem_id_));
@@ -665,17 +886,29 @@ void goby::acomms::IPGateway::icmp_report_queue()
 
     int total_messages = 0;
 
-    for (std::map<int, boost::circular_buffer<std::string> >::const_iterator it = outgoing_.begin(),
-                                                                             end = outgoing_.end();
+    for (std::map<int, OutgoingQueue>::const_iterator it = outgoing_.begin(),
+                                                      end = outgoing_.end();
          it != end; ++it)
     {
-        int size = it->second.size();
-        if (size)
+        const OutgoingQueue& queue = it->second;
+        int size = queue.packets.size();
+        if (size || queue.bytes_sent)
         {
             protobuf::IPGatewayICMPControl::QueueReport::SubQueue* q =
                 control_msg.mutable_queue_report()->add_queue();
             q->set_dest(it->first);
             q->set_size(size);
+
+            int bytes = 0;
+            for (boost::circular_buffer<std::string>::const_iterator p_it = queue.packets.begin(),
+                                                                     p_end = queue.packets.end();
+                 p_it != p_end; ++p_it)
+                bytes += p_it->size();
+            q->set_bytes(bytes);
+            q->set_bytes_sent(queue.bytes_sent);
+            q->set_packets_sent(queue.packets_sent);
+            q->set_deficit(drr_.deficit(it->first));
+
             total_messages += size;
         }
     }
@@ -852,6 +1085,17 @@ int goby::acomms::IPGateway::ac_freq(int srcdest)
         return scale_factor * p2 * (cfg_.gamma_collaboration());
 }
 
+int goby::acomms::IPGateway::drr_quantum(int dest)
+{
+    double quantum = cfg_.has_drr_quantum() ? cfg_.drr_quantum() : cfg_.mtu();
+    for (int i = 0, n = cfg_.destination_weight_size(); i < n; ++i)
+    {
+        if (cfg_.destination_weight(i).dest() == dest)
+            quantum *= cfg_.destination_weight(i).weight();
+    }
+    return std::max(1, static_cast<int>(quantum));
+}
+
 int main(int argc, char* argv[])
 {
     dccl::FieldCodecManager::add<goby::acomms::IPGatewayEmptyIdentifierCodec<0xF000> >(
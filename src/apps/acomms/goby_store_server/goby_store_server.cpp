@@ -45,14 +45,24 @@ class GobyStoreServer : public goby::common::ZeroMQApplicationBase,
     GobyStoreServer(protobuf::GobyStoreServerConfig* cfg);
     ~GobyStoreServer()
     {
+        // finalizing a null statement is a harmless no-op
+        sqlite3_finalize(insert_);
+        sqlite3_finalize(select_);
+        sqlite3_finalize(begin_);
+        sqlite3_finalize(commit_);
+        sqlite3_finalize(rollback_);
         if (db_)
             sqlite3_close(db_);
     }
 
   private:
     void handle_request(const protobuf::StoreServerRequest& request);
+    void insert_outbox(const protobuf::StoreServerRequest& request);
     void loop();
 
+    void exec(const std::string& sql);
+    sqlite3_stmt* prepare(const std::string& sql);
+    void step(sqlite3_stmt* stmt, const std::string& error_prefix);
     void check(int rc, const std::string& error_prefix);
 
   private:
@@ -60,6 +70,16 @@ class GobyStoreServer : public goby::common::ZeroMQApplicationBase,
     protobuf::GobyStoreServerConfig& cfg_;
     sqlite3* db_;
 
+    // prepared once and reset after each use
+    sqlite3_stmt* insert_;
+    sqlite3_stmt* select_;
+    sqlite3_stmt* begin_;
+    sqlite3_stmt* commit_;
+    sqlite3_stmt* rollback_;
+
+    // reused for serializing outbox rows
+    std::string bytes_;
+
     // maps modem_id to time (microsecs since UNIX)
     std::map<int, uint64> last_request_time_;
 };
@@ -76,7 +96,7 @@ int main(int argc, char* argv[])
 
 goby::acomms::GobyStoreServer::GobyStoreServer(protobuf::GobyStoreServerConfig* cfg)
     : ZeroMQApplicationBase(&zeromq_service_, cfg), StaticProtobufNode(&zeromq_service_),
-      cfg_(*cfg), db_(0)
+      cfg_(*cfg), db_(0), insert_(0), select_(0), begin_(0), commit_(0), rollback_(0)
 {
     // create database
     if (!boost::filesystem::exists(cfg_.db_file_dir()))
@@ -93,20 +113,27 @@ goby::acomms::GobyStoreServer::GobyStoreServer(protobuf::GobyStoreServerConfig*
     if (rc)
         throw(goby::Exception("Can't open database: " + std::string(sqlite3_errmsg(db_))));
 
+    // write-ahead logging lets each request commit with a single append to the log, and with
+    // synchronous=NORMAL the log is only synced at checkpoints (a power loss may roll back the
+    // most recent requests, but never corrupts the database)
+    exec("PRAGMA journal_mode=WAL;");
+    exec("PRAGMA synchronous=NORMAL;");
+
     // initial tables
-    char* errmsg;
-    rc = sqlite3_exec(db_,
-                      "CREATE TABLE IF NOT EXISTS ModemTransmission (id INTEGER PRIMARY KEY ASC "
-                      "AUTOINCREMENT, src INTEGER, dest INTEGER, microtime INTEGER, bytes BLOB);",
-                      0, 0, &errmsg);
+    exec("CREATE TABLE IF NOT EXISTS ModemTransmission (id INTEGER PRIMARY KEY ASC "
+         "AUTOINCREMENT, src INTEGER, dest INTEGER, microtime INTEGER, bytes BLOB);");
 
-    if (rc != SQLITE_OK)
-    {
-        std::string error(errmsg);
-        sqlite3_free(errmsg);
+    // every select is a range on microtime
+    exec("CREATE INDEX IF NOT EXISTS ModemTransmissionMicrotime ON ModemTransmission "
+         "(microtime, src);");
 
-        throw(goby::Exception("SQL error: " + error));
-    }
+    insert_ =
+        prepare("INSERT INTO ModemTransmission (src, dest, microtime, bytes) VALUES (?, ?, ?, ?);");
+    select_ = prepare("SELECT bytes FROM ModemTransmission WHERE src != ?1 AND (microtime > ?2 "
+                      "AND microtime <= ?3 );");
+    begin_ = prepare("BEGIN;");
+    commit_ = prepare("COMMIT;");
+    rollback_ = prepare("ROLLBACK;");
 
     // set up receiving requests
     on_receipt<protobuf::StoreServerRequest>(cfg_.reply_socket().socket_id(),
@@ -115,6 +142,8 @@ goby::acomms::GobyStoreServer::GobyStoreServer(protobuf::GobyStoreServerConfig*
     // start zeromqservice
     common::protobuf::ZeroMQServiceConfig service_cfg;
     service_cfg.add_socket()->CopyFrom(cfg_.reply_socket());
+    if (cfg_.has_notify_socket())
+        service_cfg.add_socket()->CopyFrom(cfg_.notify_socket());
     zeromq_service_.set_cfg(service_cfg);
 }
 
@@ -130,38 +159,8 @@ void goby::acomms::GobyStoreServer::handle_request(const protobuf::StoreServerRe
     response.set_modem_id(request.modem_id());
 
     // insert any rows into the table
-    for (int i = 0, n = request.outbox_size(); i < n; ++i)
-    {
-        glog.is(DEBUG1) && glog << "Trying to insert (size: " << request.outbox(i).ByteSize()
-                                << "): " << request.outbox(i).DebugString() << std::endl;
-
-        sqlite3_stmt* insert;
-
-        check(
-            sqlite3_prepare(
-                db_,
-                "INSERT INTO ModemTransmission (src, dest, microtime, bytes) VALUES (?, ?, ?, ?);",
-                -1, &insert, 0),
-            "Insert statement preparation failed");
-        check(sqlite3_bind_int(insert, 1, request.outbox(i).src()), "Insert `src` binding failed");
-        check(sqlite3_bind_int(insert, 2, request.outbox(i).dest()),
-              "Insert `dest` binding failed");
-        check(sqlite3_bind_int64(insert, 3, goby_time<uint64>()),
-              "Insert `microtime` binding failed");
-
-        std::string bytes;
-        request.outbox(i).SerializeToString(&bytes);
-
-        //        glog.is(DEBUG1) && glog << "Bytes (hex): " << goby::util::hex_encode(bytes) << std::endl;
-
-        check(sqlite3_bind_blob(insert, 4, bytes.data(), bytes.size(), SQLITE_STATIC),
-              "Insert `bytes` binding failed");
-
-        check(sqlite3_step(insert), "Insert step failed");
-        check(sqlite3_finalize(insert), "Insert statement finalize failed");
-
-        glog.is(DEBUG1) && glog << "Insert successful." << std::endl;
-    }
+    if (request.outbox_size())
+        insert_outbox(request);
 
     // find any rows to respond with
     glog.is(DEBUG1) && glog << "Trying to select for dest: " << request.modem_id() << std::endl;
@@ -169,52 +168,108 @@ void goby::acomms::GobyStoreServer::handle_request(const protobuf::StoreServerRe
     if (!last_request_time_.count(request.modem_id()))
         last_request_time_.insert(std::make_pair(request.modem_id(), 0));
 
-    sqlite3_stmt* select;
-    check(sqlite3_prepare(db_,
-                          "SELECT bytes FROM ModemTransmission WHERE src != ?1 AND (microtime > ?2 "
-                          "AND microtime <= ?3 );",
-                          -1, &select, 0),
-          "Select statement preparation failed");
-
-    check(sqlite3_bind_int(select, 1, request.modem_id()),
+    check(sqlite3_bind_int(select_, 1, request.modem_id()),
           "Select request modem_id binding failed");
-    check(sqlite3_bind_int64(select, 2, last_request_time_[request.modem_id()]),
+    check(sqlite3_bind_int64(select_, 2, last_request_time_[request.modem_id()]),
           "Select `microtime` last time binding failed");
-    check(sqlite3_bind_int64(select, 3, request_time),
+    check(sqlite3_bind_int64(select_, 3, request_time),
           "Select `microtime` this time binding failed");
 
-    int rc = sqlite3_step(select);
+    int rc = sqlite3_step(select_);
     while (rc == SQLITE_ROW)
     {
-        switch (rc)
+        const void* bytes = sqlite3_column_blob(select_, 0);
+        int num_bytes = sqlite3_column_bytes(select_, 0);
+
+        response.add_inbox()->ParseFromArray(bytes, num_bytes);
+        glog.is(DEBUG1) && glog << "Got message for inbox (size: " << num_bytes << "): "
+                                << response.inbox(response.inbox_size() - 1).DebugString()
+                                << std::endl;
+        rc = sqlite3_step(select_);
+    }
+    sqlite3_reset(select_);
+    check(rc, "Select step failed");
+
+    glog.is(DEBUG1) && glog << "Select successful." << std::endl;
+
+    last_request_time_[request.modem_id()] = request_time;
+
+    send(response, cfg_.reply_socket().socket_id());
+
+    // rows are committed, so any request following this notification will find them
+    if (request.outbox_size() && cfg_.has_notify_socket())
+    {
+        protobuf::StoreServerNotification notification;
+        notification.set_modem_id(request.modem_id());
+        notification.set_num_rows(request.outbox_size());
+        send(notification, cfg_.notify_socket().socket_id());
+    }
+}
+
+void goby::acomms::GobyStoreServer::insert_outbox(const protobuf::StoreServerRequest& request)
+{
+    // one transaction (and so one commit to the log) for the whole outbox
+    step(begin_, "Begin transaction failed");
+    try
+    {
+        for (int i = 0, n = request.outbox_size(); i < n; ++i)
         {
-            case SQLITE_ROW:
-            {
-                const unsigned char* bytes = sqlite3_column_text(select, 0);
-                int num_bytes = sqlite3_column_bytes(select, 0);
+            glog.is(DEBUG1) && glog << "Trying to insert (size: " << request.outbox(i).ByteSize()
+                                    << "): " << request.outbox(i).DebugString() << std::endl;
 
-                // std::string byte_string(reinterpret_cast<const char*>(bytes), num_bytes);
+            check(sqlite3_bind_int(insert_, 1, request.outbox(i).src()),
+                  "Insert `src` binding failed");
+            check(sqlite3_bind_int(insert_, 2, request.outbox(i).dest()),
+                  "Insert `dest` binding failed");
+            check(sqlite3_bind_int64(insert_, 3, goby_time<uint64>()),
+                  "Insert `microtime` binding failed");
 
-                // glog.is(DEBUG1) && glog << "Bytes (hex): " << goby::util::hex_encode(byte_string) << std::endl;
+            request.outbox(i).SerializeToString(&bytes_);
+            check(sqlite3_bind_blob(insert_, 4, bytes_.data(), bytes_.size(), SQLITE_STATIC),
+                  "Insert `bytes` binding failed");
 
-                response.add_inbox()->ParseFromArray(bytes, num_bytes);
-                glog.is(DEBUG1) && glog << "Got message for inbox (size: " << num_bytes << "): "
-                                        << response.inbox(response.inbox_size() - 1).DebugString()
-                                        << std::endl;
-                rc = sqlite3_step(select);
-            }
-            break;
+            step(insert_, "Insert step failed");
 
-            default: check(rc, "Select step failed"); break;
+            glog.is(DEBUG1) && glog << "Insert successful." << std::endl;
         }
+        step(commit_, "Commit transaction failed");
     }
+    catch (goby::Exception& e)
+    {
+        sqlite3_step(rollback_);
+        sqlite3_reset(rollback_);
+        throw;
+    }
+}
 
-    check(sqlite3_finalize(select), "Select statement finalize failed");
-    glog.is(DEBUG1) && glog << "Select successful." << std::endl;
+void goby::acomms::GobyStoreServer::exec(const std::string& sql)
+{
+    char* errmsg;
+    int rc = sqlite3_exec(db_, sql.c_str(), 0, 0, &errmsg);
 
-    last_request_time_[request.modem_id()] = request_time;
+    if (rc != SQLITE_OK)
+    {
+        std::string error(errmsg);
+        sqlite3_free(errmsg);
 
-    send(response, cfg_.reply_socket().socket_id());
+        throw(goby::Exception("SQL error: " + error));
+    }
+}
+
+sqlite3_stmt* goby::acomms::GobyStoreServer::prepare(const std::string& sql)
+{
+    sqlite3_stmt* stmt;
+    check(sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, 0),
+          "Statement preparation failed for \"" + sql + "\"");
+    return stmt;
+}
+
+void goby::acomms::GobyStoreServer::step(sqlite3_stmt* stmt, const std::string& error_prefix)
+{
+    int rc = sqlite3_step(stmt);
+    // reset so the statement can be rerun, leaving any error in the connection for check()
+    sqlite3_reset(stmt);
+    check(rc, error_prefix);
 }
 
 void goby::acomms::GobyStoreServer::check(int rc, const std::string& error_prefix)
@@ -22,8 +22,10 @@
 #include <cstdlib>
 #include <dlfcn.h>
 #include <iostream>
+#include <sys/resource.h>
 
 #include "goby/common/logger.h"
+#include "goby/common/time.h"
 
 #include "hdf5.h"
 
@@ -58,7 +60,8 @@ int main(int argc, char* argv[])
     return goby::run<goby::common::hdf5::Writer>(argc, argv, &cfg);
 }
 
-void goby::common::hdf5::Channel::add_message(const goby::common::HDF5ProtobufEntry& entry)
+goby::common::hdf5::MessageCollection&
+goby::common::hdf5::Channel::add_message(const goby::common::HDF5ProtobufEntry& entry)
 {
     const std::string& msg_name = entry.msg->GetDescriptor()->full_name();
     typedef std::map<std::string, MessageCollection>::iterator It;
@@ -70,6 +73,7 @@ void goby::common::hdf5::Channel::add_message(const goby::common::HDF5ProtobufEn
         it = itpair.first;
     }
     it->second.entries.insert(std::make_pair(entry.time, entry.msg));
+    return it->second;
 }
 
 H5::Group& goby::common::hdf5::GroupFactory::fetch_group(const std::string& group_path)
@@ -105,11 +109,33 @@ goby::common::hdf5::GroupFactory::GroupWrapper::fetch_group(std::deque<std::stri
 
 goby::common::hdf5::Writer::Writer(goby::common::protobuf::HDF5Config* cfg)
     : ApplicationBase(cfg), cfg_(*cfg), h5file_(cfg_.output_file(), H5F_ACC_TRUNC),
-      group_factory_(h5file_)
+      group_factory_(h5file_), num_workers_(cfg_.threads()), workers_run_(true), rows_written_(0),
+      start_time_(goby_time())
 {
+    if (cfg_.streaming() && cfg_.chunk_size() == 0)
+        glog.is(DIE) && glog << "chunk_size must be greater than zero" << std::endl;
+
+    if (cfg_.compression_level() > 9)
+        glog.is(DIE) && glog << "compression_level must be 0 (none) to 9" << std::endl;
+    if (cfg_.compression_level() > 0 && !H5Zfilter_avail(H5Z_FILTER_DEFLATE))
+        glog.is(DIE) && glog << "compression_level is set, but this HDF5 library does not "
+                                "support deflate compression"
+                             << std::endl;
+
+    if (num_workers_ == 0)
+        num_workers_ = std::max(boost::thread::hardware_concurrency(), 1u);
+
+    // with one thread, messages are flattened in the main thread between writes
+    if (num_workers_ > 1)
+    {
+        for (unsigned i = 0; i < num_workers_; ++i)
+            workers_.create_thread(boost::bind(&Writer::worker_run, this));
+    }
+
     load();
     collect();
     write();
+    write_stats();
     quit();
 }
 
@@ -148,183 +174,332 @@ void goby::common::hdf5::Writer::collect()
             it = itpair.first;
         }
 
-        it->second.add_message(entry);
+        goby::common::hdf5::MessageCollection& message_collection = it->second.add_message(entry);
         entry.clear();
+
+        // write out full chunks as we go so that memory use doesn't grow with the log length
+        if (cfg_.streaming() && message_collection.entries.size() >= cfg_.chunk_size())
+            submit("/" + it->first + "/" + message_collection.name, message_collection);
     }
 }
 
 void goby::common::hdf5::Writer::write()
 {
-    for (std::map<std::string, goby::common::hdf5::Channel>::const_iterator it = channels_.begin(),
-                                                                            end = channels_.end();
+    for (std::map<std::string, goby::common::hdf5::Channel>::iterator it = channels_.begin(),
+                                                                      end = channels_.end();
          it != end; ++it)
         write_channel("/" + it->first, it->second);
+
+    while (!pending_jobs_.empty()) write_next_job();
+
+    {
+        boost::mutex::scoped_lock lock(jobs_mutex_);
+        workers_run_ = false;
+    }
+    job_queued_.notify_all();
+    workers_.join_all();
 }
 
 void goby::common::hdf5::Writer::write_channel(const std::string& group,
-                                               const goby::common::hdf5::Channel& channel)
+                                               goby::common::hdf5::Channel& channel)
 {
-    for (std::map<std::string, goby::common::hdf5::MessageCollection>::const_iterator
+    for (std::map<std::string, goby::common::hdf5::MessageCollection>::iterator
              it = channel.entries.begin(),
              end = channel.entries.end();
          it != end; ++it)
-        write_message_collection(group + "/" + it->first, it->second);
+    {
+        // may be empty in streaming mode if the last chunk was just written
+        if (!it->second.entries.empty())
+            submit(group + "/" + it->first, it->second);
+    }
+}
+
+void goby::common::hdf5::Writer::write_stats()
+{
+    double elapsed = (goby_time() - start_time_).total_microseconds() / 1.0e6;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    glog.is(VERBOSE) && glog << "Wrote " << rows_written_ << " rows in " << elapsed << " s ("
+                             << (elapsed > 0 ? rows_written_ / elapsed : 0)
+                             << " rows/s) using " << num_workers_
+                             << " thread(s), peak RSS: " << usage.ru_maxrss << " kB" << std::endl;
+}
+
+void goby::common::hdf5::Writer::submit(
+    const std::string& group, goby::common::hdf5::MessageCollection& message_collection)
+{
+    boost::shared_ptr<ConversionJob> job(new ConversionJob(group, message_collection.name));
+    job->message_collection.entries.swap(message_collection.entries);
+    job->plan = message_plan(job->message_collection.entries.begin()->second->GetDescriptor());
+
+    if (num_workers_ <= 1)
+    {
+        flatten(*job);
+        write_job(*job);
+        return;
+    }
+
+    pending_jobs_.push_back(job);
+    {
+        boost::mutex::scoped_lock lock(jobs_mutex_);
+        queued_jobs_.push_back(job);
+    }
+    job_queued_.notify_one();
+
+    // bound the memory held by jobs that are flattened but not yet written
+    while (pending_jobs_.size() > 2 * num_workers_) write_next_job();
+}
+
+void goby::common::hdf5::Writer::write_next_job()
+{
+    // jobs are written in the order they were submitted, so that streaming chunks are appended
+    // in order and the file layout doesn't depend on the thread scheduling
+    boost::shared_ptr<ConversionJob> job = pending_jobs_.front();
+    pending_jobs_.pop_front();
+    {
+        boost::mutex::scoped_lock lock(jobs_mutex_);
+        while (!job->done) job_done_.wait(lock);
+    }
+    write_job(*job);
+}
+
+void goby::common::hdf5::Writer::write_job(ConversionJob& job)
+{
+    if (!job.error.empty())
+        glog.is(DIE) && glog << "Failed to convert " << job.group << ": " << job.error
+                             << std::endl;
+
+    // the H5 library is not thread safe, so all writes happen here in the main thread
+    for (std::vector<boost::shared_ptr<Column> >::iterator it = job.columns.begin(),
+                                                           end = job.columns.end();
+         it != end; ++it)
+        (*it)->write(*this);
+
+    rows_written_ += job.message_collection.entries.size();
+}
+
+void goby::common::hdf5::Writer::worker_run()
+{
+    for (;;)
+    {
+        boost::shared_ptr<ConversionJob> job;
+        {
+            boost::mutex::scoped_lock lock(jobs_mutex_);
+            while (queued_jobs_.empty() && workers_run_) job_queued_.wait(lock);
+            if (queued_jobs_.empty())
+                return;
+            job = queued_jobs_.front();
+            queued_jobs_.pop_front();
+        }
+
+        try
+        {
+            flatten(*job);
+        }
+        catch (std::exception& e)
+        {
+            job->error = e.what();
+        }
+
+        {
+            boost::mutex::scoped_lock lock(jobs_mutex_);
+            job->done = true;
+        }
+        job_done_.notify_all();
+    }
+}
+
+void goby::common::hdf5::Writer::flatten(ConversionJob& job) const
+{
+    const goby::common::hdf5::MessageCollection& message_collection = job.message_collection;
+    flatten_time(job.group, message_collection, job.columns);
+
+    std::vector<const google::protobuf::Message*> messages;
+    messages.reserve(message_collection.entries.size());
+    for (std::multimap<goby::uint64, boost::shared_ptr<google::protobuf::Message> >::const_iterator
+             it = message_collection.entries.begin(),
+             end = message_collection.entries.end();
+         it != end; ++it)
+        messages.push_back(it->second.get());
+
+    for (std::vector<FieldPlan>::const_iterator it = job.plan->fields.begin(),
+                                                end = job.plan->fields.end();
+         it != end; ++it)
+    {
+        std::vector<hsize_t> hs;
+        hs.push_back(messages.size());
+        it->flatten(*it, job.group, messages, hs, job.columns);
+    }
 }
 
-void goby::common::hdf5::Writer::write_message_collection(
-    const std::string& group, const goby::common::hdf5::MessageCollection& message_collection)
+boost::shared_ptr<const goby::common::hdf5::MessagePlan>
+goby::common::hdf5::Writer::message_plan(const google::protobuf::Descriptor* desc)
 {
-    write_time(group, message_collection);
+    typedef std::map<const google::protobuf::Descriptor*,
+                     boost::shared_ptr<const MessagePlan> >::iterator It;
+    It it = plans_.find(desc);
+    if (it == plans_.end())
+    {
+        boost::shared_ptr<MessagePlan> plan(new MessagePlan);
+        compile_plan(desc, &plan->fields);
+        it = plans_.insert(std::make_pair(desc, plan)).first;
+    }
+    return it->second;
+}
 
-    const google::protobuf::Descriptor* desc =
-        message_collection.entries.begin()->second->GetDescriptor();
+void goby::common::hdf5::Writer::compile_plan(const google::protobuf::Descriptor* desc,
+                                              std::vector<FieldPlan>* fields) const
+{
     for (int i = 0, n = desc->field_count(); i < n; ++i)
     {
         const google::protobuf::FieldDescriptor* field_desc = desc->field(i);
+        switch (field_desc->cpp_type())
+        {
+            case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+            {
+                FieldPlan plan(field_desc, &flatten_embedded_message);
+                plan.sub_group = "/" + field_desc->name();
+                compile_plan(field_desc->message_type(), &plan.children);
+                fields->push_back(plan);
+                break;
+            }
 
-        std::vector<const google::protobuf::Message*> messages;
-        for (std::multimap<goby::uint64,
-                           boost::shared_ptr<google::protobuf::Message> >::const_iterator
-                 it = message_collection.entries.begin(),
-                 end = message_collection.entries.end();
-             it != end; ++it)
-        { messages.push_back(it->second.get()); } std::vector<hsize_t> hs;
-        hs.push_back(messages.size());
-        write_field_selector(group, field_desc, messages, hs);
+            case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+            {
+                // google uses int for the enum value type, we'll assume that's an int32 here
+                FieldPlan plan(field_desc, &flatten_field<goby::int32>);
+                plan.is_enum = true;
+                fields->push_back(plan);
+                break;
+            }
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<goby::int32>));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<goby::int64>));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<goby::uint32>));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<goby::uint64>));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<unsigned char>));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+                if (cfg_.include_string_fields())
+                    fields->push_back(FieldPlan(field_desc, &flatten_field<std::string>));
+                else
+                    fields->push_back(FieldPlan(field_desc, &flatten_omitted_field));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<float>));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+                fields->push_back(FieldPlan(field_desc, &flatten_field<double>));
+                break;
+        }
     }
 }
 
-void goby::common::hdf5::Writer::write_embedded_message(
-    const std::string& group, const google::protobuf::FieldDescriptor* field_desc,
-    const std::vector<const google::protobuf::Message*> messages, std::vector<hsize_t>& hs)
+void goby::common::hdf5::flatten_embedded_message(
+    const FieldPlan& plan, const std::string& group,
+    const std::vector<const google::protobuf::Message*>& messages, std::vector<hsize_t>& hs,
+    std::vector<boost::shared_ptr<Column> >& columns)
 {
-    const google::protobuf::Descriptor* sub_desc = field_desc->message_type();
+    const google::protobuf::FieldDescriptor* field_desc = plan.field_desc;
+    const google::protobuf::Reflection* refl = collection_reflection(messages);
+    const unsigned n = messages.size();
+
+    // gathered once and shared by all the child columns
+    std::vector<const google::protobuf::Message*> sub_messages;
     if (field_desc->is_repeated())
     {
+        std::vector<int> field_sizes(n, 0);
         int max_field_size = 0;
-        for (unsigned i = 0, n = messages.size(); i < n; ++i)
+        for (unsigned i = 0; i < n; ++i)
         {
             if (messages[i])
             {
-                const google::protobuf::Reflection* refl = messages[i]->GetReflection();
-                int field_size = refl->FieldSize(*messages[i], field_desc);
-                if (field_size > max_field_size)
-                    max_field_size = field_size;
+                field_sizes[i] = refl->FieldSize(*messages[i], field_desc);
+                if (field_sizes[i] > max_field_size)
+                    max_field_size = field_sizes[i];
             }
         }
 
         hs.push_back(max_field_size);
 
-        for (int i = 0, n = sub_desc->field_count(); i < n; ++i)
+        sub_messages.resize(n * max_field_size, 0);
+        for (unsigned i = 0; i < n; ++i)
         {
-            const google::protobuf::FieldDescriptor* sub_field_desc = sub_desc->field(i);
-
-            std::vector<const google::protobuf::Message*> sub_messages(
-                messages.size() * max_field_size, (const google::protobuf::Message*)0);
-
-            for (unsigned i = 0, n = messages.size(); i < n; ++i)
-            {
-                if (messages[i])
-                {
-                    const google::protobuf::Reflection* refl = messages[i]->GetReflection();
-                    int field_size = refl->FieldSize(*messages[i], field_desc);
-
-                    for (int j = 0; j < field_size; ++j)
-                    {
-                        const google::protobuf::Message& sub_msg =
-                            refl->GetRepeatedMessage(*messages[i], field_desc, j);
-                        sub_messages[i * max_field_size + j] = &sub_msg;
-                    }
-                }
-            }
-            write_field_selector(group + "/" + field_desc->name(), sub_field_desc, sub_messages,
-                                 hs);
+            for (int j = 0; j < field_sizes[i]; ++j)
+                sub_messages[i * max_field_size + j] =
+                    &refl->GetRepeatedMessage(*messages[i], field_desc, j);
         }
-        hs.pop_back();
     }
     else
     {
-        for (int i = 0, n = sub_desc->field_count(); i < n; ++i)
+        sub_messages.resize(n, 0);
+        for (unsigned i = 0; i < n; ++i)
         {
-            const google::protobuf::FieldDescriptor* sub_field_desc = sub_desc->field(i);
-            std::vector<const google::protobuf::Message*> sub_messages;
-            for (std::vector<const google::protobuf::Message*>::const_iterator
-                     it = messages.begin(),
-                     end = messages.end();
-                 it != end; ++it)
-            {
-                if (*it)
-                {
-                    const google::protobuf::Reflection* refl = (*it)->GetReflection();
-                    const google::protobuf::Message& sub_msg = refl->GetMessage(**it, field_desc);
-                    sub_messages.push_back(&sub_msg);
-                }
-                else
-                {
-                    sub_messages.push_back(0);
-                }
-            }
-            write_field_selector(group + "/" + field_desc->name(), sub_field_desc, sub_messages,
-                                 hs);
+            if (messages[i])
+                sub_messages[i] = &refl->GetMessage(*messages[i], field_desc);
         }
     }
+
+    const std::string sub_group = group + plan.sub_group;
+    for (std::vector<FieldPlan>::const_iterator it = plan.children.begin(),
+                                                end = plan.children.end();
+         it != end; ++it)
+        it->flatten(*it, sub_group, sub_messages, hs, columns);
+
+    if (field_desc->is_repeated())
+        hs.pop_back();
+}
+
+void goby::common::hdf5::flatten_omitted_field(
+    const FieldPlan& plan, const std::string& group,
+    const std::vector<const google::protobuf::Message*>& messages, std::vector<hsize_t>& hs,
+    std::vector<boost::shared_ptr<Column> >& columns)
+{
+    boost::shared_ptr<TypedColumn<unsigned char> > column(new TypedColumn<unsigned char>(
+        group, plan.field_desc->name(), std::vector<hsize_t>(1, 0)));
+    column->default_value = 0;
+    columns.push_back(column);
 }
 
-void goby::common::hdf5::Writer::write_field_selector(
-    const std::string& group, const google::protobuf::FieldDescriptor* field_desc,
-    const std::vector<const google::protobuf::Message*>& messages, std::vector<hsize_t>& hs)
+H5::DSetCreatPropList
+goby::common::hdf5::Writer::dataset_properties(const H5::DataType& datatype,
+                                               const std::vector<hsize_t>& chunk_hs,
+                                               const void* fill_value) const
 {
-    switch (field_desc->cpp_type())
+    H5::DSetCreatPropList props;
+    if (!chunk_hs.empty())
     {
-        case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
-            write_embedded_message(group, field_desc, messages, hs);
-            break;
+        props.setChunk(chunk_hs.size(), chunk_hs.data());
 
-        case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+        // filters are only applied to fixed size (numeric) types
+        if (cfg_.compression_level() > 0 && datatype.getClass() != H5T_STRING)
         {
-            // google uses int for the enum value type, we'll assume that's an int32 here
-            write_field<goby::int32>(group, field_desc, messages, hs);
-            write_enum_attributes(group, field_desc);
-            break;
+            if (cfg_.shuffle())
+                props.setShuffle();
+            props.setDeflate(cfg_.compression_level());
         }
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
-            write_field<goby::int32>(group, field_desc, messages, hs);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
-            write_field<goby::int64>(group, field_desc, messages, hs);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
-            write_field<goby::uint32>(group, field_desc, messages, hs);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
-            write_field<goby::uint64>(group, field_desc, messages, hs);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
-            write_field<unsigned char>(group, field_desc, messages, hs);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
-            if (cfg_.include_string_fields())
-                write_field<std::string>(group, field_desc, messages, hs);
-            else
-                // placeholder for users to know that the field exists, even if the data are omitted
-                write_vector(group, field_desc->name(), std::vector<unsigned char>(),
-                             std::vector<hsize_t>(1, 0), (unsigned char)0);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
-            write_field<float>(group, field_desc, messages, hs);
-            break;
-
-        case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
-            write_field<double>(group, field_desc, messages, hs);
-            break;
     }
+    if (fill_value)
+        props.setFillValue(datatype, fill_value);
+    return props;
 }
 
 void goby::common::hdf5::Writer::write_enum_attributes(
@@ -334,6 +509,10 @@ void goby::common::hdf5::Writer::write_enum_attributes(
     H5::Group& grp = group_factory_.fetch_group(group);
     H5::DataSet ds = grp.openDataSet(field_desc->name());
 
+    // already written with an earlier chunk
+    if (H5Aexists(ds.getId(), "enum_names") > 0)
+        return;
+
     const google::protobuf::EnumDescriptor* enum_desc = field_desc->enum_type();
 
     std::vector<const char*> names(enum_desc->value_count(), (const char*)(0));
@@ -363,11 +542,24 @@ void goby::common::hdf5::Writer::write_enum_attributes(
     }
 }
 
-void goby::common::hdf5::Writer::write_time(
-    const std::string& group, const goby::common::hdf5::MessageCollection& message_collection)
+void goby::common::hdf5::Writer::flatten_time(
+    const std::string& group, const goby::common::hdf5::MessageCollection& message_collection,
+    std::vector<boost::shared_ptr<Column> >& columns) const
 {
-    std::vector<goby::uint64> utime(message_collection.entries.size(), 0);
-    std::vector<double> datenum(message_collection.entries.size(), 0);
+    std::vector<hsize_t> hs;
+    hs.push_back(message_collection.entries.size());
+
+    boost::shared_ptr<TypedColumn<goby::uint64> > utime_column(
+        new TypedColumn<goby::uint64>(group, "_utime_", hs));
+    boost::shared_ptr<TypedColumn<double> > datenum_column(
+        new TypedColumn<double>(group, "_datenum_", hs));
+    utime_column->default_value = 0;
+    datenum_column->default_value = 0;
+
+    std::vector<goby::uint64>& utime = utime_column->data;
+    std::vector<double>& datenum = datenum_column->data;
+    utime.resize(message_collection.entries.size(), 0);
+    datenum.resize(message_collection.entries.size(), 0);
     int i = 0;
     for (std::multimap<goby::uint64, boost::shared_ptr<google::protobuf::Message> >::const_iterator
              it = message_collection.entries.begin(),
@@ -385,10 +577,8 @@ void goby::common::hdf5::Writer::write_time(
         ++i;
     }
 
-    std::vector<hsize_t> hs;
-    hs.push_back(message_collection.entries.size());
-    write_vector(group, "_utime_", utime, hs, (goby::uint64)0);
-    write_vector(group, "_datenum_", datenum, hs, (double)0);
+    columns.push_back(utime_column);
+    columns.push_back(datenum_column);
 }
 
 void goby::common::hdf5::Writer::write_vector(const std::string& group,
@@ -400,13 +590,27 @@ void goby::common::hdf5::Writer::write_vector(const std::string& group,
     std::vector<const char*> data_c_str;
     for (unsigned i = 0, n = data.size(); i < n; ++i) data_c_str.push_back(data[i].c_str());
 
-    H5::DataSpace dataspace(hs.size(), hs.data(), hs.data());
     H5::StrType datatype(H5::PredType::C_S1, H5T_VARIABLE);
-    H5::Group& grp = group_factory_.fetch_group(group);
-    H5::DataSet dataset = grp.createDataSet(dataset_name, datatype, dataspace);
+    H5::DataSet dataset;
+    std::vector<hsize_t> offset(hs.size(), 0);
+    bool created = true;
+    if (cfg_.streaming())
+    {
+        // the default fill value for variable length strings is empty
+        dataset = extend_dataset(group, dataset_name, datatype, hs, 0, &offset, &created);
+    }
+    else
+    {
+        H5::DataSpace dataspace(hs.size(), hs.data(), hs.data());
+        H5::Group& grp = group_factory_.fetch_group(group);
+        dataset = grp.createDataSet(dataset_name, datatype, dataspace);
+    }
 
     if (data_c_str.size())
-        dataset.write(data_c_str.data(), datatype);
+        write_data(dataset, data_c_str.data(), datatype, hs, offset);
+
+    if (!created)
+        return;
 
     const int rank = 1;
     hsize_t att_hs[] = {1};
@@ -416,3 +620,43 @@ void goby::common::hdf5::Writer::write_vector(const std::string& group,
     const H5std_string strbuf(default_value);
     att.write(att_datatype, strbuf);
 }
+
+H5::DataSet goby::common::hdf5::Writer::extend_dataset(
+    const std::string& group, const std::string& dataset_name, const H5::DataType& datatype,
+    const std::vector<hsize_t>& hs, const void* fill_value, std::vector<hsize_t>* offset,
+    bool* created)
+{
+    H5::Group& grp = group_factory_.fetch_group(group);
+    offset->assign(hs.size(), 0);
+
+    if (datasets_.insert(group + "/" + dataset_name).second)
+    {
+        // all dimensions can grow: rows as chunks are written, the others as longer repeated
+        // fields are found
+        std::vector<hsize_t> max_hs(hs.size(), H5S_UNLIMITED);
+        std::vector<hsize_t> chunk_hs(hs.size(), 1);
+        chunk_hs[0] = cfg_.chunk_size();
+        for (unsigned i = 1, n = hs.size(); i < n; ++i) chunk_hs[i] = std::max<hsize_t>(hs[i], 1);
+
+        H5::DataSpace dataspace(hs.size(), hs.data(), max_hs.data());
+        *created = true;
+        return grp.createDataSet(dataset_name, datatype, dataspace,
+                                 dataset_properties(datatype, chunk_hs, fill_value));
+    }
+    else
+    {
+        H5::DataSet dataset = grp.openDataSet(dataset_name);
+        std::vector<hsize_t> current_hs(hs.size(), 0);
+        dataset.getSpace().getSimpleExtentDims(current_hs.data());
+
+        std::vector<hsize_t> new_hs(current_hs);
+        new_hs[0] += hs[0];
+        (*offset)[0] = current_hs[0];
+        for (unsigned i = 1, n = hs.size(); i < n; ++i)
+            new_hs[i] = std::max(current_hs[i], hs[i]);
+
+        dataset.extend(new_hs.data());
+        *created = false;
+        return dataset;
+    }
+}
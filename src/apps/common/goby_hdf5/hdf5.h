@@ -22,7 +22,12 @@
 #ifndef GOBYHDF520160524H
 #define GOBYHDF520160524H
 
+#include <algorithm>
+#include <deque>
+#include <set>
+
 #include <boost/algorithm/string.hpp>
+#include <boost/thread.hpp>
 
 #include "H5Cpp.h"
 
@@ -54,7 +59,8 @@ struct Channel
     Channel(const std::string& n) : name(n) {}
     std::string name;
 
-    void add_message(const goby::common::HDF5ProtobufEntry& entry);
+    // returns the collection the entry was added to
+    MessageCollection& add_message(const goby::common::HDF5ProtobufEntry& entry);
 
     // message name -> hdf5::Message
     std::map<std::string, MessageCollection> entries;
@@ -90,39 +96,123 @@ class GroupFactory
     GroupWrapper root_group_;
 };
 
+class Writer;
+
+// a dataset flattened from a MessageCollection, waiting to be written to the file
+struct Column
+{
+    Column(const std::string& g, const std::string& n, const std::vector<hsize_t>& h)
+        : group(g), name(n), hs(h), enum_field(0)
+    {
+    }
+    virtual ~Column() {}
+    virtual void write(Writer& writer) = 0;
+
+    std::string group;
+    std::string name;
+    std::vector<hsize_t> hs;
+    // if set, the enumeration names and values are also written as attributes
+    const google::protobuf::FieldDescriptor* enum_field;
+};
+
+template <typename T> struct TypedColumn : public Column
+{
+    TypedColumn(const std::string& g, const std::string& n, const std::vector<hsize_t>& h)
+        : Column(g, n, h)
+    {
+    }
+    void write(Writer& writer);
+
+    std::vector<T> data;
+    T default_value;
+};
+
+// compiled once per message type: how each field is flattened into columns
+struct FieldPlan
+{
+    typedef void (*Flattener)(const FieldPlan& plan, const std::string& group,
+                              const std::vector<const google::protobuf::Message*>& messages,
+                              std::vector<hsize_t>& hs,
+                              std::vector<boost::shared_ptr<Column> >& columns);
+
+    FieldPlan(const google::protobuf::FieldDescriptor* f, Flattener fl)
+        : field_desc(f), flatten(fl), is_enum(false)
+    {
+    }
+
+    const google::protobuf::FieldDescriptor* field_desc;
+    // typed column filler, or for embedded messages, recurses into children
+    Flattener flatten;
+    // embedded messages: the group containing the children's columns (relative to the parent)
+    std::string sub_group;
+    std::vector<FieldPlan> children;
+    bool is_enum;
+};
+
+struct MessagePlan
+{
+    std::vector<FieldPlan> fields;
+};
+
+// a MessageCollection to be flattened into columns (on a worker thread if configured) and then
+// written to the file
+struct ConversionJob
+{
+    ConversionJob(const std::string& g, const std::string& n)
+        : group(g), message_collection(n), done(false)
+    {
+    }
+
+    std::string group;
+    MessageCollection message_collection;
+    boost::shared_ptr<const MessagePlan> plan;
+    std::vector<boost::shared_ptr<Column> > columns;
+    std::string error;
+    bool done;
+};
+
 class Writer : public goby::common::ApplicationBase
 {
   public:
     Writer(goby::common::protobuf::HDF5Config* cfg);
 
   private:
+    template <typename T> friend struct TypedColumn;
+
     void load();
     void collect();
     void write();
-    void write_channel(const std::string& group, const goby::common::hdf5::Channel& channel);
-    void write_message_collection(const std::string& group,
-                                  const goby::common::hdf5::MessageCollection& message_collection);
-    void write_time(const std::string& group,
-                    const goby::common::hdf5::MessageCollection& message_collection);
-
-    void write_field_selector(const std::string& group,
-                              const google::protobuf::FieldDescriptor* field_desc,
-                              const std::vector<const google::protobuf::Message*>& messages,
-                              std::vector<hsize_t>& hs);
+    void write_channel(const std::string& group, goby::common::hdf5::Channel& channel);
+    void write_stats();
+
+    // moves the contents of message_collection into a job for flatten() and write_job()
+    void submit(const std::string& group,
+                goby::common::hdf5::MessageCollection& message_collection);
+    // waits for the oldest submitted job to be flattened, then writes it
+    void write_next_job();
+    void write_job(ConversionJob& job);
+    void worker_run();
+
+    // reflection over the messages (thread safe): fills job.columns
+    void flatten(ConversionJob& job) const;
+
+    void flatten_time(const std::string& group,
+                      const goby::common::hdf5::MessageCollection& message_collection,
+                      std::vector<boost::shared_ptr<Column> >& columns) const;
+
+    // returns the cached plan for desc, compiling it on first use (main thread only)
+    boost::shared_ptr<const MessagePlan> message_plan(const google::protobuf::Descriptor* desc);
+    void compile_plan(const google::protobuf::Descriptor* desc,
+                      std::vector<FieldPlan>* fields) const;
+
+    // dataset creation properties: chunking (if chunk_hs is not empty), fill value and filters
+    H5::DSetCreatPropList dataset_properties(const H5::DataType& datatype,
+                                             const std::vector<hsize_t>& chunk_hs,
+                                             const void* fill_value) const;
 
     void write_enum_attributes(const std::string& group,
                                const google::protobuf::FieldDescriptor* field_desc);
 
-    template <typename T>
-    void write_field(const std::string& group, const google::protobuf::FieldDescriptor* field_desc,
-                     const std::vector<const google::protobuf::Message*>& messages,
-                     std::vector<hsize_t>& hs);
-
-    void write_embedded_message(const std::string& group,
-                                const google::protobuf::FieldDescriptor* field_desc,
-                                const std::vector<const google::protobuf::Message*> messages,
-                                std::vector<hsize_t>& hs);
-
     template <typename T>
     void write_vector(const std::string& group, const std::string dataset_name,
                       const std::vector<T>& data, const std::vector<hsize_t>& hs,
@@ -132,6 +222,17 @@ class Writer : public goby::common::ApplicationBase
                       const std::vector<std::string>& data, const std::vector<hsize_t>& hs,
                       const std::string& default_value);
 
+    // (streaming) creates the dataset, or extends it to hold another hs[0] rows (and any larger
+    // repeated field sizes); offset is set to the position of the first new row
+    H5::DataSet extend_dataset(const std::string& group, const std::string& dataset_name,
+                               const H5::DataType& datatype, const std::vector<hsize_t>& hs,
+                               const void* fill_value, std::vector<hsize_t>* offset,
+                               bool* created);
+
+    template <typename T>
+    void write_data(H5::DataSet& dataset, const T* data, const H5::DataType& datatype,
+                    const std::vector<hsize_t>& hs, const std::vector<hsize_t>& offset);
+
     void iterate() {}
 
   private:
@@ -143,69 +244,111 @@ class Writer : public goby::common::ApplicationBase
     H5::H5File h5file_;
 
     goby::common::hdf5::GroupFactory group_factory_;
+
+    // (streaming) paths of the datasets created so far
+    std::set<std::string> datasets_;
+
+    std::map<const google::protobuf::Descriptor*, boost::shared_ptr<const MessagePlan> > plans_;
+
+    // submitted, but not yet written (in order of submission)
+    std::deque<boost::shared_ptr<ConversionJob> > pending_jobs_;
+    // waiting for a worker thread
+    std::deque<boost::shared_ptr<ConversionJob> > queued_jobs_;
+    boost::mutex jobs_mutex_;
+    boost::condition_variable job_queued_;
+    boost::condition_variable job_done_;
+    boost::thread_group workers_;
+    unsigned num_workers_;
+    bool workers_run_;
+
+    goby::uint64 rows_written_;
+    boost::posix_time::ptime start_time_;
 };
 
+template <typename T> void TypedColumn<T>::write(Writer& writer)
+{
+    writer.write_vector(group, name, data, hs, default_value);
+    if (enum_field)
+        writer.write_enum_attributes(group, enum_field);
+}
+
+// finds the reflection shared by all the (non-null) messages, which are all the same type
+inline const google::protobuf::Reflection*
+collection_reflection(const std::vector<const google::protobuf::Message*>& messages)
+{
+    for (unsigned i = 0, n = messages.size(); i < n; ++i)
+    {
+        if (messages[i])
+            return messages[i]->GetReflection();
+    }
+    return 0;
+}
+
+void flatten_embedded_message(const FieldPlan& plan, const std::string& group,
+                              const std::vector<const google::protobuf::Message*>& messages,
+                              std::vector<hsize_t>& hs,
+                              std::vector<boost::shared_ptr<Column> >& columns);
+
+// placeholder for users to know that the field exists, even if the data are omitted
+void flatten_omitted_field(const FieldPlan& plan, const std::string& group,
+                           const std::vector<const google::protobuf::Message*>& messages,
+                           std::vector<hsize_t>& hs,
+                           std::vector<boost::shared_ptr<Column> >& columns);
+
 template <typename T>
-void Writer::write_field(const std::string& group,
-                         const google::protobuf::FieldDescriptor* field_desc,
-                         const std::vector<const google::protobuf::Message*>& messages,
-                         std::vector<hsize_t>& hs)
+void flatten_field(const FieldPlan& plan, const std::string& group,
+                   const std::vector<const google::protobuf::Message*>& messages,
+                   std::vector<hsize_t>& hs, std::vector<boost::shared_ptr<Column> >& columns)
 {
+    const google::protobuf::FieldDescriptor* field_desc = plan.field_desc;
+    const google::protobuf::Reflection* refl = collection_reflection(messages);
+    const unsigned n = messages.size();
+
+    boost::shared_ptr<TypedColumn<T> > column;
     if (field_desc->is_repeated())
     {
         // pass one to figure out field size
+        std::vector<int> field_sizes(n, 0);
         int max_field_size = 0;
-        for (unsigned i = 0, n = messages.size(); i < n; ++i)
+        for (unsigned i = 0; i < n; ++i)
         {
             if (messages[i])
             {
-                const google::protobuf::Reflection* refl = messages[i]->GetReflection();
-                int field_size = refl->FieldSize(*messages[i], field_desc);
-                if (field_size > max_field_size)
-                    max_field_size = field_size;
+                field_sizes[i] = refl->FieldSize(*messages[i], field_desc);
+                if (field_sizes[i] > max_field_size)
+                    max_field_size = field_sizes[i];
             }
         }
 
         hs.push_back(max_field_size);
+        column.reset(new TypedColumn<T>(group, field_desc->name(), hs));
+        hs.pop_back();
 
-        std::vector<T> values(messages.size() * max_field_size, retrieve_empty_value<T>());
-
-        for (unsigned i = 0, n = messages.size(); i < n; ++i)
+        std::vector<T>& values = column->data;
+        values.resize(n * max_field_size, retrieve_empty_value<T>());
+        for (unsigned i = 0; i < n; ++i)
         {
-            if (messages[i])
-            {
-                const google::protobuf::Reflection* refl = messages[i]->GetReflection();
-                int field_size = refl->FieldSize(*messages[i], field_desc);
-                for (int j = 0; j < field_size; ++j)
-                    retrieve_repeated_value<T>(&values[i * max_field_size + j], j,
-                                               PBMeta(refl, field_desc, (*messages[i])));
-            }
+            T* row = values.empty() ? 0 : &values[i * max_field_size];
+            for (int j = 0; j < field_sizes[i]; ++j)
+                retrieve_repeated_value<T>(&row[j], j, PBMeta(refl, field_desc, (*messages[i])));
         }
-
-        T default_value;
-        retrieve_default_value(&default_value, field_desc);
-
-        write_vector(group, field_desc->name(), values, hs, default_value);
-
-        hs.pop_back();
     }
     else
     {
-        std::vector<T> values(messages.size(), retrieve_empty_value<T>());
-        for (unsigned i = 0, n = messages.size(); i < n; ++i)
+        column.reset(new TypedColumn<T>(group, field_desc->name(), hs));
+        std::vector<T>& values = column->data;
+        values.resize(n, retrieve_empty_value<T>());
+        for (unsigned i = 0; i < n; ++i)
         {
             if (messages[i])
-            {
-                const google::protobuf::Reflection* refl = messages[i]->GetReflection();
                 retrieve_single_value<T>(&values[i], PBMeta(refl, field_desc, (*messages[i])));
-            }
         }
-
-        T default_value;
-        retrieve_default_value(&default_value, field_desc);
-
-        write_vector(group, field_desc->name(), values, hs, default_value);
     }
+
+    retrieve_default_value(&column->default_value, field_desc);
+    if (plan.is_enum)
+        column->enum_field = field_desc;
+    columns.push_back(column);
 }
 
 template <typename T>
@@ -213,17 +356,59 @@ void Writer::write_vector(const std::string& group, const std::string dataset_na
                           const std::vector<T>& data, const std::vector<hsize_t>& hs,
                           const T& default_value)
 {
-    H5::DataSpace dataspace(hs.size(), hs.data(), hs.data());
-    H5::Group& grp = group_factory_.fetch_group(group);
-    H5::DataSet dataset = grp.createDataSet(dataset_name, predicate<T>(), dataspace);
+    H5::DataSet dataset;
+    std::vector<hsize_t> offset(hs.size(), 0);
+    bool created = true;
+    if (cfg_.streaming())
+    {
+        const T fill_value = retrieve_empty_value<T>();
+        dataset =
+            extend_dataset(group, dataset_name, predicate<T>(), hs, &fill_value, &offset, &created);
+    }
+    else
+    {
+        // filters need a chunked layout, which can't have zero sized dimensions
+        std::vector<hsize_t> chunk_hs;
+        if (cfg_.compression_level() > 0 && std::find(hs.begin(), hs.end(), 0) == hs.end())
+        {
+            chunk_hs = hs;
+            chunk_hs[0] = std::min<hsize_t>(hs[0], std::max(cfg_.chunk_size(), 1u));
+        }
+
+        H5::DataSpace dataspace(hs.size(), hs.data(), hs.data());
+        H5::Group& grp = group_factory_.fetch_group(group);
+        dataset = grp.createDataSet(dataset_name, predicate<T>(), dataspace,
+                                    dataset_properties(predicate<T>(), chunk_hs, 0));
+    }
+
     if (data.size())
-        dataset.write(&data[0], predicate<T>());
+        write_data(dataset, &data[0], predicate<T>(), hs, offset);
 
-    const int rank = 1;
-    hsize_t att_hs[] = {1};
-    H5::DataSpace att_space(rank, att_hs, att_hs);
-    H5::Attribute att = dataset.createAttribute("default_value", predicate<T>(), att_space);
-    att.write(predicate<T>(), &default_value);
+    if (created)
+    {
+        const int rank = 1;
+        hsize_t att_hs[] = {1};
+        H5::DataSpace att_space(rank, att_hs, att_hs);
+        H5::Attribute att = dataset.createAttribute("default_value", predicate<T>(), att_space);
+        att.write(predicate<T>(), &default_value);
+    }
+}
+
+template <typename T>
+void Writer::write_data(H5::DataSet& dataset, const T* data, const H5::DataType& datatype,
+                        const std::vector<hsize_t>& hs, const std::vector<hsize_t>& offset)
+{
+    if (cfg_.streaming())
+    {
+        H5::DataSpace mem_space(hs.size(), hs.data());
+        H5::DataSpace file_space = dataset.getSpace();
+        file_space.selectHyperslab(H5S_SELECT_SET, hs.data(), offset.data());
+        dataset.write(data, datatype, mem_space, file_space);
+    }
+    else
+    {
+        dataset.write(data, datatype);
+    }
 }
 } // namespace hdf5
 } // namespace common
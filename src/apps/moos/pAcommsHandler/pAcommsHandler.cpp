@@ -69,7 +69,9 @@ CpAcommsHandler::CpAcommsHandler()
     : GobyMOOSApp(&cfg_),
       translator_(goby::moos::protobuf::TranslatorEntry(), cfg_.common().lat_origin(),
                   cfg_.common().lon_origin(), cfg_.modem_id_lookup_path()),
-      dccl_(goby::acomms::DCCLCodec::get()), work_(timer_io_service_), router_(0)
+      dccl_(goby::acomms::DCCLCodec::get()), work_(timer_io_service_), router_(0),
+      event_pending_(false), event_time_(-1), event_shutdown_(false), service_arrival_time_(-1),
+      next_latency_report_time_(goby::common::goby_time<double>() + cfg_.latency_report_interval())
 {
 #ifdef ENABLE_GOBY_V1_TRANSITIONAL_SUPPORT
     transitional_dccl_.convert_to_v2_representation(&cfg_);
@@ -123,8 +125,21 @@ CpAcommsHandler::CpAcommsHandler()
                   goby::acomms::protobuf::DriverConfig*>::iterator it = drivers_.begin(),
                                                                    end = drivers_.end();
          it != end; ++it)
+    {
         goby::acomms::bind(*(it->first), queue_manager_);
 
+        // the callback changes how some drivers run (UDPDriver starts an I/O thread), so
+        // only install it when event driven servicing is requested
+        if (cfg_.event_driven())
+        {
+            it->first->set_data_ready_callback(
+                boost::bind(&CpAcommsHandler::handle_data_ready, this));
+            // after the QueueManager has filled the request
+            goby::acomms::connect(&it->first->signal_data_request, this,
+                                  &CpAcommsHandler::handle_data_request_latency);
+        }
+    }
+
     if (router_)
     {
         bind(queue_manager_, *router_);
@@ -150,7 +165,18 @@ CpAcommsHandler::CpAcommsHandler()
                  &CpAcommsHandler::handle_driver_cfg_update, this);
 }
 
-CpAcommsHandler::~CpAcommsHandler() {}
+CpAcommsHandler::~CpAcommsHandler()
+{
+    if (event_thread_)
+    {
+        {
+            boost::mutex::scoped_lock lock(event_mutex_);
+            event_shutdown_ = true;
+        }
+        event_cond_.notify_one();
+        event_thread_->join();
+    }
+}
 
 void CpAcommsHandler::loop()
 {
@@ -159,6 +185,35 @@ void CpAcommsHandler::loop()
     if (driver_restart_time_.size())
         restart_drivers();
 
+    service_drivers();
+
+    // start after the first restart_drivers() so the drivers are running
+    if (cfg_.event_driven() && !event_thread_)
+        event_thread_.reset(
+            new boost::thread(boost::bind(&CpAcommsHandler::event_loop, this)));
+
+    if (cfg_.latency_report_interval() > 0)
+    {
+        double now = goby::common::goby_time<double>();
+        if (now >= next_latency_report_time_)
+        {
+            publish_latency();
+            next_latency_report_time_ = now + cfg_.latency_report_interval();
+        }
+    }
+}
+
+void CpAcommsHandler::service_drivers()
+{
+    {
+        boost::mutex::scoped_lock lock(event_mutex_);
+        service_arrival_time_ = event_pending_ ? event_time_ : -1;
+        event_pending_ = false;
+    }
+
+    if (service_arrival_time_ >= 0)
+        service_latency_.add(goby::common::goby_time<double>() - service_arrival_time_);
+
     for (std::map<boost::shared_ptr<goby::acomms::ModemDriverBase>,
                   goby::acomms::protobuf::DriverConfig*>::iterator it = drivers_.begin(),
                                                                    end = drivers_.end();
@@ -182,6 +237,86 @@ void CpAcommsHandler::loop()
     if (!driver_restart_time_.count(driver_))
         mac_.do_work();
     queue_manager_.do_work();
+
+    service_arrival_time_ = -1;
+}
+
+void CpAcommsHandler::handle_data_ready()
+{
+    {
+        boost::mutex::scoped_lock lock(event_mutex_);
+        if (!event_pending_)
+        {
+            event_pending_ = true;
+            event_time_ = goby::common::goby_time<double>();
+        }
+    }
+    event_cond_.notify_one();
+}
+
+void CpAcommsHandler::event_loop()
+{
+    while (true)
+    {
+        {
+            boost::mutex::scoped_lock lock(event_mutex_);
+            while (!event_pending_ && !event_shutdown_) event_cond_.wait(lock);
+            if (event_shutdown_)
+                return;
+        }
+
+        boost::mutex::scoped_lock lock(app_mutex());
+        service_drivers();
+    }
+}
+
+void CpAcommsHandler::handle_data_request_latency(
+    goby::acomms::protobuf::ModemTransmission* /*msg*/)
+{
+    // only data requests prompted by data from the modem (e.g. $CADRQ)
+    if (service_arrival_time_ >= 0)
+        data_request_latency_.add(goby::common::goby_time<double>() - service_arrival_time_);
+}
+
+void CpAcommsHandler::publish_latency()
+{
+    pAcommsHandlerLatency latency;
+    latency.set_event_driven(cfg_.event_driven());
+    service_latency_.get(latency.mutable_service());
+    data_request_latency_.get(latency.mutable_data_request());
+
+    glog.is(DEBUG1) && glog << group("pAcommsHandler") << "Latency: " << latency.ShortDebugString()
+                            << std::endl;
+
+    publish_pb(cfg_.moos_var().prefix() + cfg_.moos_var().latency(), latency);
+}
+
+const double LatencyHistogram::MIN_UPPER = 1e-4;
+
+void LatencyHistogram::add(double latency)
+{
+    int bin = 0;
+    for (double upper = MIN_UPPER; bin < NUM_BINS - 1 && latency >= upper; upper *= 2) ++bin;
+    ++bins_[bin];
+
+    ++count_;
+    sum_ += latency;
+    max_ = std::max(max_, latency);
+}
+
+void LatencyHistogram::get(pAcommsHandlerLatency::Histogram* histogram) const
+{
+    histogram->set_count(count_);
+    histogram->set_mean(count_ ? sum_ / count_ : 0);
+    histogram->set_max(max_);
+
+    double upper = MIN_UPPER;
+    for (int bin = 0; bin < NUM_BINS; ++bin, upper *= 2)
+    {
+        if (bin < NUM_BINS - 1)
+            histogram->add_bin_upper(upper);
+        histogram->add_bin_count(bins_[bin]);
+    }
 }
 
 //
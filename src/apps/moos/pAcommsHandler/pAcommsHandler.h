@@ -30,6 +30,7 @@
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/bimap.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
 
 #include "goby/acomms.h"
 #include "goby/util.h"
@@ -69,6 +70,28 @@ inline bool operator<(const shared_ptr<goby::acomms::ModemDriverBase>& lhs,
 }
 } // namespace boost
 
+// histogram of latencies (seconds) in bins that double in width from MIN_UPPER
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram() : bins_(NUM_BINS, 0), count_(0), sum_(0), max_(0) {}
+
+    void add(double latency);
+    void get(pAcommsHandlerLatency::Histogram* histogram) const;
+
+  private:
+    enum
+    {
+        NUM_BINS = 18
+    };
+    static const double MIN_UPPER;
+
+    std::vector<goby::uint64> bins_;
+    goby::uint64 count_;
+    double sum_;
+    double max_;
+};
+
 class CpAcommsHandler : public GobyMOOSApp
 {
   public:
@@ -127,6 +150,16 @@ class CpAcommsHandler : public GobyMOOSApp
 
     void restart_drivers();
 
+    // do_work() for the drivers, MAC and queue (call with app_mutex() locked)
+    void service_drivers();
+
+    // from the drivers' I/O threads when there is new data from the modem
+    void handle_data_ready();
+    // runs event_thread_ for cfg_.event_driven()
+    void event_loop();
+    void handle_data_request_latency(goby::acomms::protobuf::ModemTransmission* msg);
+    void publish_latency();
+
     enum
     {
         ALLOWED_TIMER_SKEW_SECONDS = 1
@@ -174,6 +207,22 @@ class CpAcommsHandler : public GobyMOOSApp
 
     std::set<const google::protobuf::Descriptor*> dccl_frontseat_forward_;
 
+    // services the drivers as soon as they have data (cfg_.event_driven())
+    boost::shared_ptr<boost::thread> event_thread_;
+    // protects event_pending_, event_time_, event_shutdown_
+    boost::mutex event_mutex_;
+    boost::condition_variable event_cond_;
+    bool event_pending_;
+    // arrival time of the oldest data not yet serviced
+    double event_time_;
+    bool event_shutdown_;
+
+    // arrival time of the data being serviced by service_drivers(), or -1
+    double service_arrival_time_;
+    LatencyHistogram service_latency_;
+    LatencyHistogram data_request_latency_;
+    double next_latency_report_time_;
+
     static pAcommsHandlerConfig cfg_;
     static CpAcommsHandler* inst_;
 };
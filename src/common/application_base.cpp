@@ -126,6 +126,9 @@ goby::common::ApplicationBase::ApplicationBase(google::protobuf::Message* cfg /*
         glog.add_stream(base_cfg_->glog_config().file_log(i).verbosity(), fout_[i].get());
     }
 
+    if (base_cfg_->glog_config().async())
+        glog.enable_async(base_cfg_->glog_config().async_queue_size());
+
     if (!base_cfg_->IsInitialized())
         throw(common::ConfigException("Invalid base configuration"));
 
@@ -136,6 +139,9 @@ goby::common::ApplicationBase::~ApplicationBase()
 {
     glog.is(DEBUG1) && glog << "ApplicationBase destructing..." << std::endl;
 
+    // write out any queued lines before fout_ is closed
+    glog.disable_async();
+
     if (own_base_cfg_)
         delete base_cfg_;
 }
@@ -76,6 +76,20 @@ class FlexOstream : public std::ostream
         sb_.enable_gui();
     }
 
+    /// Write log lines to the attached streams from a separate thread (see FlexOStreamBuf::enable_async)
+    void enable_async(std::size_t queue_size = 1000)
+    {
+        boost::recursive_mutex::scoped_lock l(goby::common::logger::mutex);
+        sb_.enable_async(queue_size);
+    }
+
+    /// Write out any queued lines and return to writing them synchronously
+    void disable_async()
+    {
+        boost::recursive_mutex::scoped_lock l(goby::common::logger::mutex);
+        sb_.disable_async();
+    }
+
     bool is(goby::common::logger::Verbosity verbosity);
 
     /* void add_stream(const std::string& verbosity, std::ostream* os = 0) */
@@ -20,6 +20,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -55,7 +56,8 @@ goby::common::FlexOStreamBuf::FlexOStreamBuf(FlexOstream* parent)
 #ifdef HAS_NCURSES
       curses_(0),
 #endif
-      start_time_(goby_time()), is_gui_(false), highest_verbosity_(logger::QUIET), parent_(parent)
+      start_time_(goby_time()), is_gui_(false), async_run_(false), async_waiting_(false),
+      async_dropped_(0), highest_verbosity_(logger::QUIET), parent_(parent)
 
 {
     Group no_group("", "Ungrouped messages");
@@ -64,6 +66,8 @@ goby::common::FlexOStreamBuf::FlexOStreamBuf(FlexOstream* parent)
 
 goby::common::FlexOStreamBuf::~FlexOStreamBuf()
 {
+    disable_async();
+
 #ifdef HAS_NCURSES
     if (curses_)
         delete curses_;
@@ -72,6 +76,8 @@ goby::common::FlexOStreamBuf::~FlexOStreamBuf()
 
 void goby::common::FlexOStreamBuf::add_stream(logger::Verbosity verbosity, std::ostream* os)
 {
+    boost::mutex::scoped_lock lock(streams_mutex_);
+
     //check that this stream doesn't exist
     // if so, update its verbosity and return
     bool stream_exists = false;
@@ -141,6 +147,9 @@ int goby::common::FlexOStreamBuf::overflow(int c /*= EOF*/)
 {
     parent_->set_unset_verbosity();
 
+    // anything already in the put area precedes c
+    move_put_area();
+
     if (c == EOF)
         return c;
     else if (c == '\n')
@@ -151,9 +160,31 @@ int goby::common::FlexOStreamBuf::overflow(int c /*= EOF*/)
     return c;
 }
 
+// split the characters in the put area into lines in buffer_
+void goby::common::FlexOStreamBuf::move_put_area()
+{
+    const char* p = pbase();
+    const char* end = pptr();
+    while (p != end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline)
+        {
+            buffer_.back().append(p, end);
+            break;
+        }
+        buffer_.back().append(p, newline);
+        buffer_.push_back(std::string());
+        p = newline + 1;
+    }
+    setp(pbase(), epptr());
+}
+
 // called when flush() or std::endl
 int goby::common::FlexOStreamBuf::sync()
 {
+    move_put_area();
+
     if (current_verbosity_ == logger::UNKNOWN && lock_action_ == logger_lock::lock)
     {
         std::cerr
@@ -173,7 +204,7 @@ int goby::common::FlexOStreamBuf::sync()
 
     group_name_.erase();
 
-    current_verbosity_ = logger::UNKNOWN;
+    set_verbosity_depth(logger::UNKNOWN);
 
     if (die_flag_)
         exit(EXIT_FAILURE);
@@ -188,11 +219,44 @@ int goby::common::FlexOStreamBuf::sync()
 
 void goby::common::FlexOStreamBuf::display(std::string& s)
 {
+    // write out everything queued before the line we are about to exit on
+    if (async_queue_ && die_flag_)
+        disable_async();
+
+    if (async_queue_ && !is_gui_)
+    {
+        LogRecord* record = async_queue_->back();
+        if (!record)
+        {
+            ++async_dropped_;
+            return;
+        }
+
+        record->verbosity = current_verbosity_;
+        record->color = groups_[group_name_].color();
+        record->time = goby_time();
+        record->group_name = group_name_;
+        record->text.swap(s);
+        async_queue_->push();
+
+        if (async_waiting_)
+        {
+            boost::mutex::scoped_lock lock(async_mutex_);
+            async_cond_.notify_one();
+        }
+        return;
+    }
+
+    sync_record_.verbosity = current_verbosity_;
+    sync_record_.color = groups_[group_name_].color();
+    sync_record_.time = goby_time();
+    sync_record_.group_name = group_name_;
+    sync_record_.text.swap(s);
+
     bool gui_displayed = false;
     BOOST_FOREACH (const StreamConfig& cfg, streams_)
     {
-        if ((cfg.os() == &std::cout || cfg.os() == &std::cerr || cfg.os() == &std::clog) &&
-            current_verbosity_ <= cfg.verbosity())
+        if (is_terminal(cfg.os()) && current_verbosity_ <= cfg.verbosity())
         {
 #ifdef HAS_NCURSES
             if (is_gui_ && current_verbosity_ <= cfg.verbosity() && !gui_displayed)
@@ -207,7 +271,7 @@ void goby::common::FlexOStreamBuf::display(std::string& s)
                          << std::setw(2) << time_of_day.minutes() << ":" << std::setw(2)
                          << time_of_day.seconds()
                          << TermColor::esc_code_from_col(groups_[group_name_].color()) << " | "
-                         << esc_nocolor << s;
+                         << esc_nocolor << sync_record_.text;
 
                     curses_->insert(goby_time(), line.str(), &groups_[group_name_]);
                 }
@@ -217,29 +281,109 @@ void goby::common::FlexOStreamBuf::display(std::string& s)
                     input_thread_->join();
                     curses_->cleanup();
                     std::cerr << TermColor::esc_code_from_col(groups_[group_name_].color()) << name_
-                              << esc_nocolor << ": " << s << esc_nocolor << std::endl;
+                              << esc_nocolor << ": " << sync_record_.text << esc_nocolor
+                              << std::endl;
                 }
                 gui_displayed = true;
                 continue;
             }
 #endif
-
-            *cfg.os() << TermColor::esc_code_from_col(groups_[group_name_].color()) << name_
-                      << esc_nocolor << " [" << goby::common::goby_time_as_string() << "]";
-            if (!group_name_.empty())
-                *cfg.os() << " "
-                          << "{" << group_name_ << "}";
-            *cfg.os() << ": " << s << std::endl;
+            write(cfg.os(), true, sync_record_);
+            cfg.os()->flush();
         }
         else if (cfg.os() && current_verbosity_ <= cfg.verbosity())
         {
-            basic_log_header(*cfg.os(), group_name_);
-            strip_escapes(s);
-            *cfg.os() << s << std::endl;
+            write(cfg.os(), false, sync_record_);
+            cfg.os()->flush();
         }
     }
 }
 
+void goby::common::FlexOStreamBuf::write(std::ostream* os, bool is_terminal, LogRecord& record)
+{
+    if (is_terminal)
+    {
+        *os << TermColor::esc_code_from_col(record.color) << name_ << esc_nocolor << " ["
+            << goby::common::goby_time_as_string(record.time) << "]";
+        if (!record.group_name.empty())
+            *os << " "
+                << "{" << record.group_name << "}";
+        *os << ": " << record.text << "\n";
+    }
+    else
+    {
+        basic_log_header(*os, record.group_name, record.time);
+        strip_escapes(record.text);
+        *os << record.text << "\n";
+    }
+}
+
+void goby::common::FlexOStreamBuf::enable_async(std::size_t queue_size)
+{
+    if (async_queue_)
+        return;
+
+    async_queue_.reset(new SPSCRingBuffer<LogRecord>(queue_size));
+    async_run_ = true;
+    async_thread_.reset(new boost::thread(boost::bind(&FlexOStreamBuf::async_run, this)));
+}
+
+void goby::common::FlexOStreamBuf::disable_async()
+{
+    if (!async_queue_)
+        return;
+
+    {
+        boost::mutex::scoped_lock lock(async_mutex_);
+        async_run_ = false;
+        async_cond_.notify_one();
+    }
+    async_thread_->join();
+    async_thread_.reset();
+    async_queue_.reset();
+}
+
+// writer thread for enable_async()
+void goby::common::FlexOStreamBuf::async_run()
+{
+    for (;;)
+    {
+        // read before draining so that lines queued before disable_async() are always written
+        bool run = async_run_;
+
+        if (!async_queue_->empty())
+        {
+            boost::mutex::scoped_lock lock(streams_mutex_);
+            while (LogRecord* record = async_queue_->front())
+            {
+                BOOST_FOREACH (const StreamConfig& cfg, streams_)
+                {
+                    if (cfg.os() && record->verbosity <= cfg.verbosity())
+                        write(cfg.os(), is_terminal(cfg.os()), *record);
+                }
+                async_queue_->pop();
+            }
+
+            // flush once per batch rather than once per line
+            BOOST_FOREACH (const StreamConfig& cfg, streams_)
+            {
+                if (cfg.os())
+                    cfg.os()->flush();
+            }
+        }
+
+        if (!run)
+            break;
+
+        boost::mutex::scoped_lock lock(async_mutex_);
+        async_waiting_ = true;
+        // the timeout only guards against a missed notification
+        if (async_run_ && async_queue_->empty())
+            async_cond_.timed_wait(lock, boost::posix_time::milliseconds(100));
+        async_waiting_ = false;
+    }
+}
+
 void goby::common::FlexOStreamBuf::refresh()
 {
 #ifdef HAS_NCURSES
@@ -31,10 +31,13 @@
 
 #include <boost/thread.hpp>
 
+#include <boost/atomic.hpp>
 #include <boost/date_time.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "goby/common/protobuf/logger.pb.h"
+#include "goby/common/spsc_ring_buffer.h"
 
 #include "term_color.h"
 
@@ -86,11 +89,15 @@ class FlexOStreamBuf : public std::streambuf
     /// virtual inherited from std::streambuf. Called when std::endl or std::flush is inserted into the stream
     int sync();
 
-    /// virtual inherited from std::streambuf. Called when something is inserted into the stream
+    /// virtual inherited from std::streambuf. Called when the put area is full (or unset, before the verbosity of the line is known)
     int overflow(int c = EOF);
 
     /// name of the application being served
-    void name(const std::string& s) { name_ = s; }
+    void name(const std::string& s)
+    {
+        boost::mutex::scoped_lock lock(streams_mutex_);
+        name_ = s;
+    }
 
     /// add a stream to the logger
     void add_stream(logger::Verbosity verbosity, std::ostream* os);
@@ -111,7 +118,16 @@ class FlexOStreamBuf : public std::streambuf
     /// exit on error at the next call to sync()
     void set_die_flag(bool b) { die_flag_ = b; }
 
-    void set_verbosity_depth(logger::Verbosity depth) { current_verbosity_ = depth; }
+    void set_verbosity_depth(logger::Verbosity depth)
+    {
+        current_verbosity_ = depth;
+        // with an unknown verbosity every character must go through overflow() so that
+        // FlexOstream can assign one before the line is buffered
+        if (depth == logger::UNKNOWN)
+            setp(0, 0);
+        else if (!pbase())
+            setp(put_area_, put_area_ + PUT_AREA_SIZE);
+    }
 
     logger::Verbosity verbosity_depth() { return current_verbosity_; }
 
@@ -125,11 +141,50 @@ class FlexOStreamBuf : public std::streambuf
 
     logger_lock::LockAction lock_action() { return lock_action_; }
 
+    /// \brief Write completed lines to the attached streams from a dedicated thread rather than in sync()
+    ///
+    /// \param queue_size Maximum number of lines waiting to be written. When the queue is full, new lines are dropped (and counted in async_dropped()) until the writer thread catches up.
+    /// Lines are always written synchronously while the NCurses GUI is enabled, and for the line containing the die manipulator (after the queue has been written out).
+    void enable_async(std::size_t queue_size);
+
+    /// \brief Write out any queued lines, stop the writer thread and return to writing in sync()
+    void disable_async();
+
+    bool is_async() const { return async_queue_.get() != 0; }
+
+    /// number of lines dropped because the asynchronous queue was full
+    google::protobuf::uint64 async_dropped() const { return async_dropped_; }
+
   private:
+    /// A completed line along with everything needed to format it for any stream
+    struct LogRecord
+    {
+        LogRecord() : verbosity(logger::UNKNOWN), color(Colors::nocolor) {}
+        logger::Verbosity verbosity;
+        Colors::Color color;
+        boost::posix_time::ptime time;
+        std::string group_name;
+        std::string text;
+    };
+
+    void move_put_area();
     void display(std::string& s);
+    void write(std::ostream* os, bool is_terminal, LogRecord& record);
     void strip_escapes(std::string& s);
+    void async_run();
+
+    static bool is_terminal(const std::ostream* os)
+    {
+        return os == &std::cout || os == &std::cerr || os == &std::clog;
+    }
 
   private:
+    enum
+    {
+        PUT_AREA_SIZE = 256
+    };
+    char put_area_[PUT_AREA_SIZE];
+
     std::deque<std::string> buffer_;
 
     class StreamConfig
@@ -163,9 +218,20 @@ class FlexOStreamBuf : public std::streambuf
     boost::posix_time::ptime start_time_;
 
     std::vector<StreamConfig> streams_;
+    // guards streams_ and name_ against changes while the writer thread is using them
+    boost::mutex streams_mutex_;
 
     bool is_gui_;
 
+    LogRecord sync_record_;
+    boost::scoped_ptr<SPSCRingBuffer<LogRecord> > async_queue_;
+    boost::scoped_ptr<boost::thread> async_thread_;
+    boost::atomic<bool> async_run_;
+    boost::atomic<bool> async_waiting_;
+    boost::mutex async_mutex_;
+    boost::condition_variable async_cond_;
+    boost::atomic<google::protobuf::uint64> async_dropped_;
+
     logger::Verbosity highest_verbosity_;
 
     logger_lock::LockAction lock_action_;
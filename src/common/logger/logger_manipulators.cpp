@@ -48,7 +48,13 @@ void GroupSetter::operator()(std::ostream& os) const
 
 std::ostream& basic_log_header(std::ostream& os, const std::string& group_name)
 {
-    os << "[ " << goby::common::goby_time_as_string() << " ]";
+    return basic_log_header(os, group_name, goby::common::goby_time());
+}
+
+std::ostream& basic_log_header(std::ostream& os, const std::string& group_name,
+                               const boost::posix_time::ptime& time)
+{
+    os << "[ " << goby::common::goby_time_as_string(time) << " ]";
 
     if (!group_name.empty())
         os << " " << std::setfill(' ') << std::setw(15) << "{" << group_name << "}";
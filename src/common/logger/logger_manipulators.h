@@ -26,6 +26,8 @@
 #include <iostream>
 #include <string>
 
+#include <boost/date_time/posix_time/ptime.hpp>
+
 #include "term_color.h"
 
 namespace goby
@@ -128,4 +130,8 @@ goby::common::FlexOstream& operator<<(goby::common::FlexOstream& os, const Group
 /// used for non tty ostreams (everything but std::cout / std::cerr) as the header for every line
 std::ostream& basic_log_header(std::ostream& os, const std::string& group_name);
 
+/// as above, but for a line that was written at `time` rather than now
+std::ostream& basic_log_header(std::ostream& os, const std::string& group_name,
+                               const boost::posix_time::ptime& time);
+
 #endif
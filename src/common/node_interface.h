@@ -39,11 +39,30 @@ template <typename NodeTypeBase> class NodeInterface
   protected:
     NodeInterface(ZeroMQService* service) : zeromq_service_(service)
     {
-        zeromq_service_->connect_inbox_slot(&NodeInterface<NodeTypeBase>::inbox, this);
+        zeromq_service_->connect_inbox_view_slot(&NodeInterface<NodeTypeBase>::inbox, this);
     }
 
+    /// \brief Called for each incoming packet. `identifier` and `body` are views into the received ZeroMQ message, valid only for the duration of this call.
+    ///
+    /// Override this to avoid copying. The default copies `identifier` and `body` and calls the std::string overload of inbox().
+    virtual void inbox(MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+                       boost::string_ref body, int socket_id)
+    {
+        inbox(marshalling_scheme, std::string(identifier.data(), identifier.size()),
+              std::string(body.data(), body.size()), socket_id);
+    }
+
+    /// \brief Called for each incoming packet by the default boost::string_ref inbox(), for subclasses that predate it.
+    ///
+    /// A subclass must override one of the two overloads; this default only warns that the packet is discarded.
     virtual void inbox(MarshallingScheme marshalling_scheme, const std::string& identifier,
-                       const std::string& body, int socket_id) = 0;
+                       const std::string& body, int socket_id)
+    {
+        goby::glog.is(goby::common::logger::WARN) &&
+            goby::glog << "NodeInterface: " << typeid(*this).name()
+                       << " overrides neither inbox(), discarding message: [" << identifier
+                       << "]" << std::endl;
+    }
 
   private:
     ZeroMQService* zeromq_service_;
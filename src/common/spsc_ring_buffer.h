@@ -0,0 +1,90 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SPSCRingBuffer20180615H
+#define SPSCRingBuffer20180615H
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace goby
+{
+namespace common
+{
+/// \brief Bounded lock-free single producer, single consumer queue whose slots are reused in place
+///
+/// Rather than copying values in and out, the producer fills the slot returned by back() and then calls push(); the consumer reads the slot returned by front() and then calls pop(). Since the slots are never destroyed, members that own memory (e.g. std::string) keep their capacity and steady-state operation does not allocate.
+template <typename T> class SPSCRingBuffer : boost::noncopyable
+{
+  public:
+    explicit SPSCRingBuffer(std::size_t capacity) : slots_(capacity + 1), head_(0), tail_(0) {}
+
+    /// \brief (Producer) Slot to fill for the next push(), or 0 if the buffer is full
+    T* back()
+    {
+        const std::size_t tail = tail_.load(boost::memory_order_relaxed);
+        if (increment(tail) == head_.load(boost::memory_order_acquire))
+            return 0;
+        return &slots_[tail];
+    }
+
+    /// \brief (Producer) Publishes the slot returned by back() to the consumer
+    void push() { tail_.store(increment(tail_.load(boost::memory_order_relaxed))); }
+
+    /// \brief (Consumer) Oldest published slot, or 0 if the buffer is empty
+    T* front()
+    {
+        const std::size_t head = head_.load(boost::memory_order_relaxed);
+        if (head == tail_.load(boost::memory_order_acquire))
+            return 0;
+        return &slots_[head];
+    }
+
+    /// \brief (Consumer) Releases the slot returned by front() back to the producer
+    void pop() { head_.store(increment(head_.load(boost::memory_order_relaxed))); }
+
+    bool empty() const { return head_.load() == tail_.load(); }
+
+    /// \brief Number of published slots (approximate if called while the other thread is active)
+    std::size_t size() const
+    {
+        const std::size_t head = head_.load(), tail = tail_.load();
+        return (tail >= head) ? tail - head : tail + slots_.size() - head;
+    }
+
+    std::size_t capacity() const { return slots_.size() - 1; }
+
+  private:
+    std::size_t increment(std::size_t i) const { return (i + 1 == slots_.size()) ? 0 : i + 1; }
+
+  private:
+    // one slot is always left empty to distinguish full from empty
+    std::vector<T> slots_;
+    boost::atomic<std::size_t> head_;
+    boost::atomic<std::size_t> tail_;
+};
+} // namespace common
+} // namespace goby
+
+#endif
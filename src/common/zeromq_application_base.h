@@ -84,6 +84,11 @@ class ZeroMQApplicationBase : public goby::common::ApplicationBase
     {
         using goby::glog;
 
+        // started here rather than in the constructor since derived classes configure the
+        // sockets in their constructors
+        if (base_cfg().zeromq_io_thread().enable() && !zeromq_service_.io_thread_running())
+            zeromq_service_.start_io_thread(base_cfg().zeromq_io_thread());
+
         // sit and wait on a message until the next time to call loop() is up
         long timeout = (t_next_loop_ - goby::common::goby_time()).total_microseconds();
         if (timeout < 0)
@@ -92,7 +97,17 @@ class ZeroMQApplicationBase : public goby::common::ApplicationBase
         glog.is(goby::common::logger::DEBUG3) && glog << "timeout set to: " << timeout
                                                       << " microseconds." << std::endl;
         bool had_events = zeromq_service_.poll(timeout);
-        if (!had_events)
+        if (zeromq_service_.io_thread_running())
+        {
+            // with the I/O thread, a steady stream of messages would otherwise starve loop()
+            if (goby::common::goby_time() >= t_next_loop_)
+            {
+                loop();
+                t_next_loop_ += loop_period_;
+                check_io_thread_drops();
+            }
+        }
+        else if (!had_events)
         {
             // no message, time to call loop()
             loop();
@@ -100,6 +115,26 @@ class ZeroMQApplicationBase : public goby::common::ApplicationBase
         }
     }
 
+    void check_io_thread_drops()
+    {
+        using goby::glog;
+
+        protobuf::ZeroMQIOThreadStatus status;
+        zeromq_service_.io_thread_status(&status);
+        if (status.inbox_dropped() > last_io_status_.inbox_dropped() ||
+            status.outbox_dropped() > last_io_status_.outbox_dropped())
+        {
+            glog.is(goby::common::logger::WARN) &&
+                glog << goby::common::logger::warn << "ZeroMQ I/O thread queues overflowed: "
+                     << status.inbox_dropped() - last_io_status_.inbox_dropped()
+                     << " incoming and "
+                     << status.outbox_dropped() - last_io_status_.outbox_dropped()
+                     << " outgoing messages dropped since the last check" << std::endl;
+        }
+        last_io_status_.set_inbox_dropped(status.inbox_dropped());
+        last_io_status_.set_outbox_dropped(status.outbox_dropped());
+    }
+
   private:
     ZeroMQService& zeromq_service_;
 
@@ -110,6 +145,9 @@ class ZeroMQApplicationBase : public goby::common::ApplicationBase
     boost::posix_time::ptime t_start_;
     // time of the next call to loop()
     boost::posix_time::ptime t_next_loop_;
+
+    // drop counts as of the last check_io_thread_drops()
+    protobuf::ZeroMQIOThreadStatus last_io_status_;
 };
 } // namespace common
 } // namespace goby
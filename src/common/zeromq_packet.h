@@ -24,50 +24,79 @@
 #define ZeroMQPacket20160413H
 
 #include "goby/common/core_constants.h"
+#include <boost/utility/string_ref.hpp>
+#include <cstring>
 #include <sstream>
 
 namespace goby
 {
 namespace common
 {
-std::string zeromq_packet_make_header(MarshallingScheme marshalling_scheme,
-                                      const std::string& identifier)
+/// byte size of the marshalling scheme that begins each Goby ZeroMQ packet
+const unsigned ZEROMQ_PACKET_MARSHALLING_SIZE = BITS_IN_UINT32 / BITS_IN_BYTE;
+
+/// \brief Size of the header (marshalling scheme, identifier and null terminator) for Goby over ZeroMQ
+inline std::size_t zeromq_packet_header_size(const std::string& identifier)
 {
-    std::string zmq_filter;
+    // +1 for null terminator
+    return ZEROMQ_PACKET_MARSHALLING_SIZE + identifier.size() + 1;
+}
 
+/// \brief Writes the header for Goby over ZeroMQ directly into `buffer`, which must have at least zeromq_packet_header_size(identifier) bytes available
+///
+/// \return pointer to the first byte past the header (i.e. where the body begins)
+inline char* zeromq_packet_write_header(char* buffer, MarshallingScheme marshalling_scheme,
+                                        const std::string& identifier)
+{
     google::protobuf::uint32 marshalling_int =
         static_cast<google::protobuf::uint32>(marshalling_scheme);
 
-    for (int i = 0, n = BITS_IN_UINT32 / BITS_IN_BYTE; i < n; ++i)
-    { zmq_filter.push_back((marshalling_int >> (BITS_IN_BYTE * (n - i - 1))) & 0xFF); }
-    zmq_filter += identifier + '\0';
+    for (int i = 0, n = ZEROMQ_PACKET_MARSHALLING_SIZE; i < n; ++i)
+        *buffer++ = (marshalling_int >> (BITS_IN_BYTE * (n - i - 1))) & 0xFF;
 
+    std::memcpy(buffer, identifier.data(), identifier.size());
+    buffer += identifier.size();
+    *buffer++ = '\0';
+    return buffer;
+}
+
+inline std::string zeromq_packet_make_header(MarshallingScheme marshalling_scheme,
+                                             const std::string& identifier)
+{
+    std::string zmq_filter(zeromq_packet_header_size(identifier), '\0');
+    zeromq_packet_write_header(&zmq_filter[0], marshalling_scheme, identifier);
     return zmq_filter;
 }
 
 /// \brief Encodes a packet for Goby over ZeroMQ
-void zeromq_packet_encode(std::string* raw, MarshallingScheme marshalling_scheme,
-                          const std::string& identifier, const std::string& body)
+inline void zeromq_packet_encode(std::string* raw, MarshallingScheme marshalling_scheme,
+                                 const std::string& identifier, const std::string& body)
 {
     *raw = zeromq_packet_make_header(marshalling_scheme, identifier);
     *raw += body;
 }
 
-/// \brief Decodes a packet for Goby over ZeroMQ
-void zeromq_packet_decode(const std::string& raw, MarshallingScheme* marshalling_scheme,
-                          std::string* identifier, std::string* body)
+/// \brief Decodes a packet for Goby over ZeroMQ without copying
+///
+/// \param data Packet bytes (e.g. zmq_msg_data())
+/// \param size Size of `data`
+/// \param marshalling_scheme Set to the marshalling scheme of the packet
+/// \param identifier Set to a view of the identifier within `data`
+/// \param body Set to a view of the body within `data`
+///
+/// The views are only valid as long as `data` is.
+inline void zeromq_packet_decode(const char* data, std::size_t size,
+                                 MarshallingScheme* marshalling_scheme,
+                                 boost::string_ref* identifier, boost::string_ref* body)
 {
-    // byte size of marshalling id
-    const unsigned MARSHALLING_SIZE = BITS_IN_UINT32 / BITS_IN_BYTE;
-
-    if (raw.size() < MARSHALLING_SIZE)
+    if (size < ZEROMQ_PACKET_MARSHALLING_SIZE)
         throw(std::runtime_error("Message is too small"));
 
     google::protobuf::uint32 marshalling_int = 0;
-    for (int i = 0, n = MARSHALLING_SIZE; i < n; ++i)
+    for (int i = 0, n = ZEROMQ_PACKET_MARSHALLING_SIZE; i < n; ++i)
     {
         marshalling_int <<= BITS_IN_BYTE;
-        marshalling_int ^= raw[i];
+        marshalling_int ^= static_cast<unsigned char>(data[i]);
     }
 
     if (marshalling_int >= MARSHALLING_UNKNOWN && marshalling_int <= MARSHALLING_MAX)
@@ -79,11 +108,28 @@ void zeromq_packet_decode(const std::string& raw, MarshallingScheme* marshalling
         throw(std::runtime_error(ss.str()));
     }
 
-    *identifier = raw.substr(MARSHALLING_SIZE, raw.find('\0', MARSHALLING_SIZE) - MARSHALLING_SIZE);
+    const char* identifier_begin = data + ZEROMQ_PACKET_MARSHALLING_SIZE;
+    const char* identifier_end = static_cast<const char*>(
+        std::memchr(identifier_begin, '\0', size - ZEROMQ_PACKET_MARSHALLING_SIZE));
+
+    if (!identifier_end)
+        throw(std::runtime_error("Message identifier is not null terminated"));
+
+    *identifier = boost::string_ref(identifier_begin, identifier_end - identifier_begin);
 
     // +1 for null terminator
-    const int HEADER_SIZE = MARSHALLING_SIZE + identifier->size() + 1;
-    *body = raw.substr(HEADER_SIZE);
+    const char* body_begin = identifier_end + 1;
+    *body = boost::string_ref(body_begin, data + size - body_begin);
+}
+
+/// \brief Decodes a packet for Goby over ZeroMQ
+inline void zeromq_packet_decode(const std::string& raw, MarshallingScheme* marshalling_scheme,
+                                 std::string* identifier, std::string* body)
+{
+    boost::string_ref identifier_ref, body_ref;
+    zeromq_packet_decode(raw.data(), raw.size(), marshalling_scheme, &identifier_ref, &body_ref);
+    identifier->assign(identifier_ref.data(), identifier_ref.size());
+    body->assign(body_ref.data(), body_ref.size());
 }
 } // namespace common
 } // namespace goby
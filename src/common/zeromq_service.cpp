@@ -39,18 +39,29 @@ using namespace goby::common::logger;
 #define zmq_msg_recv(msg, sock, opt) zmq_recv(sock, msg, opt)
 #define ZMQ_POLL_DIVISOR 1 //  zmq_poll is usec
 #define more_t int64_t
+#define ZMQ_DONTWAIT ZMQ_NOBLOCK
 #else
 #define more_t int
 #define ZMQ_POLL_DIVISOR 1000 //  zmq_poll is msec
 #endif
 
 goby::common::ZeroMQService::ZeroMQService(boost::shared_ptr<zmq::context_t> context)
-    : context_(context)
+    : context_(context), pending_marshalling_scheme_(MARSHALLING_UNKNOWN), io_thread_quit_(false),
+      app_waiting_(false), io_waiting_(false), inbox_received_(0), inbox_dropped_(0),
+      outbox_sent_(0), outbox_dropped_(0), latency_identifiers_(0), latency_identifier_limit_(0),
+      latency_untracked_(0)
 {
     init();
 }
 
-goby::common::ZeroMQService::ZeroMQService() : context_(new zmq::context_t(2)) { init(); }
+goby::common::ZeroMQService::ZeroMQService()
+    : context_(new zmq::context_t(2)), pending_marshalling_scheme_(MARSHALLING_UNKNOWN),
+      io_thread_quit_(false), app_waiting_(false), io_waiting_(false), inbox_received_(0),
+      inbox_dropped_(0), outbox_sent_(0), outbox_dropped_(0), latency_identifiers_(0),
+      latency_identifier_limit_(0), latency_untracked_(0)
+{
+    init();
+}
 
 void goby::common::ZeroMQService::init()
 {
@@ -60,6 +71,9 @@ void goby::common::ZeroMQService::init()
 
 void goby::common::ZeroMQService::process_cfg(const protobuf::ZeroMQServiceConfig& cfg)
 {
+    if (io_thread_)
+        throw(goby::Exception("Cannot configure sockets while the I/O thread is running"));
+
     for (int i = 0, n = cfg.socket_size(); i < n; ++i)
     {
         if (!sockets_.count(cfg.socket(i).socket_id()))
@@ -81,8 +95,9 @@ void goby::common::ZeroMQService::process_cfg(const protobuf::ZeroMQServiceConfi
             }
         }
 
-        boost::shared_ptr<zmq::socket_t> this_socket =
-            socket_from_id(cfg.socket(i).socket_id()).socket();
+        ZeroMQSocket& this_zeromq_socket = socket_from_id(cfg.socket(i).socket_id());
+        this_zeromq_socket.set_framing(cfg.socket(i).framing());
+        boost::shared_ptr<zmq::socket_t> this_socket = this_zeromq_socket.socket();
 
         if (cfg.socket(i).connect_or_bind() == protobuf::ZeroMQServiceConfig::Socket::CONNECT)
         {
@@ -174,6 +189,7 @@ void goby::common::ZeroMQService::process_cfg(const protobuf::ZeroMQServiceConfi
 
 goby::common::ZeroMQService::~ZeroMQService()
 {
+    stop_io_thread();
     //    std::cout << "ZeroMQService: " << this << ": destroyed" << std::endl;
     //    std::cout << "poll_mutex " << &poll_mutex_ << std::endl;
 }
@@ -207,12 +223,34 @@ goby::common::ZeroMQSocket& goby::common::ZeroMQService::socket_from_id(int sock
 
 void goby::common::ZeroMQService::subscribe_all(int socket_id)
 {
-    socket_from_id(socket_id).socket()->setsockopt(ZMQ_SUBSCRIBE, 0, 0);
+    set_subscription(ZMQ_SUBSCRIBE, std::string(), socket_id);
 }
 
 void goby::common::ZeroMQService::unsubscribe_all(int socket_id)
 {
-    socket_from_id(socket_id).socket()->setsockopt(ZMQ_UNSUBSCRIBE, 0, 0);
+    set_subscription(ZMQ_UNSUBSCRIBE, std::string(), socket_id);
+}
+
+void goby::common::ZeroMQService::set_subscription(int option, const std::string& zmq_filter,
+                                                   int socket_id)
+{
+    if (outbox_)
+    {
+        // throws for an invalid socket_id before queuing
+        socket_from_id(socket_id);
+
+        // unlike packets, subscription changes are never dropped
+        QueuedPacket* packet = outbox_back(true);
+        packet->socket_id = socket_id;
+        packet->sockopt = option;
+        packet->body = zmq_filter;
+        outbox_push();
+    }
+    else
+    {
+        socket_from_id(socket_id).socket()->setsockopt(option, zmq_filter.data(),
+                                                       zmq_filter.size());
+    }
 }
 
 void goby::common::ZeroMQService::subscribe(MarshallingScheme marshalling_scheme,
@@ -223,8 +261,7 @@ void goby::common::ZeroMQService::subscribe(MarshallingScheme marshalling_scheme
     std::string zmq_filter = zeromq_packet_make_header(marshalling_scheme, identifier);
     int NULL_TERMINATOR_SIZE = 1;
     zmq_filter.resize(zmq_filter.size() - NULL_TERMINATOR_SIZE);
-    socket_from_id(socket_id).socket()->setsockopt(ZMQ_SUBSCRIBE, zmq_filter.c_str(),
-                                                   zmq_filter.size());
+    set_subscription(ZMQ_SUBSCRIBE, zmq_filter, socket_id);
 
     glog.is(DEBUG1) && glog << group(glog_in_group()) << "subscribed for marshalling "
                             << marshalling_scheme << " with identifier: [" << identifier
@@ -240,8 +277,7 @@ void goby::common::ZeroMQService::unsubscribe(MarshallingScheme marshalling_sche
     std::string zmq_filter = zeromq_packet_make_header(marshalling_scheme, identifier);
     int NULL_TERMINATOR_SIZE = 1;
     zmq_filter.resize(zmq_filter.size() - NULL_TERMINATOR_SIZE);
-    socket_from_id(socket_id).socket()->setsockopt(ZMQ_UNSUBSCRIBE, zmq_filter.c_str(),
-                                                   zmq_filter.size());
+    set_subscription(ZMQ_UNSUBSCRIBE, zmq_filter, socket_id);
 
     glog.is(DEBUG1) && glog << group(glog_in_group()) << "unsubscribed for marshalling "
                             << marshalling_scheme << " with identifier: [" << identifier
@@ -255,64 +291,244 @@ void goby::common::ZeroMQService::send(MarshallingScheme marshalling_scheme,
 {
     pre_send_hooks(marshalling_scheme, identifier, socket_id);
 
-    std::string raw;
-    zeromq_packet_encode(&raw, marshalling_scheme, identifier, body);
+    if (outbox_)
+    {
+        socket_from_id(socket_id);
+        if (QueuedPacket* packet = outbox_back(false))
+        {
+            packet->marshalling_scheme = marshalling_scheme;
+            packet->socket_id = socket_id;
+            packet->sockopt = 0;
+            packet->identifier = identifier;
+            packet->body = body;
+            outbox_push();
+            post_send_hooks(marshalling_scheme, identifier, socket_id);
+        }
+        // otherwise dropped (and counted) by outbox_back(), so not sent
+        return;
+    }
+
+    send_packet(marshalling_scheme, identifier, body, socket_id);
+    post_send_hooks(marshalling_scheme, identifier, socket_id);
+}
+
+void goby::common::ZeroMQService::send(MarshallingScheme marshalling_scheme,
+                                       const std::string& identifier,
+                                       const google::protobuf::MessageLite& body, int socket_id)
+{
+    pre_send_hooks(marshalling_scheme, identifier, socket_id);
+
+    if (outbox_)
+    {
+        socket_from_id(socket_id);
+        if (QueuedPacket* packet = outbox_back(false))
+        {
+            packet->marshalling_scheme = marshalling_scheme;
+            packet->socket_id = socket_id;
+            packet->sockopt = 0;
+            packet->identifier = identifier;
+            // reuses the capacity of the queue slot
+            body.SerializeToString(&packet->body);
+            outbox_push();
+            post_send_hooks(marshalling_scheme, identifier, socket_id);
+        }
+        // otherwise dropped (and counted) by outbox_back(), so not sent
+        return;
+    }
+
+#if GOOGLE_PROTOBUF_VERSION >= 3001000
+    const std::size_t body_size = body.ByteSizeLong();
+#else
+    const int body_size = body.ByteSize();
+#endif
+    if (socket_from_id(socket_id).framing() ==
+        protobuf::ZeroMQServiceConfig::Socket::HEADER_BODY_FRAMES)
+    {
+        send_header(marshalling_scheme, identifier, socket_id);
+        zmq::message_t msg(body_size);
+        // computing body_size above caches the sizes
+        body.SerializeWithCachedSizesToArray(static_cast<google::protobuf::uint8*>(msg.data()));
+        send_message(msg, socket_id);
+    }
+    else
+    {
+        zmq::message_t msg(zeromq_packet_header_size(identifier) + body_size);
+        char* body_begin = zeromq_packet_write_header(static_cast<char*>(msg.data()),
+                                                      marshalling_scheme, identifier);
+        body.SerializeWithCachedSizesToArray(
+            reinterpret_cast<google::protobuf::uint8*>(body_begin));
+        send_message(msg, socket_id);
+    }
+
+    post_send_hooks(marshalling_scheme, identifier, socket_id);
+}
+
+void goby::common::ZeroMQService::send_packet(MarshallingScheme marshalling_scheme,
+                                              const std::string& identifier,
+                                              boost::string_ref body, int socket_id)
+{
+    if (socket_from_id(socket_id).framing() ==
+        protobuf::ZeroMQServiceConfig::Socket::HEADER_BODY_FRAMES)
+    {
+        send_header(marshalling_scheme, identifier, socket_id);
+        zmq::message_t msg(body.size());
+        memcpy(msg.data(), body.data(), body.size());
+        send_message(msg, socket_id);
+    }
+    else
+    {
+        // write the packet directly into the message buffer
+        zmq::message_t msg(zeromq_packet_header_size(identifier) + body.size());
+        char* body_begin = zeromq_packet_write_header(static_cast<char*>(msg.data()),
+                                                      marshalling_scheme, identifier);
+        memcpy(body_begin, body.data(), body.size());
+        send_message(msg, socket_id);
+    }
+}
 
-    zmq::message_t msg(raw.size());
-    memcpy(msg.data(), raw.c_str(), raw.size()); // insert packet
+void goby::common::ZeroMQService::send_header(MarshallingScheme marshalling_scheme,
+                                              const std::string& identifier, int socket_id)
+{
+    zmq::message_t header(zeromq_packet_header_size(identifier));
+    zeromq_packet_write_header(static_cast<char*>(header.data()), marshalling_scheme, identifier);
+    send_message(header, socket_id, ZMQ_SNDMORE);
+}
 
+void goby::common::ZeroMQService::send_message(zmq::message_t& msg, int socket_id, int flags)
+{
     glog.is(DEBUG3) &&
         glog << group(glog_out_group()) << "Sent message (hex): "
              << hex_encode(std::string(static_cast<const char*>(msg.data()), msg.size()))
              << std::endl;
-    socket_from_id(socket_id).socket()->send(msg);
-
-    post_send_hooks(marshalling_scheme, identifier, socket_id);
+    socket_from_id(socket_id).socket()->send(msg, flags);
 }
 
 void goby::common::ZeroMQService::handle_receive(const void* data, int size, int message_part,
                                                  int socket_id)
 {
-    std::string bytes(static_cast<const char*>(data), size);
-
-    glog.is(DEBUG3) && glog << group(glog_in_group())
-                            << "Received message (hex): " << goby::util::hex_encode(bytes)
+    glog.is(DEBUG3) && glog << group(glog_in_group()) << "Received message (hex): "
+                            << goby::util::hex_encode(
+                                   std::string(static_cast<const char*>(data), size))
                             << std::endl;
 
-    MarshallingScheme marshalling_scheme = MARSHALLING_UNKNOWN;
-    std::string identifier;
-    std::string body;
-
     switch (message_part)
     {
         case 0:
         {
-            zeromq_packet_decode(bytes, &marshalling_scheme, &identifier, &body);
+            MarshallingScheme marshalling_scheme = MARSHALLING_UNKNOWN;
+            boost::string_ref identifier;
+            boost::string_ref body;
+            zeromq_packet_decode(static_cast<const char*>(data), size, &marshalling_scheme,
+                                 &identifier, &body);
 
-            glog.is(DEBUG3) && glog << group(glog_in_group()) << "Received message of type: ["
-                                    << identifier << "]" << std::endl;
-
-            glog.is(DEBUG3) && glog << group(glog_in_group()) << "Body ["
-                                    << goby::util::hex_encode(body) << "]" << std::endl;
+            more_t more = 0;
+            size_t more_size = sizeof(more_t);
+            socket_from_id(socket_id).socket()->getsockopt(ZMQ_RCVMORE, &more, &more_size);
 
-            if (socket_from_id(socket_id).check_blackout(marshalling_scheme, identifier))
+            if (more)
+            {
+                // HEADER_BODY_FRAMES: the body is the next frame
+                pending_marshalling_scheme_ = marshalling_scheme;
+                pending_identifier_.assign(identifier.data(), identifier.size());
+            }
+            else
             {
-                inbox_signal_(marshalling_scheme, identifier, body, socket_id);
+                receive(marshalling_scheme, identifier, body, socket_id);
             }
         }
         break;
 
+        case 1:
+            receive(pending_marshalling_scheme_, pending_identifier_,
+                    boost::string_ref(static_cast<const char*>(data), size), socket_id);
+            break;
+
         default:
             throw(std::runtime_error(
-                "Got more parts to the message than expecting (expecting only 1)"));
+                "Got more parts to the message than expecting (expecting header and body)"));
             break;
     }
 }
 
+void goby::common::ZeroMQService::receive(MarshallingScheme marshalling_scheme,
+                                          boost::string_ref identifier, boost::string_ref body,
+                                          int socket_id)
+{
+    // inbox_ is only set (and reset) while the I/O thread is not running
+    if (!inbox_)
+    {
+        deliver(marshalling_scheme, identifier, body, socket_id);
+        return;
+    }
+
+    ++inbox_received_;
+    QueuedPacket* packet = inbox_->back();
+    if (!packet)
+    {
+        ++inbox_dropped_;
+        glog.is(DEBUG1) && glog << group(glog_in_group()) << warn
+                                << "I/O thread inbox is full, dropping message of type: ["
+                                << identifier << "]" << std::endl;
+        return;
+    }
+
+    packet->marshalling_scheme = marshalling_scheme;
+    packet->socket_id = socket_id;
+    packet->identifier.assign(identifier.data(), identifier.size());
+    packet->body.assign(body.data(), body.size());
+    packet->time = goby_time();
+    inbox_->push();
+
+    if (app_waiting_.exchange(false))
+        wake(*inbox_wake_send_);
+}
+
+void goby::common::ZeroMQService::deliver(MarshallingScheme marshalling_scheme,
+                                          boost::string_ref identifier, boost::string_ref body,
+                                          int socket_id)
+{
+    glog.is(DEBUG3) && glog << group(glog_in_group()) << "Received message of type: ["
+                            << identifier << "]" << std::endl;
+
+    glog.is(DEBUG3) && glog << group(glog_in_group()) << "Body ["
+                            << goby::util::hex_encode(body.to_string()) << "]" << std::endl;
+
+    ZeroMQSocket& socket = socket_from_id(socket_id);
+    if (!socket.blackout_set() ||
+        socket.check_blackout(marshalling_scheme, identifier.to_string()))
+    {
+        inbox_view_signal_(marshalling_scheme, identifier, body, socket_id);
+
+        // compatibility layer for slots that require owning strings
+        if (!inbox_signal_.empty())
+            inbox_signal_(marshalling_scheme, identifier.to_string(), body.to_string(), socket_id);
+    }
+}
+
 bool goby::common::ZeroMQService::poll(long timeout /* = -1 */)
 {
     boost::mutex::scoped_lock slock(poll_mutex_);
 
+    if (inbox_)
+    {
+        bool had_events = drain_inbox();
+        if (!had_events && timeout != 0)
+        {
+            // set before checking the inbox so that the I/O thread either sees we are waiting
+            // or we see its packet
+            app_waiting_ = true;
+            if (inbox_->empty())
+            {
+                zmq::pollitem_t item = {(void*)*inbox_wake_recv_, 0, ZMQ_POLLIN, 0};
+                zmq::poll(&item, 1, timeout / ZMQ_POLL_DIVISOR);
+            }
+            app_waiting_ = false;
+            clear_wake(*inbox_wake_recv_);
+            had_events = drain_inbox();
+        }
+        return had_events;
+    }
+
     //    glog.is(DEBUG2) && glog << "Have " << poll_items_.size() << " items to poll" << std::endl ;
     bool had_events = false;
     zmq::poll(&poll_items_[0], poll_items_.size(), timeout / ZMQ_POLL_DIVISOR);
@@ -320,49 +536,298 @@ bool goby::common::ZeroMQService::poll(long timeout /* = -1 */)
     {
         if (poll_items_[i].revents & ZMQ_POLLIN)
         {
-            int message_part = 0;
-            more_t more;
-            size_t more_size = sizeof(more_t);
-            do
+            receive_poll_item(i);
+            had_events = true;
+        }
+    }
+    return had_events;
+}
+
+void goby::common::ZeroMQService::receive_poll_item(int i)
+{
+    int message_part = 0;
+    more_t more;
+    size_t more_size = sizeof(more_t);
+    do
+    {
+        /* Create an empty ØMQ message to hold the message part */
+        zmq_msg_t part;
+        int rc = zmq_msg_init(&part);
+
+        if (rc == -1)
+        {
+            glog.is(DEBUG1) && glog << warn << "zmq_msg_init failed" << std::endl;
+            continue;
+        }
+
+        /* Block until a message is available to be received from socket */
+        rc = zmq_msg_recv(&part, poll_items_[i].socket, 0);
+        glog.is(DEBUG3) && glog << group(glog_in_group()) << "Had event for poll item " << i
+                                << std::endl;
+        poll_callbacks_[i](zmq_msg_data(&part), zmq_msg_size(&part), message_part);
+
+        if (rc == -1)
+        {
+            glog.is(DEBUG1) && glog << warn << "zmq_recv failed" << std::endl;
+            continue;
+        }
+
+        /* Determine if more message parts are to follow */
+        rc = zmq_getsockopt(poll_items_[i].socket, ZMQ_RCVMORE, &more, &more_size);
+
+        if (rc == -1)
+        {
+            glog.is(DEBUG1) && glog << warn << "zmq_getsocketopt failed" << std::endl;
+            continue;
+        }
+
+        zmq_msg_close(&part);
+        ++message_part;
+    } while (more);
+}
+
+bool goby::common::ZeroMQService::drain_inbox()
+{
+    bool had_events = false;
+    while (QueuedPacket* packet = inbox_->front())
+    {
+        had_events = true;
+        boost::posix_time::ptime start = goby_time();
+        deliver(packet->marshalling_scheme, packet->identifier, packet->body, packet->socket_id);
+        boost::posix_time::ptime end = goby_time();
+
+        std::map<std::string, LatencyStats>& scheme_stats =
+            latency_stats_[packet->marshalling_scheme];
+        std::map<std::string, LatencyStats>::iterator stats_it =
+            scheme_stats.find(packet->identifier);
+        if (stats_it == scheme_stats.end() && latency_identifiers_ < latency_identifier_limit_)
+        {
+            stats_it =
+                scheme_stats.insert(std::make_pair(packet->identifier, LatencyStats())).first;
+            ++latency_identifiers_;
+        }
+
+        if (stats_it != scheme_stats.end())
+        {
+            LatencyStats& stats = stats_it->second;
+            double queue_latency = (start - packet->time).total_microseconds() / 1.0e6;
+            double handler_time = (end - start).total_microseconds() / 1.0e6;
+            ++stats.count;
+            stats.total_queue_latency += queue_latency;
+            stats.max_queue_latency = std::max(stats.max_queue_latency, queue_latency);
+            stats.total_handler_time += handler_time;
+            stats.max_handler_time = std::max(stats.max_handler_time, handler_time);
+        }
+        else
+        {
+            ++latency_untracked_;
+        }
+
+        inbox_->pop();
+    }
+    return had_events;
+}
+
+void goby::common::ZeroMQService::start_io_thread(const protobuf::ZeroMQIOThreadConfig& cfg)
+{
+    if (io_thread_)
+        return;
+
+    // glog is now written to from both threads
+    glog.set_lock_action(goby::common::logger_lock::lock);
+
+    inbox_.reset(new SPSCRingBuffer<QueuedPacket>(cfg.inbox_capacity()));
+    outbox_.reset(new SPSCRingBuffer<QueuedPacket>(cfg.outbox_capacity()));
+
+    latency_stats_.clear();
+    latency_identifiers_ = 0;
+    latency_identifier_limit_ = cfg.max_latency_identifiers();
+    latency_untracked_ = 0;
+
+    const std::string endpoint_base =
+        "inproc://goby::common::ZeroMQService::" + as<std::string>(this);
+    inbox_wake_recv_.reset(new zmq::socket_t(*context_, ZMQ_PAIR));
+    inbox_wake_recv_->bind((endpoint_base + "::inbox_wake").c_str());
+    inbox_wake_send_.reset(new zmq::socket_t(*context_, ZMQ_PAIR));
+    inbox_wake_send_->connect((endpoint_base + "::inbox_wake").c_str());
+    outbox_wake_recv_.reset(new zmq::socket_t(*context_, ZMQ_PAIR));
+    outbox_wake_recv_->bind((endpoint_base + "::outbox_wake").c_str());
+    outbox_wake_send_.reset(new zmq::socket_t(*context_, ZMQ_PAIR));
+    outbox_wake_send_->connect((endpoint_base + "::outbox_wake").c_str());
+
+    io_thread_quit_ = false;
+    io_thread_.reset(
+        new boost::thread(boost::bind(&goby::common::ZeroMQService::io_thread_run, this)));
+
+    glog.is(DEBUG1) && glog << group(glog_out_group()) << "Started I/O thread: "
+                            << cfg.ShortDebugString() << std::endl;
+}
+
+void goby::common::ZeroMQService::stop_io_thread()
+{
+    if (!io_thread_)
+        return;
+
+    io_thread_quit_ = true;
+    wake(*outbox_wake_send_);
+    io_thread_->join();
+    io_thread_.reset();
+
+    inbox_.reset();
+    outbox_.reset();
+    inbox_wake_send_.reset();
+    inbox_wake_recv_.reset();
+    outbox_wake_send_.reset();
+    outbox_wake_recv_.reset();
+}
+
+void goby::common::ZeroMQService::io_thread_status(protobuf::ZeroMQIOThreadStatus* status) const
+{
+    if (inbox_)
+    {
+        status->set_inbox_depth(inbox_->size());
+        status->set_inbox_capacity(inbox_->capacity());
+    }
+    status->set_inbox_received(inbox_received_);
+    status->set_inbox_dropped(inbox_dropped_);
+
+    if (outbox_)
+    {
+        status->set_outbox_depth(outbox_->size());
+        status->set_outbox_capacity(outbox_->capacity());
+    }
+    status->set_outbox_sent(outbox_sent_);
+    status->set_outbox_dropped(outbox_dropped_);
+    status->set_latency_untracked(latency_untracked_);
+
+    for (std::map<MarshallingScheme, std::map<std::string, LatencyStats> >::const_iterator
+             scheme_it = latency_stats_.begin(),
+             scheme_end = latency_stats_.end();
+         scheme_it != scheme_end; ++scheme_it)
+    {
+        for (std::map<std::string, LatencyStats>::const_iterator it = scheme_it->second.begin(),
+                                                                  end = scheme_it->second.end();
+             it != end; ++it)
+        {
+            const LatencyStats& stats = it->second;
+            protobuf::ZeroMQIOThreadStatus::HandlerLatency* latency =
+                status->add_handler_latency();
+            latency->set_marshalling_scheme(scheme_it->first);
+            latency->set_identifier(it->first);
+            latency->set_count(stats.count);
+            if (stats.count)
             {
-                /* Create an empty ØMQ message to hold the message part */
-                zmq_msg_t part;
-                int rc = zmq_msg_init(&part);
+                latency->set_mean_queue_latency(stats.total_queue_latency / stats.count);
+                latency->set_mean_handler_time(stats.total_handler_time / stats.count);
+            }
+            latency->set_max_queue_latency(stats.max_queue_latency);
+            latency->set_max_handler_time(stats.max_handler_time);
+        }
+    }
+}
 
-                if (rc == -1)
-                {
-                    glog.is(DEBUG1) && glog << warn << "zmq_msg_init failed" << std::endl;
-                    continue;
-                }
+goby::common::ZeroMQService::QueuedPacket* goby::common::ZeroMQService::outbox_back(bool block)
+{
+    QueuedPacket* packet = outbox_->back();
+    while (!packet && block)
+    {
+        if (io_waiting_.exchange(false))
+            wake(*outbox_wake_send_);
+        boost::this_thread::yield();
+        packet = outbox_->back();
+    }
 
-                /* Block until a message is available to be received from socket */
-                rc = zmq_msg_recv(&part, poll_items_[i].socket, 0);
-                glog.is(DEBUG3) && glog << group(glog_in_group()) << "Had event for poll item " << i
-                                        << std::endl;
-                poll_callbacks_[i](zmq_msg_data(&part), zmq_msg_size(&part), message_part);
+    if (!packet)
+    {
+        ++outbox_dropped_;
+        glog.is(DEBUG1) && glog << group(glog_out_group()) << warn
+                                << "I/O thread outbox is full, dropping outgoing message"
+                                << std::endl;
+    }
+    return packet;
+}
 
-                if (rc == -1)
-                {
-                    glog.is(DEBUG1) && glog << warn << "zmq_recv failed" << std::endl;
-                    continue;
-                }
+void goby::common::ZeroMQService::outbox_push()
+{
+    outbox_->push();
+    if (io_waiting_.exchange(false))
+        wake(*outbox_wake_send_);
+}
+
+void goby::common::ZeroMQService::wake(zmq::socket_t& socket)
+{
+    // if a wake message is already pending, this one is not needed
+    zmq::message_t msg(0);
+    socket.send(msg, ZMQ_DONTWAIT);
+}
+
+void goby::common::ZeroMQService::clear_wake(zmq::socket_t& socket)
+{
+    zmq::message_t msg;
+    while (socket.recv(&msg, ZMQ_DONTWAIT)) {}
+}
+
+void goby::common::ZeroMQService::io_thread_run()
+{
+    // bounds the time to notice io_thread_quit_ if the wake message is lost
+    const long idle_timeout = 100000; // microseconds
 
-                /* Determine if more message parts are to follow */
-                rc = zmq_getsockopt(poll_items_[i].socket, ZMQ_RCVMORE, &more, &more_size);
+    std::vector<zmq::pollitem_t> items(poll_items_);
+    zmq::pollitem_t wake_item = {(void*)*outbox_wake_recv_, 0, ZMQ_POLLIN, 0};
+    items.push_back(wake_item);
 
-                if (rc == -1)
+    while (!io_thread_quit_)
+    {
+        try
+        {
+            // set before checking the outbox so that the application thread either sees we are
+            // waiting or we see its packet
+            io_waiting_ = true;
+            zmq::poll(&items[0], items.size(),
+                      (outbox_->empty() ? idle_timeout : 0) / ZMQ_POLL_DIVISOR);
+            io_waiting_ = false;
+
+            if (items.back().revents & ZMQ_POLLIN)
+                clear_wake(*outbox_wake_recv_);
+
+            for (int i = 0, n = poll_items_.size(); i < n; ++i)
+            {
+                if (items[i].revents & ZMQ_POLLIN)
+                    receive_poll_item(i);
+            }
+
+        }
+        catch (std::exception& e)
+        {
+            glog.is(WARN) && glog << warn << "ZeroMQService I/O thread: " << e.what()
+                                  << std::endl;
+        }
+
+        while (QueuedPacket* packet = outbox_->front())
+        {
+            try
+            {
+                if (packet->sockopt)
                 {
-                    glog.is(DEBUG1) && glog << warn << "zmq_getsocketopt failed" << std::endl;
-                    continue;
+                    socket_from_id(packet->socket_id)
+                        .socket()
+                        ->setsockopt(packet->sockopt, packet->body.data(), packet->body.size());
                 }
-
-                zmq_msg_close(&part);
-                ++message_part;
-            } while (more);
-            had_events = true;
+                else
+                {
+                    send_packet(packet->marshalling_scheme, packet->identifier, packet->body,
+                                packet->socket_id);
+                    ++outbox_sent_;
+                }
+            }
+            catch (std::exception& e)
+            {
+                glog.is(WARN) && glog << warn << "ZeroMQService I/O thread: " << e.what()
+                                      << std::endl;
+            }
+            outbox_->pop();
         }
     }
-    return had_events;
 }
 
 void goby::common::ZeroMQSocket::set_global_blackout(boost::posix_time::time_duration duration)
@@ -23,10 +23,14 @@
 #ifndef ZEROMQNODE20110413H
 #define ZEROMQNODE20110413H
 
+#include <boost/atomic.hpp>
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/signals2.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <iostream>
 #include <string>
 
@@ -35,7 +39,9 @@
 #include <zmq.hpp>
 
 #include "core_constants.h"
+#include "goby/common/exception.h"
 #include "goby/common/logger.h"
+#include "spsc_ring_buffer.h"
 
 namespace goby
 {
@@ -46,13 +52,15 @@ class ZeroMQSocket
   public:
     ZeroMQSocket()
         : global_blackout_(boost::posix_time::not_a_date_time), local_blackout_set_(false),
-          global_blackout_set_(false)
+          global_blackout_set_(false),
+          framing_(protobuf::ZeroMQServiceConfig::Socket::SINGLE_FRAME)
     {
     }
 
     ZeroMQSocket(boost::shared_ptr<zmq::socket_t> socket)
         : socket_(socket), global_blackout_(boost::posix_time::not_a_date_time),
-          local_blackout_set_(false), global_blackout_set_(false)
+          local_blackout_set_(false), global_blackout_set_(false),
+          framing_(protobuf::ZeroMQServiceConfig::Socket::SINGLE_FRAME)
     {
     }
 
@@ -71,6 +79,9 @@ class ZeroMQSocket
         global_blackout_set_ = false;
     }
 
+    // true if any (global or local) blackout has been set on this socket
+    bool blackout_set() const { return local_blackout_set_ || global_blackout_set_; }
+
     // true means go ahead and post this message
     // false means in blackout
     bool check_blackout(MarshallingScheme marshalling_scheme, const std::string& identifier);
@@ -79,6 +90,12 @@ class ZeroMQSocket
 
     boost::shared_ptr<zmq::socket_t>& socket() { return socket_; }
 
+    void set_framing(protobuf::ZeroMQServiceConfig::Socket::Framing framing)
+    {
+        framing_ = framing;
+    }
+    protobuf::ZeroMQServiceConfig::Socket::Framing framing() const { return framing_; }
+
   private:
     struct BlackoutInfo
     {
@@ -97,6 +114,9 @@ class ZeroMQSocket
     bool local_blackout_set_;
     bool global_blackout_set_;
     std::map<std::pair<MarshallingScheme, std::string>, BlackoutInfo> blackout_info_;
+
+    // framing used for sending
+    protobuf::ZeroMQServiceConfig::Socket::Framing framing_;
 };
 
 class ZeroMQService
@@ -106,12 +126,14 @@ class ZeroMQService
     ZeroMQService(boost::shared_ptr<zmq::context_t> context);
     virtual ~ZeroMQService();
 
+    /// \brief Configure the sockets. Not permitted once the I/O thread has been started.
     void set_cfg(const protobuf::ZeroMQServiceConfig& cfg)
     {
         process_cfg(cfg);
         cfg_.CopyFrom(cfg);
     }
 
+    /// \brief Configure additional sockets. Not permitted once the I/O thread has been started.
     void merge_cfg(const protobuf::ZeroMQServiceConfig& cfg)
     {
         process_cfg(cfg);
@@ -124,6 +146,10 @@ class ZeroMQService
     void send(MarshallingScheme marshalling_scheme, const std::string& identifier,
               const std::string& body, int socket_id);
 
+    /// \brief Send a Protobuf message, serializing it directly into the outgoing ZeroMQ message buffer (avoids the intermediate copies of the std::string body overload)
+    void send(MarshallingScheme marshalling_scheme, const std::string& identifier,
+              const google::protobuf::MessageLite& body, int socket_id);
+
     void subscribe(MarshallingScheme marshalling_scheme, const std::string& identifier,
                    int socket_id);
 
@@ -148,14 +174,62 @@ class ZeroMQService
         inbox_signal_.connect(slot);
     }
 
+    /// \brief Connect a slot that receives non-owning views of the identifier and body of each incoming packet
+    ///
+    /// The views point directly into the received ZeroMQ message and are only valid for the duration of the call, so the slot must copy anything it wishes to keep. Unlike connect_inbox_slot(), no copies of the packet are made to deliver the message.
+    template <class C>
+    void connect_inbox_view_slot(void (C::*mem_func)(MarshallingScheme, boost::string_ref,
+                                                     boost::string_ref, int),
+                                 C* obj)
+    {
+        goby::glog.is(goby::common::logger::DEBUG1) &&
+            goby::glog << "ZeroMQService: made (view) connection for: " << typeid(obj).name()
+                       << std::endl;
+        connect_inbox_view_slot(boost::bind(mem_func, obj, _1, _2, _3, _4));
+    }
+
+    void connect_inbox_view_slot(
+        boost::function<void(MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+                             boost::string_ref body, int socket_id)>
+            slot)
+    {
+        inbox_view_signal_.connect(slot);
+    }
+
+    /// \brief Wait up to `timeout` microseconds (-1 is forever) for incoming packets and call
+    /// the inbox slots for them
+    ///
+    /// If the I/O thread is running, this drains the packets it has queued instead of reading
+    /// the sockets directly.
+    /// \return true if any packets were handled
     bool poll(long timeout = -1);
     void close_all()
     {
+        stop_io_thread();
         sockets_.clear();
         poll_items_.clear();
         poll_callbacks_.clear();
     }
 
+    /// \name Dedicated I/O thread
+    //@{
+    /// \brief Start a background thread that owns all the sockets.
+    ///
+    /// Received packets are read by the I/O thread and queued for the thread calling poll(),
+    /// which is where the inbox slots are called. send(), subscribe() and unsubscribe() queue
+    /// their work for the I/O thread. Both queues are bounded lock-free single producer / single
+    /// consumer queues, so once started, poll(), send(), subscribe() and unsubscribe() must all
+    /// be called from the same (application) thread. Callbacks added with register_poll_item()
+    /// are called from the I/O thread. The sockets must be fully configured (set_cfg() /
+    /// merge_cfg()) before starting.
+    void start_io_thread(const protobuf::ZeroMQIOThreadConfig& cfg);
+    /// \brief Stop and join the I/O thread (if running). Packets still queued are discarded.
+    void stop_io_thread();
+    bool io_thread_running() const { return io_thread_.get() != 0; }
+    /// \brief Queue depths, drop counts and per identifier handler latency for the I/O thread
+    void io_thread_status(protobuf::ZeroMQIOThreadStatus* status) const;
+    //@}
+
     ZeroMQSocket& socket_from_id(int socket_id);
 
     template <class C>
@@ -169,6 +243,9 @@ class ZeroMQService
     register_poll_item(const zmq::pollitem_t& item,
                        boost::function<void(const void* data, int size, int message_part)> callback)
     {
+        if (io_thread_)
+            throw(goby::Exception("Cannot register poll items while the I/O thread is running"));
+
         poll_items_.push_back(item);
         poll_callbacks_.insert(std::make_pair(poll_items_.size() - 1, callback));
     }
@@ -206,6 +283,47 @@ class ZeroMQService
 
     void handle_receive(const void* data, int size, int message_part, int socket_id);
 
+    // receive all the parts of a message waiting on poll_items_[i]
+    void receive_poll_item(int i);
+
+    // deliver directly, or queue for the application thread if the I/O thread is running
+    void receive(MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+                 boost::string_ref body, int socket_id);
+
+    void deliver(MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+                 boost::string_ref body, int socket_id);
+
+    void send_packet(MarshallingScheme marshalling_scheme, const std::string& identifier,
+                     boost::string_ref body, int socket_id);
+    void send_header(MarshallingScheme marshalling_scheme, const std::string& identifier,
+                     int socket_id);
+    void send_message(zmq::message_t& msg, int socket_id, int flags = 0);
+
+    void set_subscription(int option, const std::string& zmq_filter, int socket_id);
+
+    // I/O thread
+    struct QueuedPacket
+    {
+        QueuedPacket() : marshalling_scheme(MARSHALLING_UNKNOWN), socket_id(0), sockopt(0) {}
+
+        MarshallingScheme marshalling_scheme;
+        int socket_id;
+        // if non-zero, the body is the value for setsockopt() rather than a packet to send
+        int sockopt;
+        std::string identifier;
+        std::string body;
+        // time received by the I/O thread
+        boost::posix_time::ptime time;
+    };
+
+    // 0 if the outbox is full, unless block is true, in which case wait for room
+    QueuedPacket* outbox_back(bool block);
+    void outbox_push();
+    void io_thread_run();
+    bool drain_inbox();
+    void wake(zmq::socket_t& socket);
+    void clear_wake(zmq::socket_t& socket);
+
     int socket_type(protobuf::ZeroMQServiceConfig::Socket::SocketType type);
 
   private:
@@ -223,7 +341,50 @@ class ZeroMQService
                                  const std::string& identifier, const std::string& body,
                                  int socket_id)>
         inbox_signal_;
+    boost::signals2::signal<void(MarshallingScheme marshalling_scheme,
+                                 boost::string_ref identifier, boost::string_ref body,
+                                 int socket_id)>
+        inbox_view_signal_;
     boost::mutex poll_mutex_;
+
+    // header of a HEADER_BODY_FRAMES packet, held until the body frame arrives
+    MarshallingScheme pending_marshalling_scheme_;
+    std::string pending_identifier_;
+
+    // I/O thread
+    boost::scoped_ptr<boost::thread> io_thread_;
+    boost::atomic<bool> io_thread_quit_;
+    // I/O thread -> application thread
+    boost::scoped_ptr<SPSCRingBuffer<QueuedPacket> > inbox_;
+    // application thread -> I/O thread
+    boost::scoped_ptr<SPSCRingBuffer<QueuedPacket> > outbox_;
+
+    // inproc PAIR sockets used to wake a waiting consumer when its queue becomes non-empty
+    boost::shared_ptr<zmq::socket_t> inbox_wake_send_, inbox_wake_recv_;
+    boost::shared_ptr<zmq::socket_t> outbox_wake_send_, outbox_wake_recv_;
+    boost::atomic<bool> app_waiting_, io_waiting_;
+
+    boost::atomic<google::protobuf::uint64> inbox_received_, inbox_dropped_;
+    boost::atomic<google::protobuf::uint64> outbox_sent_, outbox_dropped_;
+
+    struct LatencyStats
+    {
+        LatencyStats() : count(0), total_queue_latency(0), max_queue_latency(0),
+                         total_handler_time(0), max_handler_time(0)
+        {
+        }
+
+        google::protobuf::uint64 count;
+        double total_queue_latency;
+        double max_queue_latency;
+        double total_handler_time;
+        double max_handler_time;
+    };
+    // key = marshalling scheme, then identifier; at most latency_identifier_limit_ identifiers
+    std::map<MarshallingScheme, std::map<std::string, LatencyStats> > latency_stats_;
+    unsigned latency_identifiers_;
+    unsigned latency_identifier_limit_;
+    google::protobuf::uint64 latency_untracked_;
 };
 } // namespace common
 } // namespace goby
@@ -24,6 +24,7 @@
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 #include <boost/math/special_functions/fpclassify.hpp> // for isnan
+#include <stdexcept>
 
 #include "goby/common/logger.h"
 #include "goby/util/as.h"
@@ -36,6 +37,7 @@ namespace gpb = goby::moos::protobuf;
 using goby::glog;
 using goby::common::goby_time;
 using goby::util::NMEASentence;
+using goby::util::NMEATokenizer;
 using namespace goby::common::logger;
 using namespace goby::common::tcolor;
 
@@ -427,8 +429,8 @@ void BluefinFrontSeat::try_receive()
         // try to handle the received message, posting appropriate signals
         try
         {
-            NMEASentence nmea(in, NMEASentence::VALIDATE);
-            process_receive(nmea);
+            nmea_in_.parse(in, NMEASentence::VALIDATE);
+            process_receive(nmea_in_);
         }
         catch (std::exception& e)
         {
@@ -547,7 +549,8 @@ void BluefinFrontSeat::write(const NMEASentence& nmea)
 {
     gpb::FrontSeatRaw raw_msg;
     raw_msg.set_raw(nmea.message());
-    raw_msg.set_description(description_map_[nmea.front()]);
+    const std::string* description = description_map_.find(nmea.front());
+    raw_msg.set_description(description ? *description : std::string());
 
     signal_raw_to_frontseat(raw_msg);
 
@@ -564,18 +567,26 @@ void BluefinFrontSeat::write(const NMEASentence& nmea)
     }
 }
 
-void BluefinFrontSeat::process_receive(const NMEASentence& nmea)
+void BluefinFrontSeat::process_receive(const NMEATokenizer& nmea_in)
 {
     gpb::FrontSeatRaw raw_msg;
-    raw_msg.set_raw(nmea.message());
-    raw_msg.set_description(description_map_[nmea.front()]);
+    nmea_in.message_cs(raw_msg.mutable_raw());
+    const std::string* description = description_map_.find(nmea_in.front());
+    raw_msg.set_description(description ? *description : std::string());
 
     signal_raw_from_frontseat(raw_msg);
 
     nmea_demerits_ = 0;
 
+    const SentenceIDs* sentence_id = sentence_id_index_.find(nmea_in.sentence_id());
+    if (!sentence_id)
+        throw std::out_of_range("Unknown sentence id: " + nmea_in.sentence_id().str());
+
+    nmea_in.to_sentence(&nmea_in_sentence_);
+    const NMEASentence& nmea = nmea_in_sentence_;
+
     // look at the sentence id (last three characters of the NMEA 0183 talker)
-    switch (sentence_id_map_.left.at(nmea.sentence_id()))
+    switch (*sentence_id)
     {
         case ACK: bfack(nmea); break; // nmea ack
 
@@ -632,6 +643,12 @@ void BluefinFrontSeat::load_nmea_mappings()
         "SPD", SPD)("SAN", SAN)("GHP", GHP)("GBP", GBP)("RNS", RNS)("RBO", RBO)("CMA", CMA)(
         "NVR", NVR)("TEL", TEL)("CTL", CTL)("DCL", DCL);
 
+    for (boost::bimap<std::string, SentenceIDs>::left_const_iterator it =
+             sentence_id_map_.left.begin(),
+             end = sentence_id_map_.left.end();
+         it != end; ++it)
+        sentence_id_index_.insert(it->first, it->second);
+
     boost::assign::insert(talker_id_map_)("BF", BF)("BP", BP);
 
     boost::assign::insert(description_map_)("$BFMSC", "Payload Mission Command")(
@@ -25,7 +25,9 @@
 
 #include <boost/bimap.hpp>
 
+#include "goby/util/linebasedcomms/nmea_id_map.h"
 #include "goby/util/linebasedcomms/nmea_sentence.h"
+#include "goby/util/linebasedcomms/nmea_tokenizer.h"
 #include "goby/util/linebasedcomms/tcp_client.h"
 
 #include "goby/moos/frontseat/frontseat.h"
@@ -64,7 +66,7 @@ class BluefinFrontSeat : public FrontSeatInterfaceBase
     void try_send();
     void try_receive();
     void write(const goby::util::NMEASentence& nmea);
-    void process_receive(const goby::util::NMEASentence& nmea);
+    void process_receive(const goby::util::NMEATokenizer& nmea);
 
     void bfack(const goby::util::NMEASentence& nmea);
     void bfnvr(const goby::util::NMEASentence& nmea);
@@ -102,6 +104,10 @@ class BluefinFrontSeat : public FrontSeatInterfaceBase
 
     double last_heartbeat_time_;
 
+    // reused for each incoming line
+    goby::util::NMEATokenizer nmea_in_;
+    goby::util::NMEASentence nmea_in_sentence_;
+
     enum TalkerIDs
     {
         TALKER_NOT_DEFINED = 0,
@@ -180,7 +186,9 @@ class BluefinFrontSeat : public FrontSeatInterfaceBase
 
     std::map<std::string, TalkerIDs> talker_id_map_;
     boost::bimap<std::string, SentenceIDs> sentence_id_map_;
-    std::map<std::string, std::string> description_map_;
+    // copy of sentence_id_map_.left for dispatching incoming sentences
+    goby::util::NMEAIDMap<SentenceIDs> sentence_id_index_;
+    goby::util::NMEAIDMap<std::string> description_map_;
 
     // the current status message we're building up
     goby::moos::protobuf::NodeStatus status_;
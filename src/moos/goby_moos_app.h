@@ -25,6 +25,7 @@
 
 #include "goby/moos/moos_header.h"
 #include "goby/moos/moos_translator.h"
+#include "goby/moos/moos_wildcard_index.h"
 #include "goby/util/as.h"
 
 #include <boost/algorithm/string.hpp>
@@ -33,6 +34,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/function.hpp>
 #include <boost/signals2.hpp>
+#include <boost/thread/mutex.hpp>
 #include <map>
 
 #include "dynamic_moos_vars.h"
@@ -103,7 +105,11 @@ template <class MOOSAppType = MOOSAppShell> class GobyMOOSAppSelector : public M
         glog.is(goby::common::logger::DEBUG2) && glog << cfg->DebugString() << std::endl;
     }
 
-    virtual ~GobyMOOSAppSelector() {}
+    virtual ~GobyMOOSAppSelector()
+    {
+        // write out any queued lines before fout_ is closed
+        goby::glog.disable_async();
+    }
 
     template <typename ProtobufMessage>
     void publish_pb(const std::string& key, const ProtobufMessage& msg)
@@ -139,6 +145,9 @@ template <class MOOSAppType = MOOSAppShell> class GobyMOOSAppSelector : public M
     goby::moos::DynamicMOOSVars& dynamic_vars() { return dynamic_vars_; }
     double start_time() const { return start_time_; }
 
+    /// \brief Held while the MOOS callbacks (including loop() and all mail handlers) run. Lock it before calling into this application from any other thread.
+    boost::mutex& app_mutex() { return app_mutex_; }
+
     void subscribe(const std::string& var, InboxFunc handler = InboxFunc(), int blackout = 0);
 
     template <typename V, typename A1>
@@ -265,6 +274,11 @@ template <class MOOSAppType = MOOSAppShell> class GobyMOOSAppSelector : public M
              boost::shared_ptr<boost::signals2::signal<void(const CMOOSMsg& msg)> > >
         wildcard_mail_handlers_;
 
+    // same signals as wildcard_mail_handlers_, indexed for matching incoming mail
+    goby::moos::MOOSWildcardIndex<
+        boost::shared_ptr<boost::signals2::signal<void(const CMOOSMsg& msg)> > >
+        wildcard_index_;
+
     // CMOOSApp::OnConnectToServer()
     bool connected_;
     // CMOOSApp::OnStartUp()
@@ -297,6 +311,8 @@ template <class MOOSAppType = MOOSAppShell> class GobyMOOSAppSelector : public M
 
     bool dynamic_moos_vars_enabled_;
 
+    boost::mutex app_mutex_;
+
     static int argc_;
     static char** argv_;
     static std::string mission_file_;
@@ -321,6 +337,7 @@ template <class MOOSAppType> char** GobyMOOSAppSelector<MOOSAppType>::argv_ = 0;
 
 template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::Iterate()
 {
+    boost::mutex::scoped_lock lock(app_mutex_);
     MOOSAppType::Iterate();
 
     if (!configuration_read_)
@@ -375,6 +392,8 @@ template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::Iterate()
 
 template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::OnNewMail(MOOSMSG_LIST& NewMail)
 {
+    boost::mutex::scoped_lock lock(app_mutex_);
+
     // for AppCasting (otherwise no-op)
     MOOSAppType::OnNewMail(NewMail);
 
@@ -396,20 +415,23 @@ template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::OnNewMail(MO
                 goby::glog << "ignoring normal mail from " << msg.GetKey()
                            << " from before we started (dynamics still updated)" << std::endl;
         }
-        else if (mail_handlers_.count(msg.GetKey()))
-            (*mail_handlers_[msg.GetKey()])(msg);
-
-        for (std::map<
-                 std::pair<std::string, std::string>,
-                 boost::shared_ptr<boost::signals2::signal<void(const CMOOSMsg&msg)> > >::iterator
-                 it = wildcard_mail_handlers_.begin(),
-                 end = wildcard_mail_handlers_.end();
-             it != end; ++it)
+        else
         {
-            if (MOOSWildCmp(it->first.first, msg.GetKey()) &&
-                MOOSWildCmp(it->first.second, msg.GetSource()))
-                (*(it->second))(msg);
+            typename std::map<std::string, boost::shared_ptr<boost::signals2::signal<void(
+                                               const CMOOSMsg& msg)> > >::const_iterator
+                handler_it = mail_handlers_.find(msg.GetKey());
+            if (handler_it != mail_handlers_.end())
+                (*handler_it->second)(msg);
         }
+
+        typedef std::vector<boost::shared_ptr<boost::signals2::signal<void(const CMOOSMsg& msg)> > >
+            WildcardHandlers;
+        const WildcardHandlers& wildcard_handlers =
+            wildcard_index_.match(msg.GetKey(), msg.GetSource());
+        for (typename WildcardHandlers::const_iterator handler_it = wildcard_handlers.begin(),
+                                                       handler_end = wildcard_handlers.end();
+             handler_it != handler_end; ++handler_it)
+            (**handler_it)(msg);
     }
 
     return true;
@@ -417,6 +439,7 @@ template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::OnNewMail(MO
 
 template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::OnDisconnectFromServer()
 {
+    boost::mutex::scoped_lock lock(app_mutex_);
     std::cout << MOOSAppType::m_MissionReader.GetAppName() << ", disconnected from server."
               << std::endl;
     connected_ = false;
@@ -432,6 +455,7 @@ template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::OnDisconnect
 
 template <class MOOSAppType> bool GobyMOOSAppSelector<MOOSAppType>::OnConnectToServer()
 {
+    boost::mutex::scoped_lock lock(app_mutex_);
     std::cout << MOOSAppType::m_MissionReader.GetAppName() << ", connected to server." << std::endl;
     connected_ = true;
     try_subscribing();
@@ -508,9 +532,12 @@ void GobyMOOSAppSelector<MOOSAppType>::subscribe(const std::string& var_pattern,
     try_subscribing();
 
     if (!wildcard_mail_handlers_.count(key))
-        wildcard_mail_handlers_.insert(std::make_pair(
-            key, boost::shared_ptr<boost::signals2::signal<void(const CMOOSMsg& msg)> >(
-                     new boost::signals2::signal<void(const CMOOSMsg& msg)>)));
+    {
+        boost::shared_ptr<boost::signals2::signal<void(const CMOOSMsg& msg)> > signal(
+            new boost::signals2::signal<void(const CMOOSMsg& msg)>);
+        wildcard_mail_handlers_.insert(std::make_pair(key, signal));
+        wildcard_index_.insert(key, signal);
+    }
 
     if (handler)
         wildcard_mail_handlers_[key]->connect(handler);
@@ -942,6 +969,9 @@ template <class MOOSAppType> void GobyMOOSAppSelector<MOOSAppType>::process_conf
         }
     }
 
+    if (common_cfg_.async_log())
+        goby::glog.enable_async(common_cfg_.async_log_queue_size());
+
     if (common_cfg_.has_moos_parser_technique())
         goby::moos::moos_technique = common_cfg_.moos_parser_technique();
     else if (common_cfg_.has_use_binary_protobuf())
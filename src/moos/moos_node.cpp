@@ -39,7 +39,7 @@ goby::moos::MOOSNode::MOOSNode(ZeroMQService* service)
 }
 
 void goby::moos::MOOSNode::inbox(common::MarshallingScheme marshalling_scheme,
-                                 const std::string& identifier, const std::string& bytes,
+                                 boost::string_ref identifier, boost::string_ref body,
                                  int socket_id)
 {
     glog.is(DEBUG2) && glog << group("in_hex")
@@ -47,29 +47,51 @@ void goby::moos::MOOSNode::inbox(common::MarshallingScheme marshalling_scheme,
 
     if (marshalling_scheme == goby::common::MARSHALLING_MOOS)
     {
-        boost::shared_ptr<CMOOSMsg> msg(new CMOOSMsg);
-
-        glog.is(DEBUG2) && glog << group("in_hex") << goby::util::hex_encode(bytes) << std::endl;
-        MOOSSerializer::parse(msg.get(), bytes);
-
-        const std::string& key = msg->GetKey();
-        newest_vars[key] = msg;
-        moos_inbox(*msg);
+        glog.is(DEBUG2) && glog << group("in_hex")
+                                << goby::util::hex_encode(std::string(body.data(), body.size()))
+                                << std::endl;
+
+        // send() uses "CMOOSMsg/KEY/", so we can parse straight into the newest_vars entry
+        const boost::string_ref prefix("CMOOSMsg/");
+        if (identifier.size() > prefix.size() + 1 && identifier.starts_with(prefix) &&
+            identifier.ends_with('/'))
+        {
+            key_.assign(identifier.data() + prefix.size(), identifier.size() - prefix.size() - 1);
+            CMOOSMsg& msg = newest_entry(key_);
+            MOOSSerializer::parse(&msg, body.data(), body.size());
+            moos_inbox(msg);
+        }
+        else
+        {
+            MOOSSerializer::parse(&parse_msg_, body.data(), body.size());
+            CMOOSMsg& msg = newest_entry(parse_msg_.GetKey());
+            msg = parse_msg_;
+            moos_inbox(msg);
+        }
     }
 }
 
+CMOOSMsg& goby::moos::MOOSNode::newest_entry(const std::string& key)
+{
+    std::map<std::string, CMOOSMsg>::iterator it = newest_vars.lower_bound(key);
+    if (it == newest_vars.end() || newest_vars.key_comp()(key, it->first))
+        it = newest_vars.insert(it, std::make_pair(key, CMOOSMsg()));
+    return it->second;
+}
+
 void goby::moos::MOOSNode::send(const CMOOSMsg& msg, int socket_id, const std::string& group_unused)
 {
-    std::string bytes;
-    MOOSSerializer::serialize(msg, &bytes);
+    const std::string& bytes = serializer_.serialize(msg);
 
     glog.is(DEBUG1) && glog << "Sent: "
                             << "CMOOSMsg/" << msg.GetKey() << "/" << std::endl;
 
     glog.is(DEBUG2) && glog << group("out_hex") << goby::util::hex_encode(bytes) << std::endl;
 
-    zeromq_service()->send(goby::common::MARSHALLING_MOOS, "CMOOSMsg/" + msg.GetKey() + "/", bytes,
-                           socket_id);
+    identifier_.assign("CMOOSMsg/");
+    identifier_.append(msg.GetKey());
+    identifier_.push_back('/');
+    zeromq_service()->send(goby::common::MARSHALLING_MOOS, identifier_, bytes, socket_id);
 }
 
 void goby::moos::MOOSNode::subscribe(const std::string& full_or_partial_moos_name, int socket_id)
@@ -114,10 +136,7 @@ void goby::moos::MOOSNode::unsubscribe(const std::string& full_or_partial_moos_n
 
 CMOOSMsg& goby::moos::MOOSNode::newest(const std::string& key)
 {
-    if (!newest_vars.count(key))
-        newest_vars[key] = boost::shared_ptr<CMOOSMsg>(new CMOOSMsg);
-
-    return *newest_vars[key];
+    return newest_entry(key);
 }
 
 std::vector<CMOOSMsg> goby::moos::MOOSNode::newest_substr(const std::string& substring)
@@ -135,19 +154,21 @@ std::vector<CMOOSMsg> goby::moos::MOOSNode::newest_substr(const std::string& sub
         }
         else
         {
-            if (newest_vars.count(trimmed_substring))
-                out.push_back(*newest_vars[trimmed_substring]);
+            std::map<std::string, CMOOSMsg>::const_iterator it =
+                newest_vars.find(trimmed_substring);
+            if (it != newest_vars.end())
+                out.push_back(it->second);
             return out;
         }
     }
 
-    for (std::map<std::string, boost::shared_ptr<CMOOSMsg> >::const_iterator
-             it = newest_vars.begin(),
+    for (std::map<std::string, CMOOSMsg>::const_iterator
+             it = newest_vars.lower_bound(trimmed_substring),
              end = newest_vars.end();
-         it != end; ++it)
+         it != end && it->first.compare(0, trimmed_substring.size(), trimmed_substring) == 0;
+         ++it)
     {
-        if (!size || it->first.compare(0, trimmed_substring.size(), trimmed_substring) == 0)
-            out.push_back(*(it->second));
+        out.push_back(it->second);
     }
     return out;
 }
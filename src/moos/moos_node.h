@@ -50,15 +50,27 @@ class MOOSNode : public goby::common::NodeInterface<CMOOSMsg>
     std::vector<CMOOSMsg> newest_substr(const std::string& substring);
 
   protected:
+    using goby::common::NodeInterface<CMOOSMsg>::inbox;
+
     // not const because CMOOSMsg requires mutable for many const calls...
     virtual void moos_inbox(CMOOSMsg& msg) = 0;
 
   private:
-    void inbox(goby::common::MarshallingScheme marshalling_scheme, const std::string& identifier,
-               const std::string& body, int socket_id);
+    void inbox(goby::common::MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+               boost::string_ref body, int socket_id);
+
+    // finds or creates the newest_vars entry for key
+    CMOOSMsg& newest_entry(const std::string& key);
 
   private:
-    std::map<std::string, boost::shared_ptr<CMOOSMsg> > newest_vars;
+    // entries are updated in place on receipt, so references from newest() remain valid
+    std::map<std::string, CMOOSMsg> newest_vars;
+
+    // reused between calls to avoid per-message allocations
+    MOOSSerializer serializer_;
+    std::string identifier_;
+    std::string key_;
+    CMOOSMsg parse_msg_;
 };
 } // namespace moos
 } // namespace goby
@@ -824,35 +824,448 @@ template <> class MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>
         int index;
     };
 
+    /// \brief One step of a compiled format: a literal run or a field reference
+    struct Token
+    {
+        enum Type
+        {
+            LITERAL,
+            FIELD,
+            BAD_SPECIFIER
+        };
+
+        Token() : type(LITERAL), field(0), index(0), is_indexed(false), terminator('\0') {}
+
+        Type type;
+        /// LITERAL: the text itself; otherwise the specifier as written (without '%')
+        std::string text;
+        /// embedded messages to descend through before reaching `field` (index is -1 if not given)
+        std::vector<RepeatedFieldKey> path;
+        int field;
+        int index;
+        bool is_indexed;
+        /// parse only: the format character that ends this field's value ('\0' at the end)
+        char terminator;
+    };
+
+    /// \brief A TECHNIQUE_FORMAT format string scanned once, so each message only walks the tokens
+    struct Program
+    {
+        Program() : compiled(false), generated_fields(0) {}
+
+        std::string format;
+        std::vector<Token> tokens;
+        /// false if `format` uses boost::format directives other than %N%, %N.M%, %N:M% and %%,
+        /// in which case serialize() falls back to boost::format
+        bool compiled;
+        /// number of indexed or embedded field references (each takes an extra argument slot)
+        int generated_fields;
+    };
+
+    static Program compile_serializer(const std::string& format)
+    {
+        Program program;
+        program.format = format;
+
+        std::string literal;
+        for (std::string::size_type i = 0, n = format.size(); i < n;)
+        {
+            if (format[i] != '%')
+            {
+                literal += format[i++];
+                continue;
+            }
+            else if (i + 1 < n && format[i + 1] == '%')
+            {
+                literal += '%';
+                i += 2;
+                continue;
+            }
+
+            std::string::size_type close = format.find('%', i + 1);
+            Token token;
+            token.type = Token::FIELD;
+            if (close == std::string::npos ||
+                !parse_specifier(format.substr(i + 1, close - i - 1), &token))
+            {
+                program.tokens.clear();
+                return program;
+            }
+
+            if (!literal.empty())
+            {
+                Token literal_token;
+                literal_token.text.swap(literal);
+                program.tokens.push_back(literal_token);
+            }
+
+            if (token.is_indexed || !token.path.empty())
+                ++program.generated_fields;
+            program.tokens.push_back(token);
+            i = close + 1;
+        }
+
+        if (!literal.empty())
+        {
+            Token literal_token;
+            literal_token.text = literal;
+            program.tokens.push_back(literal_token);
+        }
+
+        program.compiled = true;
+        return program;
+    }
+
+    static Program compile_parser(const std::string& format)
+    {
+        Program program;
+        program.format = boost::to_lower_copy(format);
+        const std::string& lower_format = program.format;
+
+        std::string literal;
+        for (std::string::size_type i = 0, n = lower_format.size(); i < n;)
+        {
+            if (lower_format[i] != '%')
+            {
+                literal += lower_format[i++];
+                continue;
+            }
+
+            if (!literal.empty())
+            {
+                Token literal_token;
+                literal_token.text.swap(literal);
+                program.tokens.push_back(literal_token);
+            }
+
+            std::string::size_type close = lower_format.find('%', i + 1);
+            if (close == std::string::npos)
+                close = n;
+
+            Token token;
+            token.type = Token::FIELD;
+            token.text = lower_format.substr(i + 1, close - i - 1);
+            i = std::min(close + 1, n);
+            token.terminator = (i < n) ? lower_format[i] : '\0';
+
+            std::vector<std::string> subfields;
+            boost::split(subfields, token.text, boost::is_any_of(":"));
+            for (int j = 0, m = subfields.size() - 1; j < m; ++j)
+            {
+                std::vector<std::string> field_and_index;
+                boost::split(field_and_index, subfields[j], boost::is_any_of("."));
+
+                RepeatedFieldKey key;
+                key.field = goby::util::as<int>(field_and_index[0]);
+                key.index =
+                    (field_and_index.size() == 2) ? goby::util::as<int>(field_and_index[1]) : -1;
+                token.path.push_back(key);
+            }
+
+            try
+            {
+                std::vector<std::string> field_and_index;
+                boost::split(field_and_index, subfields.back(), boost::is_any_of("."));
+
+                token.field = boost::lexical_cast<int>(field_and_index[0]);
+                token.is_indexed = field_and_index.size() == 2;
+                if (token.is_indexed)
+                    token.index = boost::lexical_cast<int>(field_and_index[1]);
+            }
+            catch (boost::bad_lexical_cast&)
+            {
+                token.type = Token::BAD_SPECIFIER;
+            }
+
+            program.tokens.push_back(token);
+        }
+
+        if (!literal.empty())
+        {
+            Token literal_token;
+            literal_token.text = literal;
+            program.tokens.push_back(literal_token);
+        }
+
+        program.compiled = true;
+        return program;
+    }
+
+    static void serialize(std::string* out, const google::protobuf::Message& in,
+                          const google::protobuf::RepeatedPtrField<
+                              protobuf::TranslatorEntry::PublishSerializer::Algorithm>& algorithms,
+                          const Program& program, const std::string& repeated_delimiter,
+                          bool use_short_enum = false)
+    {
+        if (!program.compiled)
+        {
+            serialize_boost_format(out, in, algorithms, program.format, repeated_delimiter,
+                                   use_short_enum);
+            return;
+        }
+
+        // run algorithms
+        std::map<int, std::string> modified_values = run_serialize_algorithms(in, algorithms);
+
+        // fields past the last argument boost::format would have been fed are left empty
+        const int max_top_level_argument =
+            max_argument(in, modified_values) + program.generated_fields;
+
+        std::ostringstream os;
+        for (std::vector<Token>::const_iterator it = program.tokens.begin(),
+                                                end = program.tokens.end();
+             it != end; ++it)
+        {
+            const Token& token = *it;
+            if (token.type == Token::LITERAL)
+            {
+                os << token.text;
+            }
+            else if (token.path.empty())
+            {
+                serialize_field(os, in, modified_values, token, max_top_level_argument,
+                                repeated_delimiter, use_short_enum);
+            }
+            else
+            {
+                const google::protobuf::Message* sub_message = &in;
+                for (int i = 0, n = token.path.size(); i < n; ++i)
+                {
+                    const google::protobuf::FieldDescriptor* field_desc =
+                        sub_message->GetDescriptor()->FindFieldByNumber(token.path[i].field);
+                    if (!field_desc || field_desc->cpp_type() !=
+                                           google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE)
+                    {
+                        throw(std::runtime_error(
+                            "Invalid ':' syntax given for format: " + token.text +
+                            ". All field indices except the last must be embedded messages"));
+                    }
+                    if (field_desc->is_repeated() && token.path[i].index < 0)
+                    {
+                        throw(std::runtime_error(
+                            "Invalid '.' syntax given for format: " + token.text +
+                            ". Repeated message, but no valid index given. E.g., "
+                            "use '3.4' for index 4 of field 3."));
+                    }
+
+                    const google::protobuf::Reflection* sub_refl = sub_message->GetReflection();
+                    sub_message = (field_desc->is_repeated())
+                                      ? &sub_refl->GetRepeatedMessage(*sub_message, field_desc,
+                                                                      token.path[i].index)
+                                      : &sub_refl->GetMessage(*sub_message, field_desc);
+                }
+
+                // algorithms only matter for virtual fields of the embedded message, or for
+                // fields numbered past its last declared argument
+                std::map<int, std::string> sub_modified_values;
+                int sub_max_argument = max_argument(*sub_message, sub_modified_values);
+                if (!sub_message->GetDescriptor()->FindFieldByNumber(token.field) ||
+                    token.field > sub_max_argument)
+                {
+                    sub_modified_values = run_serialize_algorithms(*sub_message, algorithms);
+                    sub_max_argument = max_argument(*sub_message, sub_modified_values);
+                }
+
+                serialize_field(os, *sub_message, sub_modified_values, token,
+                                sub_max_argument + (token.is_indexed ? 1 : 0), repeated_delimiter,
+                                use_short_enum);
+            }
+        }
+
+        *out = os.str();
+    }
+
     static void serialize(std::string* out, const google::protobuf::Message& in,
                           const google::protobuf::RepeatedPtrField<
                               protobuf::TranslatorEntry::PublishSerializer::Algorithm>& algorithms,
                           const std::string& format, const std::string& repeated_delimiter,
                           bool use_short_enum = false)
     {
-        std::string mutable_format = format;
+        serialize(out, in, algorithms, compile_serializer(format), repeated_delimiter,
+                  use_short_enum);
+    }
 
-        const google::protobuf::Descriptor* desc = in.GetDescriptor();
-        const google::protobuf::Reflection* refl = in.GetReflection();
+    static void parse(const std::string& in, google::protobuf::Message* out,
+                      const Program& program, const std::string& repeated_delimiter,
+                      const google::protobuf::RepeatedPtrField<
+                          protobuf::TranslatorEntry::CreateParser::Algorithm>& algorithms,
+                      bool use_short_enum = false)
+    {
+        std::string lower_str = boost::to_lower_copy(in);
 
-        int max_field_number = 1;
-        for (int i = 1, n = desc->field_count(); i < n; ++i)
+        // start of the unconsumed part of `in`
+        std::string::size_type pos = 0;
+        for (std::vector<Token>::const_iterator it = program.tokens.begin(),
+                                                end = program.tokens.end();
+             it != end; ++it)
         {
-            const google::protobuf::FieldDescriptor* field_desc = desc->field(i);
-            if (field_desc->number() > max_field_number)
-                max_field_number = field_desc->number();
+            const Token& token = *it;
+            if (token.type == Token::LITERAL)
+            {
+                // each literal character consumes the input up to and including its next occurrence
+                for (std::string::const_iterator c = token.text.begin(), c_end = token.text.end();
+                     c != c_end; ++c)
+                {
+                    std::string::size_type found = lower_str.find(*c, pos);
+                    if (found != std::string::npos)
+                        pos = found + 1;
+                }
+                continue;
+            }
+
+            std::string::size_type value_end = lower_str.find(token.terminator, pos);
+            std::string extract =
+                in.substr(pos, value_end == std::string::npos ? value_end : value_end - pos);
+
+            google::protobuf::Message* sub_message = out;
+            for (int i = 0, n = token.path.size(); i < n; ++i)
+            {
+                const google::protobuf::FieldDescriptor* field_desc =
+                    sub_message->GetDescriptor()->FindFieldByNumber(token.path[i].field);
+                if (!field_desc ||
+                    field_desc->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE)
+                {
+                    throw(std::runtime_error(
+                        "Invalid ':' syntax given for format: " + token.text +
+                        ". All field indices except the last must be singular embedded "
+                        "messages"));
+                }
+
+                const google::protobuf::Reflection* sub_refl = sub_message->GetReflection();
+                if (field_desc->is_repeated())
+                {
+                    int index = token.path[i].index;
+                    if (index < 0)
+                        throw(std::runtime_error(
+                            "Invalid '.' syntax given for format: " + token.text +
+                            ". Repeated message, but no valid index given. E.g., use '3.4' "
+                            "for index 4 of field 3."));
+                    while (sub_refl->FieldSize(*sub_message, field_desc) <= index)
+                        sub_refl->AddMessage(sub_message, field_desc);
+                    sub_message = sub_refl->MutableRepeatedMessage(sub_message, field_desc, index);
+                }
+                else
+                {
+                    sub_message = sub_refl->MutableMessage(sub_message, field_desc);
+                }
+            }
+
+            const google::protobuf::Descriptor* desc = sub_message->GetDescriptor();
+            const std::string specifier = token.text.substr(token.text.rfind(':') + 1);
+            if (token.type == Token::BAD_SPECIFIER)
+                throw(std::runtime_error("Bad specifier: " + specifier +
+                                         ", must be an integer. For message: " +
+                                         desc->full_name()));
+
+            const google::protobuf::FieldDescriptor* field_desc =
+                desc->FindFieldByNumber(token.field);
+            if (!field_desc)
+                throw(std::runtime_error("Bad field: " + specifier + " not in message " +
+                                         desc->full_name()));
+
+            // run algorithms
+            typedef google::protobuf::RepeatedPtrField<
+                protobuf::TranslatorEntry::CreateParser::Algorithm>::const_iterator const_iterator;
+
+            for (const_iterator alg_it = algorithms.begin(), alg_end = algorithms.end();
+                 alg_it != alg_end; ++alg_it)
+            {
+                goby::transitional::DCCLMessageVal extract_val(extract);
+
+                if (alg_it->primary_field() == token.field)
+                    transitional::DCCLAlgorithmPerformer::getInstance()->run_algorithm(
+                        alg_it->name(), extract_val,
+                        std::vector<goby::transitional::DCCLMessageVal>());
+
+                extract = std::string(extract_val);
+            }
+
+            parse_field(extract, sub_message, field_desc, token.is_indexed, token.index,
+                        repeated_delimiter, use_short_enum);
         }
+    }
 
-        // run algorithms
-        std::map<int, std::string> modified_values = run_serialize_algorithms(in, algorithms);
+    static void parse(const std::string& in, google::protobuf::Message* out, std::string format,
+                      const std::string& repeated_delimiter,
+                      const google::protobuf::RepeatedPtrField<
+                          protobuf::TranslatorEntry::CreateParser::Algorithm>& algorithms =
+                          google::protobuf::RepeatedPtrField<
+                              protobuf::TranslatorEntry::CreateParser::Algorithm>(),
+                      bool use_short_enum = false)
+    {
+        parse(in, out, compile_parser(format), repeated_delimiter, algorithms, use_short_enum);
+    }
 
-        for (std::map<int, std::string>::const_iterator it = modified_values.begin(),
-                                                        n = modified_values.end();
-             it != n; ++it)
+  private:
+    // accepts N, N.M and A[.I]:...:N[.M]
+    static bool parse_specifier(const std::string& specifier, Token* token)
+    {
+        token->text = specifier;
+
+        std::vector<std::string> subfields;
+        boost::split(subfields, specifier, boost::is_any_of(":"));
+        for (int i = 0, n = subfields.size(); i < n; ++i)
         {
-            if (it->first > max_field_number)
-                max_field_number = it->first;
+            std::vector<std::string> field_and_index;
+            boost::split(field_and_index, subfields[i], boost::is_any_of("."));
+            if (field_and_index.size() > 2)
+                return false;
+            for (int j = 0, m = field_and_index.size(); j < m; ++j)
+            {
+                if (field_and_index[j].empty() ||
+                    !boost::algorithm::all(field_and_index[j], boost::algorithm::is_digit()))
+                    return false;
+            }
+
+            RepeatedFieldKey key;
+            key.field = goby::util::as<int>(field_and_index[0]);
+            key.index =
+                (field_and_index.size() == 2) ? goby::util::as<int>(field_and_index[1]) : -1;
+
+            if (i + 1 < n)
+            {
+                token->path.push_back(key);
+            }
+            else
+            {
+                token->field = key.field;
+                token->is_indexed = key.index >= 0;
+                token->index = token->is_indexed ? key.index : 0;
+            }
         }
+        return true;
+    }
+
+    // largest argument number boost::format is fed for this message: the declared fields
+    // (historically skipping the first one declared) and the algorithm outputs
+    static int max_argument(const google::protobuf::Message& in,
+                            const std::map<int, std::string>& modified_values)
+    {
+        const google::protobuf::Descriptor* desc = in.GetDescriptor();
+        int max_field_number = 1;
+        for (int i = 1, n = desc->field_count(); i < n; ++i)
+            max_field_number = std::max(max_field_number, desc->field(i)->number());
+        if (!modified_values.empty())
+            max_field_number = std::max(max_field_number, modified_values.rbegin()->first);
+        return max_field_number;
+    }
+
+    // general boost::format implementation, for formats compile_serializer() does not cover
+    static void
+    serialize_boost_format(std::string* out, const google::protobuf::Message& in,
+                           const google::protobuf::RepeatedPtrField<
+                               protobuf::TranslatorEntry::PublishSerializer::Algorithm>& algorithms,
+                           const std::string& format, const std::string& repeated_delimiter,
+                           bool use_short_enum)
+    {
+        std::string mutable_format = format;
+
+        const google::protobuf::Descriptor* desc = in.GetDescriptor();
+        const google::protobuf::Reflection* refl = in.GetReflection();
+
+        // run algorithms
+        std::map<int, std::string> modified_values = run_serialize_algorithms(in, algorithms);
+        int max_field_number = max_argument(in, modified_values);
 
         std::string mutable_format_temp = mutable_format;
         for (boost::sregex_iterator it(mutable_format.begin(), mutable_format.end(),
@@ -956,163 +1369,16 @@ template <> class MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>
             {
                 if (field_desc->is_repeated())
                 {
-                    int start = (is_indexed_repeated_field) ? indexed_repeated_fields[i].index : 0;
-                    int end = (is_indexed_repeated_field) ? indexed_repeated_fields[i].index + 1
-                                                          : refl->FieldSize(in, field_desc);
-
                     std::stringstream out_repeated;
-                    for (int j = start; j < end; ++j)
-                    {
-                        if (j && !is_indexed_repeated_field)
-                            out_repeated << repeated_delimiter;
-                        switch (field_desc->cpp_type())
-                        {
-                            case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
-                                out_repeated << goby::util::hex_encode(
-                                    refl->GetRepeatedMessage(in, field_desc, j)
-                                        .SerializeAsString());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
-                                out_repeated << ((j < refl->FieldSize(in, field_desc))
-                                                     ? refl->GetRepeatedInt32(in, field_desc, j)
-                                                     : std::numeric_limits<int32>::max());
-
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
-                                out_repeated << ((j < refl->FieldSize(in, field_desc))
-                                                     ? refl->GetRepeatedInt64(in, field_desc, j)
-                                                     : std::numeric_limits<int64>::max());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
-                                out_repeated << ((j < refl->FieldSize(in, field_desc))
-                                                     ? refl->GetRepeatedUInt32(in, field_desc, j)
-                                                     : std::numeric_limits<uint32>::max());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
-                                out_repeated << ((j < refl->FieldSize(in, field_desc))
-                                                     ? refl->GetRepeatedUInt64(in, field_desc, j)
-                                                     : std::numeric_limits<uint64>::max());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
-                                out_repeated << std::boolalpha
-                                             << ((j < refl->FieldSize(in, field_desc))
-                                                     ? refl->GetRepeatedBool(in, field_desc, j)
-                                                     : field_desc->default_value_bool());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
-                                if (field_desc->type() ==
-                                    google::protobuf::FieldDescriptor::TYPE_STRING)
-                                    out_repeated
-                                        << ((j < refl->FieldSize(in, field_desc))
-                                                ? refl->GetRepeatedString(in, field_desc, j)
-                                                : field_desc->default_value_string());
-                                else if (field_desc->type() ==
-                                         google::protobuf::FieldDescriptor::TYPE_BYTES)
-                                    out_repeated << goby::util::hex_encode(
-                                        ((j < refl->FieldSize(in, field_desc))
-                                             ? refl->GetRepeatedString(in, field_desc, j)
-                                             : field_desc->default_value_string()));
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
-                                out_repeated
-                                    << std::setprecision(std::numeric_limits<float>::digits10)
-                                    << ((j < refl->FieldSize(in, field_desc))
-                                            ? refl->GetRepeatedFloat(in, field_desc, j)
-                                            : std::numeric_limits<float>::quiet_NaN());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
-                                out_repeated
-                                    << std::setprecision(std::numeric_limits<double>::digits10)
-                                    << ((j < refl->FieldSize(in, field_desc))
-                                            ? refl->GetRepeatedDouble(in, field_desc, j)
-                                            : std::numeric_limits<double>::quiet_NaN());
-                                break;
-
-                            case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
-                            {
-                                const google::protobuf::EnumValueDescriptor* enum_val =
-                                    ((j < refl->FieldSize(in, field_desc))
-                                         ? refl->GetRepeatedEnum(in, field_desc, j)
-                                         : field_desc->default_value_enum());
-                                out_repeated
-                                    << ((use_short_enum) ? strip_name_from_enum(enum_val->name(),
-                                                                                field_desc->name())
-                                                         : enum_val->name());
-                            }
-                            break;
-                        }
-                    }
+                    serialize_repeated(out_repeated, in, field_desc, is_indexed_repeated_field,
+                                       is_indexed_repeated_field ? indexed_repeated_fields[i].index
+                                                                 : 0,
+                                       repeated_delimiter, use_short_enum);
                     out_format % out_repeated.str();
                 }
                 else
                 {
-                    switch (field_desc->cpp_type())
-                    {
-                        case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
-                            out_format % goby::util::hex_encode(
-                                             refl->GetMessage(in, field_desc).SerializeAsString());
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
-                            out_format % refl->GetInt32(in, field_desc);
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
-                            out_format % refl->GetInt64(in, field_desc);
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
-                            out_format % refl->GetUInt32(in, field_desc);
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
-                            out_format % refl->GetUInt64(in, field_desc);
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
-                            out_format % goby::util::as<std::string>(refl->GetBool(in, field_desc));
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
-                            if (field_desc->type() ==
-                                google::protobuf::FieldDescriptor::TYPE_STRING)
-                                out_format % refl->GetString(in, field_desc);
-                            else if (field_desc->type() ==
-                                     google::protobuf::FieldDescriptor::TYPE_BYTES)
-                                out_format %
-                                    goby::util::hex_encode(refl->GetString(in, field_desc));
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
-                            out_format % boost::io::group(std::setprecision(
-                                                              std::numeric_limits<float>::digits10),
-                                                          refl->GetFloat(in, field_desc));
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
-                            out_format %
-                                boost::io::group(
-                                    std::setprecision(std::numeric_limits<double>::digits10),
-                                    refl->GetDouble(in, field_desc));
-                            break;
-
-                        case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
-
-                            out_format %
-                                ((use_short_enum)
-                                     ? strip_name_from_enum(refl->GetEnum(in, field_desc)->name(),
-                                                            field_desc->name())
-                                     : refl->GetEnum(in, field_desc)->name());
-                            break;
-                    }
+                    serialize_single(FormatArgument(out_format), in, field_desc, use_short_enum);
                 }
             }
             else if (mod_it != modified_values.end())
@@ -1128,370 +1394,439 @@ template <> class MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>
         *out = out_format.str();
     }
 
-    static void parse(const std::string& in, google::protobuf::Message* out, std::string format,
-                      const std::string& repeated_delimiter,
-                      const google::protobuf::RepeatedPtrField<
-                          protobuf::TranslatorEntry::CreateParser::Algorithm>& algorithms =
-                          google::protobuf::RepeatedPtrField<
-                              protobuf::TranslatorEntry::CreateParser::Algorithm>(),
-                      bool use_short_enum = false)
+    static void serialize_field(std::ostream& os, const google::protobuf::Message& in,
+                                const std::map<int, std::string>& modified_values,
+                                const Token& token, int max_argument_number,
+                                const std::string& repeated_delimiter, bool use_short_enum)
     {
-        const google::protobuf::Descriptor* desc = out->GetDescriptor();
-        const google::protobuf::Reflection* refl = out->GetReflection();
-        boost::to_lower(format);
-        std::string str = in;
-        std::string lower_str = boost::to_lower_copy(in);
+        // indexed fields always get an argument slot of their own
+        if (!token.is_indexed && token.field > max_argument_number)
+            return;
 
-        //    goby::glog.is(DEBUG1) && goby::glog << "Format: " << format << std::endl;
-        //   goby::glog.is(DEBUG1) && goby::glog << "String: " << str << std::endl;
-        //    goby::glog.is(DEBUG1) && goby::glog << "Lower String: " << lower_str << std::endl;
+        const google::protobuf::FieldDescriptor* field_desc =
+            in.GetDescriptor()->FindFieldByNumber(token.field);
 
-        std::string::const_iterator i = format.begin();
+        if (!field_desc)
+        {
+            std::map<int, std::string>::const_iterator mod_it = modified_values.find(token.field);
+            if (!token.is_indexed && mod_it != modified_values.end())
+                os << mod_it->second;
+            else
+                os << "unknown";
+        }
+        else if (field_desc->is_repeated())
+        {
+            serialize_repeated(os, in, field_desc, token.is_indexed, token.index,
+                               repeated_delimiter, use_short_enum);
+        }
+        else
+        {
+            serialize_single(StreamArgument(os), in, field_desc, use_short_enum);
+        }
+    }
+
+    // feeds one value to boost::format, keeping its type for directives such as %1$.2f
+    struct FormatArgument
+    {
+        explicit FormatArgument(boost::format& f) : format(f) {}
+        template <typename T> void operator()(const T& value) { format % value; }
+        template <typename T> void operator()(const T& value, int precision)
+        {
+            format % boost::io::group(std::setprecision(precision), value);
+        }
+        boost::format& format;
+    };
+
+    // writes one value straight to the output of a compiled format
+    struct StreamArgument
+    {
+        explicit StreamArgument(std::ostream& o) : os(o) {}
+        template <typename T> void operator()(const T& value) { os << value; }
+        template <typename T> void operator()(const T& value, int precision)
+        {
+            os << std::setprecision(precision) << value;
+        }
+        std::ostream& os;
+    };
 
-        while (i != format.end())
+    // non-repeated field, shared by the compiled and boost::format serializers
+    template <typename Sink>
+    static void serialize_single(Sink sink, const google::protobuf::Message& in,
+                                 const google::protobuf::FieldDescriptor* field_desc,
+                                 bool use_short_enum)
+    {
+        const google::protobuf::Reflection* refl = in.GetReflection();
+        switch (field_desc->cpp_type())
         {
-            if (*i == '%')
+            case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+                sink(goby::util::hex_encode(refl->GetMessage(in, field_desc).SerializeAsString()));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+                sink(refl->GetInt32(in, field_desc));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+                sink(refl->GetInt64(in, field_desc));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+                sink(refl->GetUInt32(in, field_desc));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+                sink(refl->GetUInt64(in, field_desc));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+                sink(goby::util::as<std::string>(refl->GetBool(in, field_desc)));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+                if (field_desc->type() == google::protobuf::FieldDescriptor::TYPE_STRING)
+                    sink(refl->GetString(in, field_desc));
+                else if (field_desc->type() == google::protobuf::FieldDescriptor::TYPE_BYTES)
+                    sink(goby::util::hex_encode(refl->GetString(in, field_desc)));
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+                sink(refl->GetFloat(in, field_desc), std::numeric_limits<float>::digits10);
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+                sink(refl->GetDouble(in, field_desc), std::numeric_limits<double>::digits10);
+                break;
+
+            case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+                sink((use_short_enum)
+                         ? strip_name_from_enum(refl->GetEnum(in, field_desc)->name(),
+                                                field_desc->name())
+                         : refl->GetEnum(in, field_desc)->name());
+                break;
+        }
+    }
+
+    // repeated field joined by `repeated_delimiter` (or only element `index` if `is_indexed`),
+    // shared by the compiled and boost::format serializers
+    static void serialize_repeated(std::ostream& os, const google::protobuf::Message& in,
+                                   const google::protobuf::FieldDescriptor* field_desc,
+                                   bool is_indexed, int index,
+                                   const std::string& repeated_delimiter, bool use_short_enum)
+    {
+        const google::protobuf::Reflection* refl = in.GetReflection();
+        const int size = refl->FieldSize(in, field_desc);
+        const int start = is_indexed ? index : 0;
+        const int end = is_indexed ? index + 1 : size;
+
+        for (int j = start; j < end; ++j)
+        {
+            if (j && !is_indexed)
+                os << repeated_delimiter;
+            switch (field_desc->cpp_type())
             {
-                ++i; // now *i is the conversion specifier
-                std::string specifier;
-                while (*i != '%') specifier += *i++;
+                case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+                    os << goby::util::hex_encode(
+                        refl->GetRepeatedMessage(in, field_desc, j).SerializeAsString());
+                    break;
+
+                case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+                    os << ((j < size) ? refl->GetRepeatedInt32(in, field_desc, j)
+                                      : std::numeric_limits<int32>::max());
+                    break;
+
+                case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+                    os << ((j < size) ? refl->GetRepeatedInt64(in, field_desc, j)
+                                      : std::numeric_limits<int64>::max());
+                    break;
 
-                ++i; // now *i is the next separator
-                std::string extract = str.substr(0, lower_str.find(*i));
+                case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+                    os << ((j < size) ? refl->GetRepeatedUInt32(in, field_desc, j)
+                                      : std::numeric_limits<uint32>::max());
+                    break;
 
-                if (specifier.find(":") != std::string::npos)
+                case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+                    os << ((j < size) ? refl->GetRepeatedUInt64(in, field_desc, j)
+                                      : std::numeric_limits<uint64>::max());
+                    break;
+
+                case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+                    os << std::boolalpha
+                       << ((j < size) ? refl->GetRepeatedBool(in, field_desc, j)
+                                      : field_desc->default_value_bool());
+                    break;
+
+                case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
                 {
-                    std::vector<std::string> subfields;
-                    boost::split(subfields, specifier, boost::is_any_of(":"));
-                    const google::protobuf::FieldDescriptor* field_desc = 0;
-                    const google::protobuf::Reflection* sub_refl = refl;
-                    google::protobuf::Message* sub_message = out;
+                    const std::string& value = (j < size)
+                                                   ? refl->GetRepeatedString(in, field_desc, j)
+                                                   : field_desc->default_value_string();
+                    if (field_desc->type() == google::protobuf::FieldDescriptor::TYPE_STRING)
+                        os << value;
+                    else if (field_desc->type() == google::protobuf::FieldDescriptor::TYPE_BYTES)
+                        os << goby::util::hex_encode(value);
+                }
+                break;
 
-                    for (int i = 0, n = subfields.size() - 1; i < n; ++i)
-                    {
-                        std::vector<std::string> field_and_index;
-                        boost::split(field_and_index, subfields[i], boost::is_any_of("."));
+                case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+                    os << std::setprecision(std::numeric_limits<float>::digits10)
+                       << ((j < size) ? refl->GetRepeatedFloat(in, field_desc, j)
+                                      : std::numeric_limits<float>::quiet_NaN());
+                    break;
 
-                        field_desc = sub_message->GetDescriptor()->FindFieldByNumber(
-                            goby::util::as<int>(field_and_index[0]));
-                        if (!field_desc || field_desc->cpp_type() !=
-                                               google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE)
-                        {
-                            throw(std::runtime_error(
-                                "Invalid ':' syntax given for format: " + specifier +
-                                ". All field indices except the last must be singular embedded "
-                                "messages"));
-                        }
+                case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+                    os << std::setprecision(std::numeric_limits<double>::digits10)
+                       << ((j < size) ? refl->GetRepeatedDouble(in, field_desc, j)
+                                      : std::numeric_limits<double>::quiet_NaN());
+                    break;
 
-                        int index = -1;
-                        if (field_desc->is_repeated())
-                        {
-                            if (field_and_index.size() != 2)
-                                throw(std::runtime_error(
-                                    "Invalid '.' syntax given for format: " + specifier +
-                                    ". Repeated message, but no valid index given. E.g., use '3.4' "
-                                    "for index 4 of field 3."));
-                            index = goby::util::as<int>(field_and_index.at(1));
-                            while (sub_refl->FieldSize(*sub_message, field_desc) <= index)
-                                sub_refl->AddMessage(sub_message, field_desc);
-                        }
+                case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+                {
+                    const google::protobuf::EnumValueDescriptor* enum_val =
+                        ((j < size) ? refl->GetRepeatedEnum(in, field_desc, j)
+                                    : field_desc->default_value_enum());
+                    os << ((use_short_enum)
+                               ? strip_name_from_enum(enum_val->name(), field_desc->name())
+                               : enum_val->name());
+                }
+                break;
+            }
+        }
+    }
+
+    static void parse_field(const std::string& extract, google::protobuf::Message* out,
+                            const google::protobuf::FieldDescriptor* field_desc,
+                            bool is_indexed_repeated_field, int value_index,
+                            const std::string& repeated_delimiter, bool use_short_enum)
+    {
+        const google::protobuf::Reflection* refl = out->GetReflection();
+
+        std::vector<std::string> parts;
+        if (is_indexed_repeated_field || !field_desc->is_repeated())
+            parts.push_back(extract);
+        else
+            boost::split(parts, extract, boost::is_any_of(repeated_delimiter));
 
-                        sub_message =
-                            (field_desc->is_repeated())
-                                ? sub_refl->MutableRepeatedMessage(sub_message, field_desc, index)
-                                : sub_refl->MutableMessage(sub_message, field_desc);
-                        sub_refl = sub_message->GetReflection();
+        for (int j = 0, m = parts.size(); j < m; ++j)
+        {
+            switch (field_desc->cpp_type())
+            {
+                case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddMessage(out, field_desc);
                     }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->MutableRepeatedMessage(out, field_desc,
+                                                              value_index)
+                                     ->ParseFromString(
+                                         goby::util::hex_decode(parts[j]))
+                               : refl->AddMessage(out, field_desc)
+                                     ->ParseFromString(
+                                         goby::util::hex_decode(parts[j])))
+                        : refl->MutableMessage(out, field_desc)
+                              ->ParseFromString(goby::util::hex_decode(parts[j]));
+                    break;
 
-                    parse(extract, sub_message, "%" + subfields[subfields.size() - 1] + "%",
-                          repeated_delimiter, algorithms, use_short_enum);
-                }
-                else
-                {
-                    try
+                case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+                    if (is_indexed_repeated_field)
                     {
-                        std::vector<std::string> field_and_index;
-                        boost::split(field_and_index, specifier, boost::is_any_of("."));
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddInt32(out, field_desc,
+                                           field_desc->default_value_int32());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedInt32(
+                                     out, field_desc, value_index,
+                                     goby::util::as<google::protobuf::int32>(
+                                         parts[j]))
+                               : refl->AddInt32(
+                                     out, field_desc,
+                                     goby::util::as<google::protobuf::int32>(
+                                         parts[j])))
+                        : refl->SetInt32(
+                              out, field_desc,
+                              goby::util::as<google::protobuf::int32>(parts[j]));
+                    break;
 
-                        int field_index = boost::lexical_cast<int>(field_and_index[0]);
-                        bool is_indexed_repeated_field = field_and_index.size() == 2;
+                case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddInt64(out, field_desc,
+                                           field_desc->default_value_int64());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedInt64(
+                                     out, field_desc, value_index,
+                                     goby::util::as<google::protobuf::int64>(
+                                         parts[j]))
+                               : refl->AddInt64(
+                                     out, field_desc,
+                                     goby::util::as<google::protobuf::int64>(
+                                         parts[j])))
+                        : refl->SetInt64(
+                              out, field_desc,
+                              goby::util::as<google::protobuf::int64>(parts[j]));
+                    break;
 
-                        int value_index = 0;
-                        if (is_indexed_repeated_field)
-                            value_index = boost::lexical_cast<int>(field_and_index[1]);
+                case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddUInt32(out, field_desc,
+                                            field_desc->default_value_uint32());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedUInt32(
+                                     out, field_desc, value_index,
+                                     goby::util::as<google::protobuf::uint32>(
+                                         parts[j]))
+                               : refl->AddUInt32(
+                                     out, field_desc,
+                                     goby::util::as<google::protobuf::uint32>(
+                                         parts[j])))
+                        : refl->SetUInt32(
+                              out, field_desc,
+                              goby::util::as<google::protobuf::uint32>(parts[j]));
+                    break;
 
-                        const google::protobuf::FieldDescriptor* field_desc =
-                            desc->FindFieldByNumber(field_index);
+                case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddUInt64(out, field_desc,
+                                            field_desc->default_value_uint64());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedUInt64(
+                                     out, field_desc, value_index,
+                                     goby::util::as<google::protobuf::uint64>(
+                                         parts[j]))
+                               : refl->AddUInt64(
+                                     out, field_desc,
+                                     goby::util::as<google::protobuf::uint64>(
+                                         parts[j])))
+                        : refl->SetUInt64(
+                              out, field_desc,
+                              goby::util::as<google::protobuf::uint64>(parts[j]));
+                    break;
 
-                        if (!field_desc)
-                            throw(std::runtime_error("Bad field: " + specifier +
-                                                     " not in message " + desc->full_name()));
+                case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddBool(out, field_desc,
+                                          field_desc->default_value_bool());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedBool(
+                                     out, field_desc, value_index,
+                                     goby::util::as<bool>(parts[j]))
+                               : refl->AddBool(out, field_desc,
+                                               goby::util::as<bool>(parts[j])))
+                        : refl->SetBool(out, field_desc,
+                                        goby::util::as<bool>(parts[j]));
+                    break;
 
-                        // run algorithms
-                        typedef google::protobuf::RepeatedPtrField<
-                            protobuf::TranslatorEntry::CreateParser::Algorithm>::const_iterator
-                            const_iterator;
+                case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddString(out, field_desc,
+                                            field_desc->default_value_string());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedString(out, field_desc,
+                                                         value_index, parts[j])
+                               : refl->AddString(out, field_desc, parts[j]))
+                        : refl->SetString(out, field_desc, parts[j]);
+                    break;
 
-                        for (const_iterator it = algorithms.begin(), n = algorithms.end(); it != n;
-                             ++it)
-                        {
-                            goby::transitional::DCCLMessageVal extract_val(extract);
+                case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddFloat(out, field_desc,
+                                           field_desc->default_value_float());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedFloat(
+                                     out, field_desc, value_index,
+                                     goby::util::as<float>(parts[j]))
+                               : refl->AddFloat(out, field_desc,
+                                                goby::util::as<float>(parts[j])))
+                        : refl->SetFloat(out, field_desc,
+                                         goby::util::as<float>(parts[j]));
+                    break;
 
-                            if (it->primary_field() == field_index)
-                                transitional::DCCLAlgorithmPerformer::getInstance()->run_algorithm(
-                                    it->name(), extract_val,
-                                    std::vector<goby::transitional::DCCLMessageVal>());
+                case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddDouble(out, field_desc,
+                                            field_desc->default_value_double());
+                    }
+                    field_desc->is_repeated()
+                        ? (is_indexed_repeated_field
+                               ? refl->SetRepeatedDouble(
+                                     out, field_desc, value_index,
+                                     goby::util::as<double>(parts[j]))
+                               : refl->AddDouble(out, field_desc,
+                                                 goby::util::as<double>(parts[j])))
+                        : refl->SetDouble(out, field_desc,
+                                          goby::util::as<double>(parts[j]));
+                    break;
 
-                            extract = std::string(extract_val);
-                        }
+                case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+                {
+                    if (is_indexed_repeated_field)
+                    {
+                        while (refl->FieldSize(*out, field_desc) <= value_index)
+                            refl->AddEnum(out, field_desc,
+                                          field_desc->default_value_enum());
+                    }
+                    std::string enum_value =
+                        ((use_short_enum)
+                             ? add_name_to_enum(parts[j], field_desc->name())
+                             : parts[j]);
 
-                        std::vector<std::string> parts;
-                        if (is_indexed_repeated_field || !field_desc->is_repeated())
-                            parts.push_back(extract);
-                        else
-                            boost::split(parts, extract, boost::is_any_of(repeated_delimiter));
+                    const google::protobuf::EnumValueDescriptor* enum_desc =
+                        refl->GetEnum(*out, field_desc)
+                            ->type()
+                            ->FindValueByName(enum_value);
 
-                        for (int j = 0, m = parts.size(); j < m; ++j)
-                        {
-                            switch (field_desc->cpp_type())
-                            {
-                                case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddMessage(out, field_desc);
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->MutableRepeatedMessage(out, field_desc,
-                                                                              value_index)
-                                                     ->ParseFromString(
-                                                         goby::util::hex_decode(parts[j]))
-                                               : refl->AddMessage(out, field_desc)
-                                                     ->ParseFromString(
-                                                         goby::util::hex_decode(parts[j])))
-                                        : refl->MutableMessage(out, field_desc)
-                                              ->ParseFromString(goby::util::hex_decode(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddInt32(out, field_desc,
-                                                           field_desc->default_value_int32());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedInt32(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<google::protobuf::int32>(
-                                                         parts[j]))
-                                               : refl->AddInt32(
-                                                     out, field_desc,
-                                                     goby::util::as<google::protobuf::int32>(
-                                                         parts[j])))
-                                        : refl->SetInt32(
-                                              out, field_desc,
-                                              goby::util::as<google::protobuf::int32>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddInt64(out, field_desc,
-                                                           field_desc->default_value_int64());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedInt64(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<google::protobuf::int64>(
-                                                         parts[j]))
-                                               : refl->AddInt64(
-                                                     out, field_desc,
-                                                     goby::util::as<google::protobuf::int64>(
-                                                         parts[j])))
-                                        : refl->SetInt64(
-                                              out, field_desc,
-                                              goby::util::as<google::protobuf::int64>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddUInt32(out, field_desc,
-                                                            field_desc->default_value_uint32());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedUInt32(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<google::protobuf::uint32>(
-                                                         parts[j]))
-                                               : refl->AddUInt32(
-                                                     out, field_desc,
-                                                     goby::util::as<google::protobuf::uint32>(
-                                                         parts[j])))
-                                        : refl->SetUInt32(
-                                              out, field_desc,
-                                              goby::util::as<google::protobuf::uint32>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddUInt64(out, field_desc,
-                                                            field_desc->default_value_uint64());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedUInt64(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<google::protobuf::uint64>(
-                                                         parts[j]))
-                                               : refl->AddUInt64(
-                                                     out, field_desc,
-                                                     goby::util::as<google::protobuf::uint64>(
-                                                         parts[j])))
-                                        : refl->SetUInt64(
-                                              out, field_desc,
-                                              goby::util::as<google::protobuf::uint64>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddBool(out, field_desc,
-                                                          field_desc->default_value_bool());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedBool(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<bool>(parts[j]))
-                                               : refl->AddBool(out, field_desc,
-                                                               goby::util::as<bool>(parts[j])))
-                                        : refl->SetBool(out, field_desc,
-                                                        goby::util::as<bool>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddString(out, field_desc,
-                                                            field_desc->default_value_string());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedString(out, field_desc,
-                                                                         value_index, parts[j])
-                                               : refl->AddString(out, field_desc, parts[j]))
-                                        : refl->SetString(out, field_desc, parts[j]);
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddFloat(out, field_desc,
-                                                           field_desc->default_value_float());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedFloat(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<float>(parts[j]))
-                                               : refl->AddFloat(out, field_desc,
-                                                                goby::util::as<float>(parts[j])))
-                                        : refl->SetFloat(out, field_desc,
-                                                         goby::util::as<float>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddDouble(out, field_desc,
-                                                            field_desc->default_value_double());
-                                    }
-                                    field_desc->is_repeated()
-                                        ? (is_indexed_repeated_field
-                                               ? refl->SetRepeatedDouble(
-                                                     out, field_desc, value_index,
-                                                     goby::util::as<double>(parts[j]))
-                                               : refl->AddDouble(out, field_desc,
-                                                                 goby::util::as<double>(parts[j])))
-                                        : refl->SetDouble(out, field_desc,
-                                                          goby::util::as<double>(parts[j]));
-                                    break;
-
-                                case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
-                                {
-                                    if (is_indexed_repeated_field)
-                                    {
-                                        while (refl->FieldSize(*out, field_desc) <= value_index)
-                                            refl->AddEnum(out, field_desc,
-                                                          field_desc->default_value_enum());
-                                    }
-                                    std::string enum_value =
-                                        ((use_short_enum)
-                                             ? add_name_to_enum(parts[j], field_desc->name())
-                                             : parts[j]);
-
-                                    const google::protobuf::EnumValueDescriptor* enum_desc =
-                                        refl->GetEnum(*out, field_desc)
-                                            ->type()
-                                            ->FindValueByName(enum_value);
-
-                                    // try upper case
-                                    if (!enum_desc)
-                                        enum_desc =
-                                            refl->GetEnum(*out, field_desc)
-                                                ->type()
-                                                ->FindValueByName(boost::to_upper_copy(enum_value));
-                                    // try lower case
-                                    if (!enum_desc)
-                                        enum_desc =
-                                            refl->GetEnum(*out, field_desc)
-                                                ->type()
-                                                ->FindValueByName(boost::to_lower_copy(enum_value));
-                                    if (enum_desc)
-                                    {
-                                        field_desc->is_repeated()
-                                            ? (is_indexed_repeated_field
-                                                   ? refl->SetRepeatedEnum(out, field_desc,
-                                                                           value_index, enum_desc)
-                                                   : refl->AddEnum(out, field_desc, enum_desc))
-                                            : refl->SetEnum(out, field_desc, enum_desc);
-                                    }
-                                }
-                                break;
-                            }
-                        }
-                    }
-                    catch (boost::bad_lexical_cast&)
+                    // try upper case
+                    if (!enum_desc)
+                        enum_desc =
+                            refl->GetEnum(*out, field_desc)
+                                ->type()
+                                ->FindValueByName(boost::to_upper_copy(enum_value));
+                    // try lower case
+                    if (!enum_desc)
+                        enum_desc =
+                            refl->GetEnum(*out, field_desc)
+                                ->type()
+                                ->FindValueByName(boost::to_lower_copy(enum_value));
+                    if (enum_desc)
                     {
-                        throw(std::runtime_error(
-                            "Bad specifier: " + specifier +
-                            ", must be an integer. For message: " + desc->full_name()));
+                        field_desc->is_repeated()
+                            ? (is_indexed_repeated_field
+                                   ? refl->SetRepeatedEnum(out, field_desc,
+                                                           value_index, enum_desc)
+                                   : refl->AddEnum(out, field_desc, enum_desc))
+                            : refl->SetEnum(out, field_desc, enum_desc);
                     }
                 }
-
-                // goby::glog.is(DEBUG1) && goby::glog << "field: [" << field_index << "], parts[j]: [" << parts[j] << "]" << std::endl;
-            }
-            else
-            {
-                // if it's not a %, eat!
-                std::string::size_type pos_to_remove = lower_str.find(*i) + 1;
-                lower_str.erase(0, pos_to_remove);
-                str.erase(0, pos_to_remove);
-                ++i;
+                break;
             }
         }
     }
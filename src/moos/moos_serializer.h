@@ -35,6 +35,36 @@ class MOOSSerializer
     {
         // copy because Serialize wants to modify the CMOOSMsg
         CMOOSMsg msg(const_msg);
+        serialize_copy(msg, data);
+    }
+
+    /// \brief Serialize into a buffer owned by this serializer, valid until the next call.
+    ///
+    /// Once the buffers have grown to fit the largest message seen, repeated calls do not
+    /// allocate: Serialize still needs a non-const CMOOSMsg, but assigning into the scratch
+    /// message reuses its string capacity.
+    const std::string& serialize(const CMOOSMsg& const_msg)
+    {
+        scratch_ = const_msg;
+        serialize_copy(scratch_, &buffer_);
+        return buffer_;
+    }
+
+    static void parse(CMOOSMsg* msg, const std::string& data)
+    {
+        parse(msg, data.data(), data.size());
+    }
+
+    /// \brief Parse directly from a received buffer, overwriting all the fields of msg
+    static void parse(CMOOSMsg* msg, const char* data, std::size_t size)
+    {
+        // Serialize only reads from the buffer when unpacking
+        msg->Serialize(reinterpret_cast<unsigned char*>(const_cast<char*>(data)), size, false);
+    }
+
+  private:
+    static void serialize_copy(CMOOSMsg& msg, std::string* data)
+    {
         // adapted from MOOSCommPkt.cpp
         int serialized_size = msg.GetSizeInBytesWhenSerialised();
         data->resize(serialized_size);
@@ -43,10 +73,8 @@ class MOOSSerializer
         data->resize(serialized_size);
     }
 
-    static void parse(CMOOSMsg* msg, std::string data)
-    {
-        msg->Serialize(reinterpret_cast<unsigned char*>(&data[0]), data.size(), false);
-    }
+    CMOOSMsg scratch_;
+    std::string buffer_;
 };
 } // namespace moos
 } // namespace goby
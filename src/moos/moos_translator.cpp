@@ -90,6 +90,36 @@ void goby::moos::MOOSTranslator::initialize(double lat_origin, double lon_origin
     }
 }
 
+void goby::moos::MOOSTranslator::compile_formats(const goby::moos::protobuf::TranslatorEntry& entry)
+{
+    CompiledFormats& formats = formats_[entry.protobuf_name()];
+
+    formats.publish_moos_var.resize(entry.publish_size());
+    formats.publish_format.resize(entry.publish_size());
+    for (int i = 0, n = entry.publish_size(); i < n; ++i)
+    {
+        if (entry.publish(i).technique() == protobuf::TranslatorEntry::TECHNIQUE_FORMAT)
+        {
+            formats.publish_moos_var[i] =
+                FormatTranslation::compile_serializer(entry.publish(i).moos_var());
+            formats.publish_format[i] =
+                FormatTranslation::compile_serializer(entry.publish(i).format());
+        }
+    }
+
+    formats.create_serializer.resize(entry.create_size());
+    formats.create_parser.resize(entry.create_size());
+    for (int i = 0, n = entry.create_size(); i < n; ++i)
+    {
+        if (entry.create(i).technique() == protobuf::TranslatorEntry::TECHNIQUE_FORMAT)
+        {
+            formats.create_serializer[i] =
+                FormatTranslation::compile_serializer(entry.create(i).format());
+            formats.create_parser[i] = FormatTranslation::compile_parser(entry.create(i).format());
+        }
+    }
+}
+
 void goby::moos::alg_power_to_dB(transitional::DCCLMessageVal& val_to_mod)
 {
     val_to_mod = 10 * log10(double(val_to_mod));
@@ -93,13 +93,18 @@ class MOOSTranslator
         add_entry(entries);
     }
 
-    void clear_entry(const std::string& protobuf_name) { dictionary_.erase(protobuf_name); }
+    void clear_entry(const std::string& protobuf_name)
+    {
+        dictionary_.erase(protobuf_name);
+        formats_.erase(protobuf_name);
+    }
 
     void add_entry(const goby::moos::protobuf::TranslatorEntry& entry)
     {
         if (dictionary_.count(entry.protobuf_name()))
             throw(std::runtime_error("Duplicate translator entry for " + entry.protobuf_name()));
         dictionary_[entry.protobuf_name()] = entry;
+        compile_formats(entry);
     }
 
     void add_entry(const std::set<goby::moos::protobuf::TranslatorEntry>& entries)
@@ -168,6 +173,20 @@ class MOOSTranslator
     }
 
   private:
+    typedef MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT> FormatTranslation;
+
+    // TECHNIQUE_FORMAT strings of one TranslatorEntry, compiled once in add_entry (indexed
+    // like the entry's publish and create fields; empty for other techniques)
+    struct CompiledFormats
+    {
+        std::vector<FormatTranslation::Program> publish_moos_var;
+        std::vector<FormatTranslation::Program> publish_format;
+        std::vector<FormatTranslation::Program> create_serializer;
+        std::vector<FormatTranslation::Program> create_parser;
+    };
+
+    void compile_formats(const goby::moos::protobuf::TranslatorEntry& entry);
+
     void initialize(double lat_origin = std::numeric_limits<double>::quiet_NaN(),
                     double lon_origin = std::numeric_limits<double>::quiet_NaN(),
                     const std::string& modem_id_lookup_path = "");
@@ -190,6 +209,8 @@ class MOOSTranslator
 
   private:
     std::map<std::string, goby::moos::protobuf::TranslatorEntry> dictionary_;
+    // same keys as dictionary_
+    std::map<std::string, CompiledFormats> formats_;
     CMOOSGeodesy geodesy_;
     goby::moos::ModemIdConvert modem_lookup_;
 };
@@ -237,6 +258,7 @@ goby::moos::MOOSTranslator::protobuf_to_moos(const google::protobuf::Message& pr
         throw(std::runtime_error("No TranslatorEntry for Protobuf type: " + pb_name));
 
     const goby::moos::protobuf::TranslatorEntry& entry = it->second;
+    const CompiledFormats& formats = formats_.find(pb_name)->second;
 
     std::multimap<std::string, CMOOSMsg> moos_msgs;
 
@@ -296,15 +318,16 @@ goby::moos::MOOSTranslator::protobuf_to_moos(const google::protobuf::Message& pr
 
             case protobuf::TranslatorEntry::TECHNIQUE_FORMAT:
                 // process moos_variable too (can be a format string itself!)
-                goby::moos::MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>::serialize(
-                    &moos_var, protobuf_msg, entry.publish(i).algorithm(),
-                    entry.publish(i).moos_var(), entry.publish(i).repeated_delimiter(),
-                    entry.use_short_enum());
+                FormatTranslation::serialize(&moos_var, protobuf_msg, entry.publish(i).algorithm(),
+                                             formats.publish_moos_var[i],
+                                             entry.publish(i).repeated_delimiter(),
+                                             entry.use_short_enum());
                 // now do the format values
-                goby::moos::MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>::serialize(
-                    &return_string, protobuf_msg, entry.publish(i).algorithm(),
-                    entry.publish(i).format(), entry.publish(i).repeated_delimiter(),
-                    entry.use_short_enum());
+                FormatTranslation::serialize(&return_string, protobuf_msg,
+                                             entry.publish(i).algorithm(),
+                                             formats.publish_format[i],
+                                             entry.publish(i).repeated_delimiter(),
+                                             entry.use_short_enum());
                 break;
         }
 
@@ -328,6 +351,7 @@ goby::moos::MOOSTranslator::protobuf_to_inverse_moos(const google::protobuf::Mes
         throw(std::runtime_error("No TranslatorEntry for Protobuf type: " + pb_name));
 
     const goby::moos::protobuf::TranslatorEntry& entry = it->second;
+    const CompiledFormats& formats = formats_.find(pb_name)->second;
 
     std::multimap<std::string, CMOOSMsg> moos_msgs;
 
@@ -400,9 +424,10 @@ goby::moos::MOOSTranslator::protobuf_to_inverse_moos(const google::protobuf::Mes
                     protobuf::TranslatorEntry::PublishSerializer::Algorithm>
                     empty_algorithms;
 
-                goby::moos::MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>::serialize(
-                    &return_string, protobuf_msg, empty_algorithms, entry.create(i).format(),
-                    entry.create(i).repeated_delimiter(), entry.use_short_enum());
+                FormatTranslation::serialize(&return_string, protobuf_msg, empty_algorithms,
+                                             formats.create_serializer[i],
+                                             entry.create(i).repeated_delimiter(),
+                                             entry.use_short_enum());
             }
             break;
         }
@@ -444,6 +469,7 @@ goby::moos::MOOSTranslator::moos_to_protobuf(const StringCMOOSMsgMap& moos_varia
         throw(std::runtime_error("No TranslatorEntry for Protobuf type: " + protobuf_name));
 
     const goby::moos::protobuf::TranslatorEntry& entry = it->second;
+    const CompiledFormats& formats = formats_.find(protobuf_name)->second;
 
     GoogleProtobufMessagePointer msg =
         goby::util::DynamicProtobufManager::new_protobuf_message<GoogleProtobufMessagePointer>(
@@ -510,10 +536,9 @@ goby::moos::MOOSTranslator::moos_to_protobuf(const StringCMOOSMsgMap& moos_varia
                 break;
 
             case protobuf::TranslatorEntry::TECHNIQUE_FORMAT:
-                goby::moos::MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT>::parse(
-                    source_string, &*msg, entry.create(i).format(),
-                    entry.create(i).repeated_delimiter(), entry.create(i).algorithm(),
-                    entry.use_short_enum());
+                FormatTranslation::parse(source_string, &*msg, formats.create_parser[i],
+                                         entry.create(i).repeated_delimiter(),
+                                         entry.create(i).algorithm(), entry.use_short_enum());
                 break;
         }
     }
@@ -0,0 +1,161 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MOOSWILDCARDINDEX20181102H
+#define MOOSWILDCARDINDEX20181102H
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "goby/moos/moos_header.h"
+
+namespace goby
+{
+namespace moos
+{
+/// \brief Index of values subscribed by (MOOS variable pattern, MOOS app pattern) wildcards
+///
+/// Patterns are stored in a trie keyed by the literal prefix of the variable pattern (everything
+/// before the first '*' or '?'), so only patterns whose prefix matches a new key are tested with
+/// MOOSWildCmp. The result for each (key, source) pair is then memoized, so repeated mail costs
+/// two map lookups regardless of how many patterns are indexed.
+template <typename Value> class MOOSWildcardIndex
+{
+  public:
+    /// MOOS variable pattern, MOOS app pattern
+    typedef std::pair<std::string, std::string> Pattern;
+
+    /// \param max_cached Number of (key, source) results to memoize before starting over
+    explicit MOOSWildcardIndex(std::size_t max_cached = 10000)
+        : nodes_(1), cached_(0), max_cached_(max_cached), cache_stale_(false)
+    {
+    }
+
+    /// \brief Add a pattern. Each pattern should only be inserted once.
+    void insert(const Pattern& pattern, const Value& value)
+    {
+        int entry = entries_.size();
+        entries_.push_back(std::make_pair(pattern, value));
+
+        const std::string& var_pattern = pattern.first;
+        std::string::size_type prefix_length =
+            std::min(var_pattern.find_first_of("*?"), var_pattern.size());
+
+        int node = 0;
+        for (std::string::size_type i = 0; i < prefix_length; ++i)
+        {
+            std::map<char, int>::const_iterator child = nodes_[node].children.find(var_pattern[i]);
+            if (child != nodes_[node].children.end())
+            {
+                node = child->second;
+            }
+            else
+            {
+                nodes_.push_back(TrieNode());
+                nodes_[node].children.insert(std::make_pair(var_pattern[i], nodes_.size() - 1));
+                node = nodes_.size() - 1;
+            }
+        }
+        nodes_[node].entries.push_back(entry);
+
+        // cleared on the next match() so that references already handed out stay valid
+        cache_stale_ = true;
+    }
+
+    /// \brief Values of all patterns matching `key` and `source`, in Pattern order
+    ///
+    /// The reference is valid until the next call to match().
+    const std::vector<Value>& match(const std::string& key, const std::string& source)
+    {
+        if (cache_stale_ || cached_ >= max_cached_)
+        {
+            cache_.clear();
+            cached_ = 0;
+            cache_stale_ = false;
+        }
+
+        std::map<std::string, std::vector<Value> >& sources = cache_[key];
+        typename std::map<std::string, std::vector<Value> >::iterator it = sources.find(source);
+        if (it != sources.end())
+            return it->second;
+
+        ++cached_;
+        std::vector<Value>& values = sources[source];
+
+        // every pattern whose literal prefix is a prefix of the key
+        std::vector<int> candidates;
+        int node = 0;
+        candidates.insert(candidates.end(), nodes_[node].entries.begin(),
+                          nodes_[node].entries.end());
+        for (std::string::const_iterator c = key.begin(), end = key.end(); c != end; ++c)
+        {
+            std::map<char, int>::const_iterator child = nodes_[node].children.find(*c);
+            if (child == nodes_[node].children.end())
+                break;
+            node = child->second;
+            candidates.insert(candidates.end(), nodes_[node].entries.begin(),
+                              nodes_[node].entries.end());
+        }
+
+        std::sort(candidates.begin(), candidates.end(), EntryOrder(entries_));
+        for (std::vector<int>::const_iterator c = candidates.begin(), end = candidates.end();
+             c != end; ++c)
+        {
+            const Pattern& pattern = entries_[*c].first;
+            if (MOOSWildCmp(pattern.first, key) && MOOSWildCmp(pattern.second, source))
+                values.push_back(entries_[*c].second);
+        }
+        return values;
+    }
+
+    std::size_t size() const { return entries_.size(); }
+
+  private:
+    struct TrieNode
+    {
+        std::map<char, int> children;
+        // indices into entries_ of the patterns whose literal prefix ends here
+        std::vector<int> entries;
+    };
+
+    struct EntryOrder
+    {
+        EntryOrder(const std::vector<std::pair<Pattern, Value> >& e) : entries(e) {}
+        bool operator()(int a, int b) const { return entries[a].first < entries[b].first; }
+        const std::vector<std::pair<Pattern, Value> >& entries;
+    };
+
+    std::vector<std::pair<Pattern, Value> > entries_;
+    std::vector<TrieNode> nodes_;
+
+    // key -> source -> matching values
+    std::map<std::string, std::map<std::string, std::vector<Value> > > cache_;
+    std::size_t cached_;
+    std::size_t max_cached_;
+    bool cache_stale_;
+};
+} // namespace moos
+} // namespace goby
+
+#endif
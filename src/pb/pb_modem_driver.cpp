@@ -35,10 +35,13 @@ using goby::common::goby_time;
 
 goby::pb::PBDriver::PBDriver(goby::common::ZeroMQService* zeromq_service)
     : StaticProtobufNode(zeromq_service), zeromq_service_(zeromq_service),
-      last_send_time_(goby_time<uint64>()), request_socket_id_(0), query_interval_seconds_(1),
-      reset_interval_seconds_(120), waiting_for_reply_(false), next_frame_(0)
+      last_send_time_(goby_time<uint64>()), request_socket_id_(0), notify_socket_id_(-1),
+      query_interval_seconds_(1), reset_interval_seconds_(120), waiting_for_reply_(false),
+      data_waiting_(false), next_frame_(0)
 {
     on_receipt<acomms::protobuf::StoreServerResponse>(0, &PBDriver::handle_response, this);
+    on_receipt<acomms::protobuf::StoreServerNotification>(0, &PBDriver::handle_notification,
+                                                          this);
 }
 
 void goby::pb::PBDriver::startup(const acomms::protobuf::DriverConfig& cfg)
@@ -46,12 +49,28 @@ void goby::pb::PBDriver::startup(const acomms::protobuf::DriverConfig& cfg)
     driver_cfg_ = cfg;
     request_.set_modem_id(driver_cfg_.modem_id());
 
+    // rebuilt from scratch so that restarting the driver does not repeat sockets
+    service_cfg_.Clear();
+    notify_socket_id_ = -1;
     service_cfg_.add_socket()->CopyFrom(driver_cfg_.GetExtension(PBDriverConfig::request_socket));
+
+    if (driver_cfg_.HasExtension(PBDriverConfig::notify_socket))
+    {
+        service_cfg_.add_socket()->CopyFrom(
+            driver_cfg_.GetExtension(PBDriverConfig::notify_socket));
+        notify_socket_id_ = driver_cfg_.GetExtension(PBDriverConfig::notify_socket).socket_id();
+    }
+
     zeromq_service_->set_cfg(service_cfg_);
+    subscribe_notifications();
 
     request_socket_id_ = driver_cfg_.GetExtension(PBDriverConfig::request_socket).socket_id();
 
-    query_interval_seconds_ = driver_cfg_.GetExtension(PBDriverConfig::query_interval_seconds);
+    // with notifications, regular polling is only a fallback for missed notifications
+    query_interval_seconds_ =
+        (notify_socket_id_ >= 0)
+            ? driver_cfg_.GetExtension(PBDriverConfig::idle_query_interval_seconds)
+            : driver_cfg_.GetExtension(PBDriverConfig::query_interval_seconds);
 
     reset_interval_seconds_ = driver_cfg_.GetExtension(PBDriverConfig::reset_interval_seconds);
 }
@@ -128,9 +147,10 @@ void goby::pb::PBDriver::do_work()
     while (zeromq_service_->poll(0)) {}
 
     // call in with our outbox
+    bool send_now = notify_socket_id_ >= 0 && (data_waiting_ || request_.outbox_size() > 0);
     if (!waiting_for_reply_ && request_.IsInitialized() &&
-        goby_time<uint64>() >
-            last_send_time_ + 1000000 * static_cast<uint64>(query_interval_seconds_))
+        (send_now || goby_time<uint64>() > last_send_time_ + 1000000 * static_cast<uint64>(
+                                                                   query_interval_seconds_)))
     {
         static int request_id = 0;
         request_.set_request_id(request_id++);
@@ -141,6 +161,7 @@ void goby::pb::PBDriver::do_work()
         last_send_time_ = goby_time<uint64>();
         request_.clear_outbox();
         waiting_for_reply_ = true;
+        data_waiting_ = false;
     }
     else if (waiting_for_reply_ &&
              goby_time<uint64>() > last_send_time_ + 1e6 * reset_interval_seconds_)
@@ -150,10 +171,33 @@ void goby::pb::PBDriver::do_work()
                                 << std::endl;
         zeromq_service_->close_all();
         zeromq_service_->set_cfg(service_cfg_);
+        subscribe_notifications();
         waiting_for_reply_ = false;
     }
 }
 
+void goby::pb::PBDriver::subscribe_notifications()
+{
+    if (notify_socket_id_ >= 0)
+        ProtobufNode::subscribe(
+            acomms::protobuf::StoreServerNotification::descriptor()->full_name(),
+            notify_socket_id_, "");
+}
+
+void goby::pb::PBDriver::handle_notification(
+    const acomms::protobuf::StoreServerNotification& notification)
+{
+    if (notification.modem_id() == driver_cfg_.modem_id())
+        return;
+
+    glog.is(DEBUG2) && glog << group(glog_in_group()) << "Server stored "
+                            << notification.num_rows() << " rows from modem "
+                            << notification.modem_id() << std::endl;
+
+    // requested after the current reply (if any), which may have missed these rows
+    data_waiting_ = true;
+}
+
 void goby::pb::PBDriver::handle_response(const acomms::protobuf::StoreServerResponse& response)
 {
     glog.is(DEBUG1) && glog << group(glog_in_group()) << "Received response in "
@@ -46,6 +46,8 @@ class PBDriver : public acomms::ModemDriverBase, public goby::pb::StaticProtobuf
 
   private:
     void handle_response(const acomms::protobuf::StoreServerResponse& response);
+    void handle_notification(const acomms::protobuf::StoreServerNotification& notification);
+    void subscribe_notifications();
 
   private:
     goby::common::ZeroMQService* zeromq_service_;
@@ -54,9 +56,12 @@ class PBDriver : public acomms::ModemDriverBase, public goby::pb::StaticProtobuf
     acomms::protobuf::StoreServerRequest request_;
     uint64 last_send_time_;
     int request_socket_id_;
+    int notify_socket_id_;
     double query_interval_seconds_;
     double reset_interval_seconds_;
     bool waiting_for_reply_;
+    // the server has stored rows we haven't requested yet
+    bool data_waiting_;
     goby::uint32 next_frame_;
 };
 } // namespace pb
@@ -29,15 +29,13 @@ using goby::util::as;
 using namespace goby::common::logger;
 
 void goby::pb::ProtobufNode::inbox(common::MarshallingScheme marshalling_scheme,
-                                   const std::string& identifier, const std::string& body,
+                                   boost::string_ref identifier, boost::string_ref body,
                                    int socket_id)
 {
     if (marshalling_scheme == common::MARSHALLING_PROTOBUF)
     {
-        std::string::size_type first_slash = identifier.find("/");
-        std::string group = identifier.substr(0, first_slash);
-        std::string pb_full_name = identifier.substr(first_slash + 1);
-        pb_full_name.erase(pb_full_name.size() - 1); // final slash
+        std::string group, pb_full_name;
+        parse_identifier(identifier, &pb_full_name, &group);
 
         glog.is(DEBUG3) && glog << "MARSHALLING_PROTOBUF type: [" << pb_full_name << "], group: ["
                                 << group << "]" << std::endl;
@@ -46,6 +44,16 @@ void goby::pb::ProtobufNode::inbox(common::MarshallingScheme marshalling_scheme,
     }
 }
 
+void goby::pb::ProtobufNode::parse_identifier(boost::string_ref identifier,
+                                              std::string* protobuf_type_name, std::string* group)
+{
+    boost::string_ref::size_type first_slash = identifier.find('/');
+    *group = identifier.substr(0, first_slash).to_string();
+    *protobuf_type_name = identifier.substr(first_slash + 1).to_string();
+    if (!protobuf_type_name->empty())
+        protobuf_type_name->erase(protobuf_type_name->size() - 1); // final slash
+}
+
 void goby::pb::ProtobufNode::send(const google::protobuf::Message& msg, int socket_id,
                                   const std::string& group)
 {
@@ -57,19 +65,15 @@ void goby::pb::ProtobufNode::send(const google::protobuf::Message& msg, int sock
         return;
     }
 
-    std::string body;
-    msg.SerializeToString(&body);
+    std::string identifier = make_identifier(msg.GetDescriptor()->full_name(), group);
 
-    std::string identifier = group + "/" + msg.GetDescriptor()->full_name() + "/";
-
-    zeromq_service()->send(common::MARSHALLING_PROTOBUF, identifier, body, socket_id);
+    zeromq_service()->send(common::MARSHALLING_PROTOBUF, identifier, msg, socket_id);
 }
 
 void goby::pb::ProtobufNode::subscribe(const std::string& protobuf_type_name, int socket_id,
                                        const std::string& group)
 {
-    subscribe(group + "/" + protobuf_type_name + (protobuf_type_name.empty() ? "" : "/"),
-              socket_id);
+    subscribe(make_identifier(protobuf_type_name, group), socket_id);
 }
 
 void goby::pb::ProtobufNode::subscribe(const std::string& identifier, int socket_id)
@@ -79,8 +83,87 @@ void goby::pb::ProtobufNode::subscribe(const std::string& identifier, int socket
     zeromq_service()->subscribe(common::MARSHALLING_PROTOBUF, identifier, socket_id);
 }
 
+void goby::pb::StaticProtobufNode::inbox(common::MarshallingScheme marshalling_scheme,
+                                         boost::string_ref identifier, boost::string_ref body,
+                                         int socket_id)
+{
+    if (marshalling_scheme != common::MARSHALLING_PROTOBUF)
+        return;
+
+    DispatchTable::iterator it = dispatch_.find(identifier, IdentifierHash(), IdentifierEqual());
+    if (it == dispatch_.end())
+    {
+        // only cache identifiers with subscriptions, so that traffic for other types and
+        // groups does not grow the table
+        DispatchEntry entry;
+        make_dispatch_entry(identifier, &entry);
+        if (entry.subscriptions.empty())
+        {
+            glog.is(DEBUG3) && glog << "MARSHALLING_PROTOBUF type: [" << entry.protobuf_type_name
+                                    << "], group: [" << entry.group << "] has no subscriptions"
+                                    << std::endl;
+            return;
+        }
+        it = dispatch_.insert(std::make_pair(identifier.to_string(), entry)).first;
+    }
+
+    glog.is(DEBUG3) && glog << "MARSHALLING_PROTOBUF type: [" << it->second.protobuf_type_name
+                            << "], group: [" << it->second.group << "]" << std::endl;
+
+    const std::vector<boost::shared_ptr<SubscriptionBase> >& subscriptions =
+        it->second.subscriptions;
+
+    // all the subscriptions for a given identifier are for the same type, so parse once
+    // and hand the same message to all of them
+    if (subscriptions.size() == 1)
+    {
+        subscriptions.front()->post(body);
+    }
+    else if (!subscriptions.empty())
+    {
+        boost::shared_ptr<const google::protobuf::Message> msg = subscriptions.front()->parse(body);
+        for (int i = 0, n = subscriptions.size(); i < n; ++i) subscriptions[i]->post(msg);
+    }
+}
+
+goby::pb::StaticProtobufNode::DispatchTable::iterator
+goby::pb::StaticProtobufNode::add_dispatch_entry(boost::string_ref identifier)
+{
+    DispatchEntry entry;
+    make_dispatch_entry(identifier, &entry);
+    return dispatch_.insert(std::make_pair(identifier.to_string(), entry)).first;
+}
+
+void goby::pb::StaticProtobufNode::make_dispatch_entry(boost::string_ref identifier,
+                                                       DispatchEntry* entry)
+{
+    parse_identifier(identifier, &entry->protobuf_type_name, &entry->group);
+
+    typedef boost::unordered_multimap<std::string, boost::shared_ptr<SubscriptionBase> >::iterator
+        It;
+    std::pair<It, It> it_range = subscriptions_.equal_range(entry->protobuf_type_name);
+    for (It it = it_range.first; it != it_range.second; ++it)
+    {
+        const std::string& current_group = it->second->group();
+        if (current_group.empty() || current_group == entry->group)
+            entry->subscriptions.push_back(it->second);
+    }
+}
+
+void goby::pb::StaticProtobufNode::add_to_dispatch_table(
+    boost::shared_ptr<SubscriptionBase> subscription)
+{
+    for (DispatchTable::iterator it = dispatch_.begin(), end = dispatch_.end(); it != end; ++it)
+    {
+        DispatchEntry& entry = it->second;
+        if (entry.protobuf_type_name == subscription->type_name() &&
+            (subscription->group().empty() || subscription->group() == entry.group))
+            entry.subscriptions.push_back(subscription);
+    }
+}
+
 void goby::pb::StaticProtobufNode::protobuf_inbox(const std::string& protobuf_type_name,
-                                                  const std::string& body, int socket_id,
+                                                  boost::string_ref body, int socket_id,
                                                   const std::string& group)
 {
     typedef boost::unordered_multimap<std::string, boost::shared_ptr<SubscriptionBase> >::iterator
@@ -97,22 +180,27 @@ void goby::pb::StaticProtobufNode::protobuf_inbox(const std::string& protobuf_ty
 }
 
 void goby::pb::DynamicProtobufNode::protobuf_inbox(const std::string& protobuf_type_name,
-                                                   const std::string& body, int socket_id,
+                                                   boost::string_ref body, int socket_id,
                                                    const std::string& group)
 {
     try
     {
+        typedef boost::unordered_multimap<
+            std::string,
+            boost::function<void(boost::shared_ptr<google::protobuf::Message> msg)> >::iterator It;
+        std::pair<It, It> it_range = subscriptions_.equal_range(group);
+
+        if (it_range.first == it_range.second)
+            return;
+
+        // looked up for every message (not cached) since the DynamicProtobufManager may be reset
+        // and its types reloaded at any time; parse once and share the message with all the
+        // handlers for this group
         boost::shared_ptr<google::protobuf::Message> msg =
             goby::util::DynamicProtobufManager::new_protobuf_message(protobuf_type_name);
-        msg->ParseFromString(body);
-
-        boost::unordered_multimap<
-            std::string,
-            boost::function<void(boost::shared_ptr<google::protobuf::Message> msg)> >::iterator it =
-            subscriptions_.find(group);
+        msg->ParseFromArray(body.data(), body.size());
 
-        if (it != subscriptions_.end())
-            it->second(msg);
+        for (It it = it_range.first; it != it_range.second; ++it) it->second(msg);
     }
     catch (std::exception& e)
     {
@@ -25,6 +25,7 @@
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/unordered_map.hpp>
 
 #include "goby/common/core_helpers.h"
@@ -48,16 +49,48 @@ class ProtobufNode : public goby::common::NodeInterface<google::protobuf::Messag
 
     virtual ~ProtobufNode() {}
 
+    using common::NodeInterface<google::protobuf::Message>::inbox;
+
+    /// \brief Called for each incoming Protobuf packet. `body` is a view into the received ZeroMQ message, valid only for the duration of this call.
+    ///
+    /// Override this to avoid copying. The default copies `body` and calls the std::string overload of protobuf_inbox().
+    virtual void protobuf_inbox(const std::string& protobuf_type_name, boost::string_ref body,
+                                int socket_id, const std::string& group)
+    {
+        protobuf_inbox(protobuf_type_name, std::string(body.data(), body.size()), socket_id,
+                       group);
+    }
+
+    /// \brief Called for each incoming Protobuf packet by the default boost::string_ref protobuf_inbox(), for subclasses that predate it.
+    ///
+    /// A subclass must override one of the two overloads; this default only warns that the packet is discarded.
     virtual void protobuf_inbox(const std::string& protobuf_type_name, const std::string& body,
-                                int socket_id, const std::string& group) = 0;
+                                int socket_id, const std::string& group)
+    {
+        goby::glog.is(goby::common::logger::WARN) &&
+            goby::glog << "ProtobufNode: " << typeid(*this).name()
+                       << " overrides neither protobuf_inbox(), discarding message of type: ["
+                       << protobuf_type_name << "]" << std::endl;
+    }
 
     void send(const google::protobuf::Message& msg, int socket_id, const std::string& group = "");
     void subscribe(const std::string& identifier, int socket_id);
     void subscribe(const std::string& protobuf_type_name, int socket_id, const std::string& group);
 
+    /// \brief Identifier ("group/type/") used on the wire for a given Protobuf type and group
+    static std::string make_identifier(const std::string& protobuf_type_name,
+                                       const std::string& group)
+    {
+        return group + "/" + protobuf_type_name + (protobuf_type_name.empty() ? "" : "/");
+    }
+
+    /// \brief Splits an identifier ("group/type/") into the Protobuf type name and group
+    static void parse_identifier(boost::string_ref identifier, std::string* protobuf_type_name,
+                                 std::string* group);
+
   private:
-    void inbox(common::MarshallingScheme marshalling_scheme, const std::string& identifier,
-               const std::string& body, int socket_id);
+    void inbox(common::MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+               boost::string_ref body, int socket_id);
 };
 
 class StaticProtobufNode : public ProtobufNode
@@ -112,14 +145,59 @@ class StaticProtobufNode : public ProtobufNode
 
     //@}
 
+  protected:
+    using common::NodeInterface<google::protobuf::Message>::inbox;
+    using ProtobufNode::protobuf_inbox;
+
+    /// \brief Number of identifiers ("group/type/") with cached subscriptions
+    std::size_t dispatch_table_size() const { return dispatch_.size(); }
+
   private:
-    void protobuf_inbox(const std::string& protobuf_type_name, const std::string& body,
+    void inbox(common::MarshallingScheme marshalling_scheme, boost::string_ref identifier,
+               boost::string_ref body, int socket_id);
+
+    void protobuf_inbox(const std::string& protobuf_type_name, boost::string_ref body,
                         int socket_id, const std::string& group);
 
+    // hash and equality that treat std::string and boost::string_ref alike so that
+    // the dispatch table can be searched without constructing a std::string
+    struct IdentifierHash
+    {
+        std::size_t operator()(boost::string_ref s) const
+        {
+            return boost::hash_range(s.begin(), s.end());
+        }
+    };
+    struct IdentifierEqual
+    {
+        bool operator()(boost::string_ref a, boost::string_ref b) const { return a == b; }
+    };
+
+    struct DispatchEntry
+    {
+        std::string protobuf_type_name;
+        std::string group;
+        std::vector<boost::shared_ptr<SubscriptionBase> > subscriptions;
+    };
+
+    typedef boost::unordered_map<std::string, DispatchEntry, IdentifierHash, IdentifierEqual>
+        DispatchTable;
+
+    DispatchTable::iterator add_dispatch_entry(boost::string_ref identifier);
+    void make_dispatch_entry(boost::string_ref identifier, DispatchEntry* entry);
+    void add_to_dispatch_table(boost::shared_ptr<SubscriptionBase> subscription);
+
   private:
     // key = type of var
     // value = Subscription object for all the subscriptions,  handler, newest message, etc.
     boost::unordered_multimap<std::string, boost::shared_ptr<SubscriptionBase> > subscriptions_;
+
+    // key = identifier ("group/type/")
+    // value = all the subscriptions that match this identifier
+    // entries are created at subscribe time, or upon first receipt of a given identifier
+    // (for subscriptions with an empty group, which match any group). Identifiers without
+    // subscriptions are never cached
+    DispatchTable dispatch_;
 };
 
 class DynamicProtobufNode : public ProtobufNode
@@ -129,6 +207,8 @@ class DynamicProtobufNode : public ProtobufNode
 
     virtual ~DynamicProtobufNode() {}
 
+    using ProtobufNode::protobuf_inbox;
+
     void subscribe(int socket_id,
                    boost::function<void(boost::shared_ptr<google::protobuf::Message> msg)> handler,
                    const std::string& group);
@@ -141,6 +221,9 @@ class DynamicProtobufNode : public ProtobufNode
         subscribe(socket_id, boost::bind(mem_func, obj, _1), group);
     }
 
+    /// \brief Register a handler for messages of any type published to `group`
+    ///
+    /// Each received message is parsed once and the same message is passed to every handler registered for its group (earlier versions only called the first handler registered for a group).
     void on_receipt(int socket_id,
                     boost::function<void(boost::shared_ptr<google::protobuf::Message> msg)> handler,
                     const std::string& group);
@@ -156,7 +239,7 @@ class DynamicProtobufNode : public ProtobufNode
     // virtual void dynamic_protobuf_inbox(boost::shared_ptr<google::protobuf::Message> msg, int socket_id, const std::string& group) = 0;
 
   private:
-    void protobuf_inbox(const std::string& protobuf_type_name, const std::string& body,
+    void protobuf_inbox(const std::string& protobuf_type_name, boost::string_ref body,
                         int socket_id, const std::string& group);
 
   private:
@@ -188,6 +271,7 @@ void goby::pb::StaticProtobufNode::on_receipt(
     boost::shared_ptr<SubscriptionBase> subscription(
         new Subscription<ProtoBufMessage>(handler, protobuf_type_name, group));
     subscriptions_.insert(std::make_pair(protobuf_type_name, subscription));
+    add_to_dispatch_table(subscription);
 }
 
 template <typename ProtoBufMessage>
@@ -202,6 +286,10 @@ void goby::pb::StaticProtobufNode::subscribe(int socket_id,
     glog.is(goby::common::logger::DEBUG1) && glog << "subscribing for " << protobuf_type_name
                                                   << std::endl;
 
+    const std::string identifier = make_identifier(protobuf_type_name, group);
+    if (dispatch_.find(identifier) == dispatch_.end())
+        add_dispatch_entry(identifier);
+
     ProtobufNode::subscribe(protobuf_type_name, socket_id, group);
 }
 
@@ -25,6 +25,7 @@
 
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/dynamic_message.h>
 
@@ -37,7 +38,12 @@ namespace pb
 class SubscriptionBase
 {
   public:
-    virtual void post(const std::string& body) = 0;
+    // parse and handle an incoming message
+    virtual void post(boost::string_ref body) = 0;
+    // parse an incoming message into a new (immutable) message of this subscription's type
+    virtual boost::shared_ptr<const google::protobuf::Message> parse(boost::string_ref body) const = 0;
+    // handle a message already parsed by parse() of a Subscription of the same type
+    virtual void post(boost::shared_ptr<const google::protobuf::Message> msg) = 0;
     virtual const google::protobuf::Message& newest() const = 0;
     virtual const std::string& type_name() const = 0;
     virtual const std::string& group() const = 0;
@@ -53,28 +59,47 @@ template <typename ProtoBufMessage> class Subscription : public SubscriptionBase
     typedef boost::function<void(const ProtoBufMessage&)> HandlerType;
 
     Subscription(HandlerType& handler, const std::string& type_name, const std::string& group = "")
-        : handler_(handler), type_name_(type_name), group_(group)
+        : handler_(handler), newest_msg_(new ProtoBufMessage), type_name_(type_name), group_(group)
     {
     }
 
     // handle an incoming message (serialized using the google::protobuf
     // library calls)
-    void post(const std::string& body)
+    void post(boost::string_ref body)
     {
-        newest_msg_.ParseFromString(body);
+        // reuse the newest message if no other Subscription shares it
+        if (!newest_msg_.unique())
+            newest_msg_.reset(new ProtoBufMessage);
+
+        boost::const_pointer_cast<ProtoBufMessage>(newest_msg_)
+            ->ParseFromArray(body.data(), body.size());
+        if (handler_)
+            handler_(*newest_msg_);
+    }
+
+    boost::shared_ptr<const google::protobuf::Message> parse(boost::string_ref body) const
+    {
+        boost::shared_ptr<ProtoBufMessage> msg(new ProtoBufMessage);
+        msg->ParseFromArray(body.data(), body.size());
+        return msg;
+    }
+
+    void post(boost::shared_ptr<const google::protobuf::Message> msg)
+    {
+        newest_msg_ = boost::static_pointer_cast<const ProtoBufMessage>(msg);
         if (handler_)
-            handler_(newest_msg_);
+            handler_(*newest_msg_);
     }
 
     // getters
-    const google::protobuf::Message& newest() const { return newest_msg_; }
+    const google::protobuf::Message& newest() const { return *newest_msg_; }
     const std::string& type_name() const { return type_name_; }
     const std::string& group() const { return group_; }
     bool has_valid_handler() const { return handler_; }
 
   private:
     HandlerType handler_;
-    ProtoBufMessage newest_msg_;
+    boost::shared_ptr<const ProtoBufMessage> newest_msg_;
     const std::string type_name_;
     const std::string group_;
 };
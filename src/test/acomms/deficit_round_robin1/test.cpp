@@ -0,0 +1,185 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests the deficit round robin used by goby_ip_gateway: two backlogged flows share the link
+// fairly (by bytes, in proportion to their quanta), even with a one byte quantum, and the
+// choices match visiting the destinations one at a time
+
+#include <cassert>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+
+#include "goby/acomms/deficit_round_robin.h"
+
+using goby::acomms::DeficitRoundRobin;
+
+// the straightforward version: step through the destinations one visit at a time
+class SteppedDRR
+{
+  public:
+    SteppedDRR() : next_dest_(0), in_turn_(false) {}
+
+    int choose(const std::map<int, DeficitRoundRobin::Backlog>& backlog)
+    {
+        for (std::map<int, int>::iterator it = deficit_.begin(); it != deficit_.end(); ++it)
+        {
+            if (!backlog.count(it->first) && it->second > 0)
+                it->second = 0;
+        }
+
+        std::map<int, DeficitRoundRobin::Backlog>::const_iterator it =
+            backlog.lower_bound(next_dest_);
+        while (true)
+        {
+            if (it == backlog.end())
+                it = backlog.begin();
+            if (!(in_turn_ && it->first == next_dest_))
+                deficit_[it->first] += std::max(1, it->second.quantum);
+            in_turn_ = false;
+            if (deficit_[it->first] >= it->second.head_size)
+                return it->first;
+            ++it;
+        }
+    }
+
+    void sent(int dest, int bytes) { deficit_[dest] -= bytes; }
+
+    void end_turn(int dest, int next_head_size)
+    {
+        if (next_head_size == 0 && deficit_[dest] > 0)
+            deficit_[dest] = 0;
+        in_turn_ = next_head_size > 0 && deficit_[dest] >= next_head_size;
+        next_dest_ = in_turn_ ? dest : dest + 1;
+    }
+
+    int deficit(int dest) { return deficit_[dest]; }
+
+  private:
+    std::map<int, int> deficit_;
+    int next_dest_;
+    bool in_turn_;
+};
+
+// two always backlogged flows (destinations 1 and 2), one packet per transmission
+void share(int size1, int quantum1, int size2, int quantum2, int transmissions, long* bytes1,
+           long* bytes2)
+{
+    DeficitRoundRobin drr;
+    std::map<int, DeficitRoundRobin::Backlog> backlog;
+    backlog[1] = DeficitRoundRobin::Backlog(size1, quantum1);
+    backlog[2] = DeficitRoundRobin::Backlog(size2, quantum2);
+
+    *bytes1 = 0;
+    *bytes2 = 0;
+    for (int i = 0; i < transmissions; ++i)
+    {
+        int dest;
+        assert(drr.choose(backlog, &dest));
+        int size = backlog[dest].head_size;
+        drr.sent(dest, size);
+        drr.end_turn(dest, size);
+        (dest == 1 ? *bytes1 : *bytes2) += size;
+    }
+}
+
+// random queues, each transmission sends up to three packets from the chosen destination
+void compare_stepped(int max_quantum)
+{
+    const int num_dest = 4;
+    std::map<int, std::deque<int> > queues;
+    std::map<int, int> quanta;
+    for (int d = 0; d < num_dest; ++d) quanta[d] = std::rand() % max_quantum;
+
+    DeficitRoundRobin drr;
+    SteppedDRR stepped;
+    std::map<int, DeficitRoundRobin::Backlog> backlog;
+    for (int i = 0; i < 2000; ++i)
+    {
+        for (int d = 0; d < num_dest; ++d)
+        {
+            if (std::rand() % 3 == 0)
+                queues[d].push_back(1 + std::rand() % 1500);
+        }
+
+        backlog.clear();
+        for (int d = 0; d < num_dest; ++d)
+        {
+            if (!queues[d].empty())
+                backlog[d] = DeficitRoundRobin::Backlog(queues[d].front(), quanta[d]);
+        }
+
+        int dest = -1;
+        if (!drr.choose(backlog, &dest))
+        {
+            assert(backlog.empty());
+            continue;
+        }
+        assert(dest == stepped.choose(backlog));
+
+        std::deque<int>& queue = queues[dest];
+        for (int f = 0; f < 3 && !queue.empty(); ++f)
+        {
+            drr.sent(dest, queue.front());
+            stepped.sent(dest, queue.front());
+            queue.pop_front();
+        }
+        drr.end_turn(dest, queue.empty() ? 0 : queue.front());
+        stepped.end_turn(dest, queue.empty() ? 0 : queue.front());
+
+        for (int d = 0; d < num_dest; ++d)
+        {
+            if (!queues[d].empty())
+                assert(drr.deficit(d) == stepped.deficit(d));
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int mtu = 1500;
+    const int transmissions = 10000;
+    long bytes1, bytes2;
+
+    // equal quanta, packets of very different sizes: equal bytes, give or take a packet
+    share(mtu, mtu, 100, mtu, transmissions, &bytes1, &bytes2);
+    std::cout << "equal quanta: " << bytes1 << " / " << bytes2 << " bytes" << std::endl;
+    assert(std::labs(bytes1 - bytes2) <= 2 * mtu);
+
+    // a one byte quantum shares just the same
+    share(mtu, 1, 100, 1, transmissions, &bytes1, &bytes2);
+    std::cout << "one byte quanta: " << bytes1 << " / " << bytes2 << " bytes" << std::endl;
+    assert(std::labs(bytes1 - bytes2) <= 2 * mtu);
+
+    // twice the quantum, twice the bytes
+    share(mtu, 2 * mtu, 100, mtu, transmissions, &bytes1, &bytes2);
+    std::cout << "2:1 quanta: " << bytes1 << " / " << bytes2 << " bytes" << std::endl;
+    assert(std::labs(bytes1 - 2 * bytes2) <= 4 * mtu);
+
+    std::srand(1);
+    compare_stepped(mtu);
+    compare_stepped(10);
+    compare_stepped(3 * mtu);
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
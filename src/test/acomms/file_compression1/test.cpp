@@ -0,0 +1,215 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests goby_file_transfer payload compression round trips and fallback, and reports the bytes on
+// the wire saved for representative files
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "goby/acomms/file_compression.h"
+#include "goby/common/exception.h"
+#include "goby/common/logger.h"
+
+using goby::glog;
+using namespace goby::common::logger;
+using goby::acomms::protobuf::TransferRequest;
+
+const TransferRequest::Compression algorithms[] = {TransferRequest::UNCOMPRESSED,
+                                                   TransferRequest::ZLIB, TransferRequest::LZMA};
+const int num_algorithms = sizeof(algorithms) / sizeof(algorithms[0]);
+const std::size_t max_size = 1024 * 1024;
+
+std::string mission_config()
+{
+    std::string cfg = "ProcessConfig = pAcommsHandler\n{\n  common {\n    verbosity: DEBUG1\n  }\n"
+                      "  modem_id: 1\n  driver_type: DRIVER_WHOI_MICROMODEM\n";
+    char buf[512];
+    for (int i = 0; i < 40; ++i)
+    {
+        snprintf(buf, sizeof(buf),
+                 "  queue_cfg {\n    message_entry {\n      protobuf_name: \"goby.moos.protobuf."
+                 "Message%d\"\n      ack: %s\n      blackout_time: %d\n      ttl: %d\n"
+                 "      value_base: %d\n      role { type: SOURCE_ID field: \"src\" }\n"
+                 "      role { type: DESTINATION_ID field: \"dest\" }\n    }\n  }\n",
+                 i, (i % 3) ? "false" : "true", 10 * (i % 7), 1800, 1 + i % 5);
+        cfg += buf;
+    }
+    return cfg + "}\n";
+}
+
+std::string csv()
+{
+    std::string csv = "time,lat,lon,depth,temperature,salinity\n";
+    char buf[128];
+    double lat = 42.358, lon = -71.087, depth = 0;
+    for (int i = 0; i < 600; ++i)
+    {
+        lat += (rand() % 21 - 10) * 1e-6;
+        lon += (rand() % 21 - 10) * 1e-6;
+        depth = std::abs(depth + (rand() % 11 - 5) * 0.1);
+        snprintf(buf, sizeof(buf), "%.1f,%.6f,%.6f,%.1f,%.3f,%.3f\n", 1542715200.0 + i, lat, lon,
+                 depth, 12 + (rand() % 1000) * 1e-3, 34 + (rand() % 1000) * 1e-3);
+        csv += buf;
+    }
+    return csv;
+}
+
+std::string log_snippet()
+{
+    std::string log;
+    char buf[256];
+    for (int i = 0; i < 300; ++i)
+    {
+        snprintf(buf, sizeof(buf),
+                 "goby_file_transfer [2018-Nov-20 12:%02d:%02d.%03d]: Received fragment #%d, "
+                 "total received: %d\n",
+                 (i / 10) % 60, (i * 7) % 60, rand() % 1000, i, i + 1);
+        log += buf;
+    }
+    return log;
+}
+
+std::string random_bytes(int size)
+{
+    std::string bytes(size, 0);
+    for (int i = 0; i < size; ++i) bytes[i] = rand() & 0xFF;
+    return bytes;
+}
+
+int wire_bytes(std::size_t payload_size)
+{
+    const int fragment_data = goby::acomms::protobuf::FileFragment::descriptor()
+                                  ->FindFieldByName("data")
+                                  ->options()
+                                  .GetExtension(dccl::field)
+                                  .max_length();
+    const int fragment_bytes = goby::acomms::protobuf::FileFragment::descriptor()
+                                   ->options()
+                                   .GetExtension(dccl::msg)
+                                   .max_bytes();
+    return std::ceil((double)payload_size / fragment_data) * fragment_bytes;
+}
+
+// returns the algorithm actually used
+TransferRequest::Compression round_trip(TransferRequest::Compression compression,
+                                        const std::string& in, std::string* out)
+{
+    TransferRequest::Compression used = goby::acomms::compress(compression, in, out);
+    assert(used == compression || used == TransferRequest::UNCOMPRESSED);
+    assert(out->size() <= in.size());
+    if (used == TransferRequest::UNCOMPRESSED)
+        assert(*out == in);
+
+    std::string decompressed;
+    goby::acomms::decompress(used, *out, &decompressed, max_size);
+    assert(decompressed == in);
+    return used;
+}
+
+bool throws(TransferRequest::Compression compression, const std::string& in, std::size_t max)
+{
+    try
+    {
+        std::string out;
+        goby::acomms::decompress(compression, in, &out, max);
+    }
+    catch (goby::Exception& e)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    srand(1);
+
+    assert(goby::acomms::compression_available(TransferRequest::UNCOMPRESSED));
+
+    const char* names[] = {"mission config", "csv", "log snippet", "random"};
+    const std::string files[] = {mission_config(), csv(), log_snippet(), random_bytes(20000)};
+
+    for (int f = 0; f < 4; ++f)
+    {
+        glog << names[f] << " (" << files[f].size() << " bytes):" << std::endl;
+        const int raw_wire = wire_bytes(files[f].size());
+        for (int a = 0; a < num_algorithms; ++a)
+        {
+            if (!goby::acomms::compression_available(algorithms[a]))
+            {
+                // falls back rather than failing
+                std::string out;
+                assert(goby::acomms::compress(algorithms[a], files[f], &out) ==
+                       TransferRequest::UNCOMPRESSED);
+                assert(throws(algorithms[a], out, max_size));
+                glog << "\t" << TransferRequest::Compression_Name(algorithms[a])
+                     << ": not available in this build" << std::endl;
+                continue;
+            }
+
+            std::string out;
+            TransferRequest::Compression used = round_trip(algorithms[a], files[f], &out);
+            const int wire = wire_bytes(out.size());
+            glog << "\t" << TransferRequest::Compression_Name(algorithms[a]) << ": "
+                 << out.size() << " bytes payload, " << wire << " bytes on the wire ("
+                 << 100 - (100 * wire / raw_wire) << "% saved"
+                 << (used != algorithms[a] ? ", fell back to UNCOMPRESSED" : "") << ")"
+                 << std::endl;
+
+            // text compresses at least 2:1, random data is sent as is
+            if (algorithms[a] != TransferRequest::UNCOMPRESSED)
+                assert(f == 3 ? used == TransferRequest::UNCOMPRESSED
+                              : 2 * out.size() < files[f].size());
+        }
+    }
+
+    // edge cases
+    for (int a = 0; a < num_algorithms; ++a)
+    {
+        if (!goby::acomms::compression_available(algorithms[a]))
+            continue;
+
+        std::string out;
+        assert(round_trip(algorithms[a], "", &out) == TransferRequest::UNCOMPRESSED);
+        round_trip(algorithms[a], std::string(1, 'x'), &out);
+        round_trip(algorithms[a], std::string(max_size, 'x'), &out);
+
+        // corruption and oversized output are rejected
+        const std::string config = mission_config();
+        if (round_trip(algorithms[a], config, &out) != TransferRequest::UNCOMPRESSED)
+        {
+            assert(throws(algorithms[a], out, config.size() - 1));
+            assert(!throws(algorithms[a], out, config.size()));
+            std::string truncated = out.substr(0, out.size() / 2);
+            assert(throws(algorithms[a], truncated, max_size));
+        }
+        assert(throws(TransferRequest::UNCOMPRESSED, config, config.size() - 1));
+    }
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,149 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests the goby_file_transfer selective-repeat protocol over a simulated link: clean, with the
+// last fragment dropped, and with random loss
+
+#include <cassert>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+
+#include "goby/acomms/file_fragment_window.h"
+#include "goby/common/logger.h"
+
+using namespace goby::acomms;
+using goby::acomms::protobuf::FileFragment;
+using goby::acomms::protobuf::FileFragmentNack;
+
+const int window_size = 8;
+const double retransmit_timeout = 120;
+const int nack_interval = 8;
+const double nack_timeout = 60;
+const double request_timeout = 1200;
+
+enum Loss
+{
+    NO_LOSS,
+    DROP_LAST_ONCE,
+    RANDOM_LOSS
+};
+
+// one second steps, one fragment and one NACK delivered per step
+// returns the simulated time taken to receive the whole file, or -1
+double transfer(const std::string& data, Loss loss, int* fragments_sent)
+{
+    FileFragmentSender sender(data, protobuf::TransferRequest::UNCOMPRESSED, window_size,
+                              retransmit_timeout, 0);
+    FileFragmentReceiver receiver;
+
+    std::deque<FileFragment> to_receiver;
+    std::deque<FileFragmentNack> to_sender;
+    bool last_dropped = false;
+    *fragments_sent = 0;
+
+    for (double now = 0; now < request_timeout; now += 1)
+    {
+        if (sender.check_timer(now) == FileFragmentSender::TIMER_RESEND)
+            std::cout << now << ": retransmission timeout" << std::endl;
+
+        int index = 0;
+        while (sender.next_fragment(&index))
+        {
+            FileFragment fragment;
+            fragment.set_src(1);
+            fragment.set_dest(2);
+            sender.get_fragment(index, &fragment);
+            ++*fragments_sent;
+
+            if (loss == DROP_LAST_ONCE && fragment.is_last_fragment() && !last_dropped)
+                last_dropped = true;
+            else if (loss == RANDOM_LOSS && rand() % 4 == 0)
+                continue;
+            else
+                to_receiver.push_back(fragment);
+        }
+
+        const bool idle = receiver.nack_due(now, nack_timeout, request_timeout);
+        bool send_nack = idle;
+        if (!to_receiver.empty())
+        {
+            send_nack |= receiver.add_fragment(to_receiver.front(), nack_interval, now);
+            to_receiver.pop_front();
+            if (receiver.all_received())
+            {
+                std::string received;
+                receiver.assemble(&received);
+                assert(received == data);
+                return now;
+            }
+        }
+
+        if (send_nack)
+        {
+            FileFragmentNack nack;
+            nack.set_src(2);
+            nack.set_dest(1);
+            receiver.make_nack(&nack, now, idle);
+            if (loss != RANDOM_LOSS || rand() % 4 != 0)
+                to_sender.push_back(nack);
+        }
+
+        if (!to_sender.empty())
+        {
+            assert(sender.handle_nack(to_sender.front(), now));
+            to_sender.pop_front();
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    srand(1);
+    std::string data(100 * FileFragmentSender::fragment_size() + 13, 0);
+    for (std::string::iterator it = data.begin(), end = data.end(); it != end; ++it)
+        *it = rand();
+    const int num_fragments = 101;
+
+    int sent = 0;
+    double t = transfer(data, NO_LOSS, &sent);
+    std::cout << "no loss: " << t << " s, " << sent << " fragments sent" << std::endl;
+    assert(t >= 0 && sent == num_fragments);
+
+    // the receiver keeps sending NACKs that show no progress; these must not hold off the
+    // retransmission of the end of the file
+    t = transfer(data, DROP_LAST_ONCE, &sent);
+    std::cout << "last fragment dropped: " << t << " s, " << sent << " fragments sent"
+              << std::endl;
+    assert(t >= 0 && t < num_fragments + 2 * nack_timeout + retransmit_timeout);
+    assert(sent == num_fragments + 1);
+
+    t = transfer(data, RANDOM_LOSS, &sent);
+    std::cout << "25% loss: " << t << " s, " << sent << " fragments sent" << std::endl;
+    assert(t >= 0);
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
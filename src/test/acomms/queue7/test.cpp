@@ -0,0 +1,144 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// differential test of QueueManager's priority contest against the linear scan of every queue
+
+#include <cstdlib>
+
+#include "goby/acomms/acomms_constants.h"
+#include "goby/acomms/queue.h"
+#include "goby/common/logger.h"
+#include "goby/util/dynamic_protobuf_manager.h"
+#include "test.pb.h"
+
+using goby::acomms::operator<<;
+
+class QueueManagerTester : public goby::acomms::QueueManager
+{
+  public:
+    using goby::acomms::QueueManager::find_next_sender;
+    using goby::acomms::QueueManager::find_next_sender_linear;
+};
+
+const int MY_MODEM_ID = 1;
+goby::uint64 now_ = 1000000000000000ull;
+goby::uint64 test_time() { return now_; }
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::common::goby_time_function = &test_time;
+    std::srand(1);
+
+    std::vector<const google::protobuf::Descriptor*> descs;
+    descs.push_back(Msg0::descriptor());
+    descs.push_back(Msg1::descriptor());
+    descs.push_back(Msg2::descriptor());
+    descs.push_back(Msg3::descriptor());
+    descs.push_back(Msg4::descriptor());
+    descs.push_back(Msg5::descriptor());
+
+    QueueManagerTester q_manager;
+    goby::acomms::protobuf::QueueManagerConfig cfg;
+    cfg.set_modem_id(MY_MODEM_ID);
+    q_manager.set_cfg(cfg);
+
+    for (int i = 0, n = descs.size(); i < n; ++i)
+    {
+        goby::acomms::protobuf::QueuedMessageEntry q_entry;
+        q_entry.set_protobuf_name(descs[i]->full_name());
+        goby::acomms::protobuf::QueuedMessageEntry::Role* dest_role = q_entry.add_role();
+        dest_role->set_type(goby::acomms::protobuf::QueuedMessageEntry::DESTINATION_ID);
+        dest_role->set_field("dest");
+
+        q_entry.set_ack(i % 3 == 0);
+        q_entry.set_blackout_time(i % 2 ? 0 : 3);
+        q_entry.set_ttl(60 * (i + 1));
+        // two pairs of queues with the same priority growth rate
+        q_entry.set_value_base(i < 4 ? (i / 2 + 1) * (i + 1) : i);
+        q_entry.set_newest_first(i % 2);
+        q_entry.set_max_queue(10);
+        q_manager.add_queue(descs[i], q_entry);
+    }
+
+    int contests = 0, winners = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        // sometimes advance by exactly the same amount, sometimes not at all (for ties)
+        now_ += (std::rand() % 3 == 0) ? 0 : (std::rand() % 4) * 1000000 + std::rand() % 1000;
+
+        for (int j = 0, n = std::rand() % 3; j < n; ++j)
+        {
+            const google::protobuf::Descriptor* desc = descs[std::rand() % descs.size()];
+            boost::shared_ptr<google::protobuf::Message> msg =
+                goby::util::DynamicProtobufManager::new_protobuf_message(desc);
+            const google::protobuf::Reflection* refl = msg->GetReflection();
+            const int dests[] = {goby::acomms::BROADCAST_ID, 2, 3};
+            refl->SetInt32(msg.get(), desc->FindFieldByName("dest"), dests[std::rand() % 3]);
+            if (const google::protobuf::FieldDescriptor* text = desc->FindFieldByName("text"))
+                refl->SetString(msg.get(), text, std::string(std::rand() % 5, 'a'));
+            q_manager.push_message(*msg);
+        }
+
+        goby::acomms::protobuf::ModemTransmission request;
+        request.set_max_frame_bytes(4 + std::rand() % 32);
+        switch (std::rand() % 3)
+        {
+            case 0: request.set_dest(goby::acomms::QUERY_DESTINATION_ID); break;
+            case 1: request.set_dest(goby::acomms::BROADCAST_ID); break;
+            case 2: request.set_dest(2 + std::rand() % 2); break;
+        }
+        if (std::rand() % 2)
+            request.set_ack_requested(std::rand() % 2);
+        std::string data(std::rand() % request.max_frame_bytes(), '\0');
+
+        goby::acomms::Queue* expected = q_manager.find_next_sender_linear(request, data);
+        goby::acomms::Queue* result = q_manager.find_next_sender(request, data, data.empty());
+        if (result != expected)
+        {
+            std::cerr << "Mismatch at contest " << i << ": expected "
+                      << (expected ? expected->name() : "none") << ", got "
+                      << (result ? result->name() : "none") << std::endl;
+            return 1;
+        }
+        ++contests;
+        if (result)
+            ++winners;
+
+        // change the queues by sending
+        if (std::rand() % 2)
+        {
+            goby::acomms::protobuf::ModemTransmission transmission;
+            transmission.set_max_frame_bytes(8 + std::rand() % 32);
+            transmission.set_frame_start(std::rand() % 4);
+            q_manager.handle_modem_data_request(&transmission);
+        }
+        if (std::rand() % 10 == 0)
+            q_manager.do_work();
+    }
+
+    std::cout << contests << " contests (" << winners << " with a winner) agreed" << std::endl;
+    assert(winners > 0);
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,178 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests RUDICS packet framing round trips, compatibility of the default framing and the cost of
+// BASE_CONVERT vs. BLOCK_BASE_CONVERT
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "goby/acomms/modemdriver/rudics_packet.h"
+#include "goby/common/logger.h"
+#include "goby/common/time.h"
+#include "goby/util/binary.h"
+
+using goby::glog;
+using namespace goby::common::logger;
+using goby::acomms::parse_rudics_packet;
+using goby::acomms::RudicsPacketException;
+using goby::acomms::serialize_rudics_packet;
+
+const std::string default_reserved = std::string("\0\r\n", 3) + std::string(1, 0xff);
+
+std::string random_bytes(int size)
+{
+    std::string bytes(size, 0);
+    for (int i = 0; i < size; ++i) bytes[i] = rand() & 0xFF;
+    // leading zeros must survive
+    if (size > 2)
+        bytes[0] = bytes[1] = 0;
+    return bytes;
+}
+
+void round_trip(const std::string& bytes, IridiumDriverConfig::RudicsEncoding encoding,
+                const std::string& reserved, bool include_crc)
+{
+    std::string rudics_pkt;
+    serialize_rudics_packet(bytes, &rudics_pkt, encoding, reserved, include_crc);
+    assert(rudics_pkt[rudics_pkt.size() - 1] == '\r');
+    assert(rudics_pkt.find_first_of(reserved) == rudics_pkt.size() - 1);
+
+    std::string decoded;
+    parse_rudics_packet(&decoded, rudics_pkt, encoding, reserved, include_crc);
+    assert(decoded == bytes);
+
+    // reserved characters within the packet are discarded as junk
+    std::string junk_pkt = rudics_pkt;
+    junk_pkt.insert(junk_pkt.size() / 2, reserved.substr(0, 1));
+    decoded.clear();
+    parse_rudics_packet(&decoded, junk_pkt, encoding, reserved, include_crc);
+    assert(decoded == bytes);
+}
+
+double time_framing(const std::string& bytes, IridiumDriverConfig::RudicsEncoding encoding,
+                    int repeat)
+{
+    std::string rudics_pkt, decoded;
+    double start = goby::common::goby_time<double>();
+    for (int i = 0; i < repeat; ++i)
+    {
+        serialize_rudics_packet(bytes, &rudics_pkt, encoding);
+        parse_rudics_packet(&decoded, rudics_pkt, encoding);
+    }
+    assert(decoded == bytes);
+    return (goby::common::goby_time<double>() - start) / repeat;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    srand(1);
+
+    // known packets, so the framing cannot change unnoticed
+    {
+        std::string rudics_pkt;
+        serialize_rudics_packet(std::string("\0\1", 2), &rudics_pkt,
+                                IridiumDriverConfig::BLOCK_BASE_CONVERT, "\r", false);
+        assert(rudics_pkt == std::string("\0\0\1\r", 4));
+
+        serialize_rudics_packet(std::string("\0\1", 2), &rudics_pkt,
+                                IridiumDriverConfig::BLOCK_BASE_CONVERT, default_reserved, false);
+        assert(rudics_pkt == "\xfc\xfc\x01\r");
+
+        serialize_rudics_packet(std::string("\0\1", 2), &rudics_pkt,
+                                IridiumDriverConfig::BASE_CONVERT, "\r", false);
+        assert(rudics_pkt == "\1\1\r");
+    }
+
+    for (int size = 0; size < 1600; size += (size < 300 ? 1 : 97))
+    {
+        std::string bytes = random_bytes(size);
+
+        round_trip(bytes, IridiumDriverConfig::BASE_CONVERT, default_reserved, true);
+        round_trip(bytes, IridiumDriverConfig::BLOCK_BASE_CONVERT, default_reserved, true);
+        // as used by the Benthos ATM-900 driver
+        round_trip(bytes, IridiumDriverConfig::BASE_CONVERT, "\r", false);
+        round_trip(bytes, IridiumDriverConfig::BLOCK_BASE_CONVERT, "\r", false);
+
+        // default is unchanged from the original framing
+        std::string default_pkt, base_convert_pkt, block_pkt;
+        serialize_rudics_packet(bytes, &default_pkt);
+        serialize_rudics_packet(bytes, &base_convert_pkt, IridiumDriverConfig::BASE_CONVERT);
+        assert(default_pkt == base_convert_pkt);
+
+        // at most one extra character per block
+        serialize_rudics_packet(bytes, &block_pkt, IridiumDriverConfig::BLOCK_BASE_CONVERT);
+        assert(block_pkt.size() <=
+               base_convert_pkt.size() + (size + 4) / goby::acomms::RUDICS_BLOCK_BYTES + 1);
+
+        // corruption is detected
+        if (size > 0)
+        {
+            block_pkt[block_pkt.size() / 2] ^= 0x01;
+            bool threw = false;
+            try
+            {
+                std::string decoded;
+                parse_rudics_packet(&decoded, block_pkt, IridiumDriverConfig::BLOCK_BASE_CONVERT);
+            }
+            catch (RudicsPacketException& e)
+            {
+                threw = true;
+            }
+            assert(threw);
+        }
+    }
+
+    // packets that cannot be BLOCK_BASE_CONVERT
+    {
+        const char* bad[] = {"\xfe\xfe\xfe\r", "\x01\r"};
+        for (int i = 0; i < 2; ++i)
+        {
+            bool threw = false;
+            try
+            {
+                std::string decoded;
+                parse_rudics_packet(&decoded, bad[i], IridiumDriverConfig::BLOCK_BASE_CONVERT,
+                                    "\r", false);
+            }
+            catch (RudicsPacketException& e)
+            {
+                threw = true;
+            }
+            assert(threw);
+        }
+    }
+
+    // relative cost for a full size frame
+    {
+        std::string bytes = random_bytes(1500);
+        double base_convert = time_framing(bytes, IridiumDriverConfig::BASE_CONVERT, 200);
+        double block = time_framing(bytes, IridiumDriverConfig::BLOCK_BASE_CONVERT, 200);
+        glog << "1500 byte packet: BASE_CONVERT: " << base_convert * 1e6
+             << " us, BLOCK_BASE_CONVERT: " << block * 1e6 << " us" << std::endl;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+}
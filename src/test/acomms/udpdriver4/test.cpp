@@ -0,0 +1,154 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests the UDPDriver in its own I/O thread, waking the caller of do_work() on new data
+
+#include "goby/acomms/modemdriver/udp_driver.h"
+
+#include "goby/acomms/connect.h"
+#include "goby/common/logger.h"
+#include <cstdlib>
+
+boost::asio::io_service io1, io2;
+boost::shared_ptr<goby::acomms::ModemDriverBase> driver1, driver2;
+
+boost::mutex data_ready_mutex;
+boost::condition_variable data_ready_cond;
+int data_ready_count = 0;
+
+bool received_data = false;
+bool received_ack = false;
+
+using namespace goby::acomms;
+
+// called from driver1's I/O thread
+void handle_data_ready()
+{
+    {
+        boost::mutex::scoped_lock lock(data_ready_mutex);
+        ++data_ready_count;
+    }
+    data_ready_cond.notify_one();
+}
+
+void handle_data_request2(protobuf::ModemTransmission* msg)
+{
+    msg->add_frame(std::string(10, 'a'));
+}
+
+void handle_data_receive1(const protobuf::ModemTransmission& msg)
+{
+    std::cout << "Driver 1 received: " << msg.ShortDebugString() << std::endl;
+    if (msg.type() == protobuf::ModemTransmission::DATA && msg.frame_size() == 1 &&
+        msg.frame(0) == std::string(10, 'a'))
+        received_data = true;
+}
+
+void handle_data_receive2(const protobuf::ModemTransmission& msg)
+{
+    std::cout << "Driver 2 received: " << msg.ShortDebugString() << std::endl;
+    if (msg.type() == protobuf::ModemTransmission::ACK && msg.acked_frame_size() == 1)
+        received_ack = true;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::DEBUG3, &std::clog);
+    goby::glog.set_name(argv[0]);
+
+    driver1.reset(new goby::acomms::UDPDriver(&io1));
+    driver2.reset(new goby::acomms::UDPDriver(&io2));
+
+    driver1->set_data_ready_callback(&handle_data_ready);
+
+    goby::acomms::protobuf::DriverConfig cfg1, cfg2;
+
+    srand(time(NULL));
+    int port1 = rand() % 1000 + 51010;
+    int port2 = port1 + 1;
+
+    cfg1.set_modem_id(1);
+    cfg1.MutableExtension(UDPDriverConfig::local)->set_port(port1);
+    cfg1.MutableExtension(UDPDriverConfig::remote)->set_ip("127.0.0.1");
+    cfg1.MutableExtension(UDPDriverConfig::remote)->set_port(port2);
+
+    cfg2.set_modem_id(2);
+    cfg2.MutableExtension(UDPDriverConfig::local)->set_port(port2);
+    cfg2.MutableExtension(UDPDriverConfig::remote)->set_ip("127.0.0.1");
+    cfg2.MutableExtension(UDPDriverConfig::remote)->set_port(port1);
+
+    goby::acomms::connect(&driver1->signal_receive, &handle_data_receive1);
+    goby::acomms::connect(&driver2->signal_receive, &handle_data_receive2);
+    goby::acomms::connect(&driver2->signal_data_request, &handle_data_request2);
+
+    driver1->startup(cfg1);
+    driver2->startup(cfg2);
+
+    // servicing driver1 before any data has arrived must not stop later deliveries
+    for (int i = 0; i < 5; ++i)
+    {
+        driver1->do_work();
+        usleep(10000);
+    }
+
+    protobuf::ModemTransmission transmit;
+    transmit.set_type(protobuf::ModemTransmission::DATA);
+    transmit.set_src(2);
+    transmit.set_dest(1);
+    transmit.set_ack_requested(true);
+    driver2->handle_initiate_transmission(transmit);
+    driver2->do_work();
+
+    // driver1 wakes us up rather than being polled
+    {
+        boost::mutex::scoped_lock lock(data_ready_mutex);
+        boost::system_time timeout = boost::get_system_time() + boost::posix_time::seconds(5);
+        while (data_ready_count == 0)
+        {
+            if (!data_ready_cond.timed_wait(lock, timeout))
+            {
+                std::cerr << "timed out waiting for data ready callback" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    driver1->do_work();
+    assert(received_data);
+
+    // the ack from driver1 is sent by its I/O thread
+    int i = 0;
+    while (((i / 10) < 5) && !received_ack)
+    {
+        driver1->do_work();
+        driver2->do_work();
+
+        usleep(100000);
+        ++i;
+    }
+    assert(received_ack);
+
+    driver1->shutdown();
+    driver2->shutdown();
+
+    std::cout << "all tests passed." << std::endl;
+    return 0;
+}
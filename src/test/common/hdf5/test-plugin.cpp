@@ -19,6 +19,8 @@
 // You should have received a copy of the GNU General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cstdlib>
+
 #include "goby/common/hdf5_plugin.h"
 
 #include "goby/common/time.h"
@@ -38,6 +40,7 @@ class TestHDF5Plugin : public goby::common::HDF5Plugin
     void fill_message(TestHDF5Message& msg);
 
   private:
+    int num_entries_;
 };
 
 extern "C"
@@ -49,15 +52,19 @@ extern "C"
 }
 
 TestHDF5Plugin::TestHDF5Plugin(goby::common::protobuf::HDF5Config* cfg)
-    : goby::common::HDF5Plugin(cfg)
+    : goby::common::HDF5Plugin(cfg), num_entries_(21)
 {
+    // larger logs for benchmarking
+    const char* num_entries = getenv("GOBY_HDF5_TEST_ENTRIES");
+    if (num_entries)
+        num_entries_ = atoi(num_entries);
 }
 
 bool TestHDF5Plugin::provide_entry(goby::common::HDF5ProtobufEntry* entry)
 {
     static int entry_index = 0;
 
-    if (entry_index > 20)
+    if (entry_index >= num_entries_)
         return false;
 
     if (entry_index < 3 || entry_index > 7)
@@ -82,7 +89,8 @@ bool TestHDF5Plugin::provide_entry(goby::common::HDF5ProtobufEntry* entry)
 
     entry->time = goby::common::goby_time<goby::uint64>();
 
-    std::cout << *entry << std::endl;
+    if (num_entries_ <= 100)
+        std::cout << *entry << std::endl;
 
     ++entry_index;
 
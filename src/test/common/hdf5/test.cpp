@@ -21,21 +21,141 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "H5Cpp.h"
 
 #include "goby/common/logger.h"
 
 using goby::glog;
 
+struct DatasetContents
+{
+    std::vector<hsize_t> dims;
+    std::vector<char> data;
+    std::vector<std::string> strings;
+};
+
+// key is the full path of the dataset
+typedef std::map<std::string, DatasetContents> FileContents;
+
+void read_group(const H5::Group& group, const std::string& path, FileContents* contents)
+{
+    for (hsize_t i = 0, n = group.getNumObjs(); i < n; ++i)
+    {
+        std::string name = group.getObjnameByIdx(i);
+        H5G_obj_t type = group.getObjTypeByIdx(i);
+        if (type == H5G_GROUP)
+        {
+            read_group(group.openGroup(name), path + "/" + name, contents);
+        }
+        else if (type == H5G_DATASET)
+        {
+            H5::DataSet dataset = group.openDataSet(name);
+            H5::DataSpace space = dataset.getSpace();
+            DatasetContents& dataset_contents = (*contents)[path + "/" + name];
+            dataset_contents.dims.resize(space.getSimpleExtentNdims());
+            space.getSimpleExtentDims(&dataset_contents.dims[0]);
+
+            hssize_t num_points = space.getSimpleExtentNpoints();
+            if (num_points == 0)
+                continue;
+
+            if (dataset.getTypeClass() == H5T_STRING)
+            {
+                H5::StrType string_type = dataset.getStrType();
+                std::vector<char*> strings(num_points, static_cast<char*>(0));
+                dataset.read(&strings[0], string_type);
+                for (int j = 0; j < num_points; ++j)
+                    dataset_contents.strings.push_back(strings[j] ? strings[j] : "");
+                H5::DataSet::vlenReclaim(&strings[0], string_type, space);
+            }
+            else
+            {
+                H5::DataType data_type = dataset.getDataType();
+                dataset_contents.data.resize(num_points * data_type.getSize());
+                dataset.read(&dataset_contents.data[0], data_type);
+            }
+        }
+    }
+}
+
+// true if both files hold the same datasets with the same values, except for the time columns,
+// which record when each run was made
+bool same_contents(const std::string& file_a, const std::string& file_b)
+{
+    FileContents a, b;
+    read_group(H5::H5File(file_a, H5F_ACC_RDONLY).openGroup("/"), "", &a);
+    read_group(H5::H5File(file_b, H5F_ACC_RDONLY).openGroup("/"), "", &b);
+
+    bool same = (a.size() == b.size());
+    for (FileContents::const_iterator it = a.begin(), end = a.end(); it != end; ++it)
+    {
+        if (it->first.find("/_utime_") != std::string::npos ||
+            it->first.find("/_datenum_") != std::string::npos)
+            continue;
+
+        FileContents::const_iterator b_it = b.find(it->first);
+        if (b_it == b.end() || b_it->second.dims != it->second.dims ||
+            b_it->second.data != it->second.data || b_it->second.strings != it->second.strings)
+        {
+            std::cout << it->first << " differs between " << file_a << " and " << file_b
+                      << std::endl;
+            same = false;
+        }
+    }
+    return same;
+}
+
+int run(const std::string& env, const std::string& args)
+{
+    std::string sys_cmd("LD_LIBRARY_PATH=" GOBY_LIB_DIR ":$LD_LIBRARY_PATH " + env +
+                        " GOBY_HDF5_PLUGIN=libgoby_hdf5test.so goby_hdf5 " + args);
+    std::cout << "Running: [" << sys_cmd << "]" << std::endl;
+    return system(sys_cmd.c_str());
+}
+
 int main(int argc, char* argv[])
 {
     goby::glog.add_stream(goby::common::logger::DEBUG3, &std::cerr);
     goby::glog.set_name(argv[0]);
 
-    std::string sys_cmd("LD_LIBRARY_PATH=" GOBY_LIB_DIR
-                        ":$LD_LIBRARY_PATH GOBY_HDF5_PLUGIN=libgoby_hdf5test.so goby_hdf5 "
-                        "--output_file /tmp/test.h5 --include_string_fields=true");
-    std::cout << "Running: [" << sys_cmd << "]" << std::endl;
-    int rc = system(sys_cmd.c_str());
+    int rc = run("", "--output_file /tmp/test.h5 --include_string_fields=true");
+
+    // small chunks so that datasets are extended several times, including repeated fields
+    // that grow after the first chunk
+    if (rc == 0)
+        rc = run("", "--output_file /tmp/test-streaming.h5 --include_string_fields=true "
+                     "--streaming=true --chunk_size=4");
+    if (rc == 0 && !same_contents("/tmp/test.h5", "/tmp/test-streaming.h5"))
+        rc = 1;
+
+    // flattening on worker threads must give the same file as flattening serially
+    if (rc == 0)
+        rc = run("", "--output_file /tmp/test-threads.h5 --include_string_fields=true "
+                     "--streaming=true --chunk_size=4 --threads=4 --compression_level=6");
+    if (rc == 0 && !same_contents("/tmp/test-streaming.h5", "/tmp/test-threads.h5"))
+        rc = 1;
+    if (rc == 0)
+        rc = run("", "--output_file /tmp/test-threads-all.h5 --include_string_fields=true "
+                     "--streaming=true --chunk_size=4 --threads=0");
+    if (rc == 0 && !same_contents("/tmp/test-streaming.h5", "/tmp/test-threads-all.h5"))
+        rc = 1;
+
+    // rows/s and peak memory use for a larger log, whole log in memory vs. streaming; only run
+    // when asked for, e.g. GOBY_HDF5_TEST_ENTRIES=20000
+    const char* benchmark_entries = getenv("GOBY_HDF5_TEST_ENTRIES");
+    if (rc == 0 && benchmark_entries)
+    {
+        const std::string benchmark_args(
+            "--base 'glog_config { tty_verbosity: VERBOSE }' "
+            "--output_file /tmp/test-benchmark.h5");
+        rc = run("", benchmark_args);
+        if (rc == 0)
+            rc = run("", benchmark_args + " --streaming=true");
+    }
 
     if (rc == 0)
     {
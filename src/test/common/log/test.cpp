@@ -20,6 +20,7 @@
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "goby/common/logger.h"
+#include "goby/util/as.h"
 #include <cassert>
 
 #include <sstream>
@@ -167,6 +168,35 @@ int main()
     glog << group("test1") << "test1 group ok" << std::endl;
     glog.is(WARN) && glog << group("test2") << "test2 group warning ok" << std::endl;
 
+    std::cout << "checking asynchronous writing ... " << std::endl;
+    std::stringstream ss2;
+    glog.add_stream(DEBUG1, &ss2);
+    glog.enable_async(10);
+    assert(glog.buf().is_async());
+    for (int i = 0; i < 5; ++i) glog.is(DEBUG1) && glog << "async " << i << std::endl;
+    glog.disable_async();
+    assert(!glog.buf().is_async());
+
+    std::string line;
+    for (int i = 0; i < 5; ++i)
+    {
+        std::getline(ss2, line);
+        assert(line.find("async " + goby::util::as<std::string>(i)) != std::string::npos);
+    }
+
+    std::stringstream ss3;
+    glog.add_stream(DEBUG1, &ss3);
+    glog.enable_async(2);
+    const int flood = 100;
+    for (int i = 0; i < flood; ++i) glog.is(DEBUG1) && glog << "flood " << i << std::endl;
+    glog.disable_async();
+
+    int written = 0;
+    while (std::getline(ss3, line)) ++written;
+    std::cout << "async: " << written << " written, " << glog.buf().async_dropped() << " dropped"
+              << std::endl;
+    assert(written + glog.buf().async_dropped() == flood);
+
     std::cout << "All tests passed." << std::endl;
     return 0;
 }
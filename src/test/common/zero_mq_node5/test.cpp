@@ -0,0 +1,200 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests the zero-copy (view) inbox, direct Protobuf serialization and HEADER_BODY_FRAMES
+// framing of ZeroMQService
+
+#include "goby/common/node_interface.h"
+#include "goby/common/zeromq_packet.h"
+#include "goby/common/zeromq_service.h"
+
+void node_inbox(goby::common::MarshallingScheme marshalling_scheme, const std::string& identifier,
+                const std::string& data, int socket_id);
+
+void node_inbox_view(goby::common::MarshallingScheme marshalling_scheme,
+                     boost::string_ref identifier, boost::string_ref data, int socket_id);
+
+const std::string identifier_ = "CFG/";
+int inbox_count_ = 0;
+int inbox_view_count_ = 0;
+goby::common::protobuf::ZeroMQServiceConfig data_;
+
+// written against the std::string inbox() that predates the boost::string_ref one
+class LegacyNode : public goby::common::NodeInterface<google::protobuf::Message>
+{
+  public:
+    LegacyNode(goby::common::ZeroMQService* service)
+        : goby::common::NodeInterface<google::protobuf::Message>(service), inbox_count(0)
+    {
+    }
+
+    void send(const google::protobuf::Message& msg, int socket_id, const std::string& group = "")
+    {
+    }
+    void subscribe(const std::string& identifier, int socket_id) {}
+
+    int inbox_count;
+
+  private:
+    using goby::common::NodeInterface<google::protobuf::Message>::inbox;
+
+    void inbox(goby::common::MarshallingScheme marshalling_scheme, const std::string& identifier,
+               const std::string& body, int socket_id)
+    {
+        assert(identifier == identifier_);
+        assert(body == data_.SerializeAsString());
+        ++inbox_count;
+    }
+};
+
+enum
+{
+    SOCKET_SUBSCRIBE = 240,
+    SOCKET_PUBLISH = 211,
+    SOCKET_PUBLISH_MULTIPART = 212
+};
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    // packet encode / decode round trip
+    {
+        std::string body("a\0b", 3);
+        std::string raw;
+        goby::common::zeromq_packet_encode(&raw, goby::common::MARSHALLING_PROTOBUF, identifier_,
+                                           body);
+        assert(raw.size() == goby::common::zeromq_packet_header_size(identifier_) + body.size());
+
+        goby::common::MarshallingScheme marshalling_scheme = goby::common::MARSHALLING_UNKNOWN;
+        boost::string_ref identifier, decoded_body;
+        goby::common::zeromq_packet_decode(raw.data(), raw.size(), &marshalling_scheme,
+                                           &identifier, &decoded_body);
+        assert(marshalling_scheme == goby::common::MARSHALLING_PROTOBUF);
+        assert(identifier == identifier_);
+        assert(decoded_body == body);
+        // views point into the original buffer
+        assert(decoded_body.data() == raw.data() + raw.size() - body.size());
+    }
+
+    goby::common::ZeroMQService node1;
+    // must share context for ipc
+    goby::common::ZeroMQService node2(node1.zmq_context());
+
+    goby::common::protobuf::ZeroMQServiceConfig publisher_cfg, subscriber_cfg;
+    {
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* subscriber_socket =
+            subscriber_cfg.add_socket();
+        subscriber_socket->set_socket_type(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::SUBSCRIBE);
+        subscriber_socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::IPC);
+        subscriber_socket->set_connect_or_bind(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::CONNECT);
+
+        subscriber_socket->set_socket_id(SOCKET_SUBSCRIBE);
+        subscriber_socket->set_socket_name("test5_ipc_socket");
+
+        // same socket also connects to the multipart publisher
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* multipart_subscriber_socket =
+            subscriber_cfg.add_socket();
+        multipart_subscriber_socket->CopyFrom(*subscriber_socket);
+        multipart_subscriber_socket->set_socket_name("test5_ipc_socket_multipart");
+    }
+
+    {
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* publisher_socket =
+            publisher_cfg.add_socket();
+        publisher_socket->set_socket_type(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::PUBLISH);
+        publisher_socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::IPC);
+        publisher_socket->set_connect_or_bind(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::BIND);
+        publisher_socket->set_socket_name("test5_ipc_socket");
+        publisher_socket->set_socket_id(SOCKET_PUBLISH);
+
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* multipart_publisher_socket =
+            publisher_cfg.add_socket();
+        multipart_publisher_socket->CopyFrom(*publisher_socket);
+        multipart_publisher_socket->set_socket_name("test5_ipc_socket_multipart");
+        multipart_publisher_socket->set_socket_id(SOCKET_PUBLISH_MULTIPART);
+        multipart_publisher_socket->set_framing(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::HEADER_BODY_FRAMES);
+    }
+
+    // use the configuration itself as the test message
+    data_ = subscriber_cfg;
+
+    node1.set_cfg(publisher_cfg);
+
+    node2.set_cfg(subscriber_cfg);
+    node2.connect_inbox_slot(&node_inbox);
+    node2.connect_inbox_view_slot(&node_inbox_view);
+    LegacyNode legacy_node(&node2);
+    node2.subscribe_all(SOCKET_SUBSCRIBE);
+
+    usleep(1e3);
+
+    int test_count = 3;
+    for (int i = 0; i < test_count; ++i)
+    {
+        std::cout << "publishing " << data_.ShortDebugString() << std::endl;
+        node1.send(goby::common::MARSHALLING_PROTOBUF, identifier_, data_, SOCKET_PUBLISH);
+        node2.poll(1e6);
+
+        // header and body as separate frames, body as std::string
+        node1.send(goby::common::MARSHALLING_PROTOBUF, identifier_, data_.SerializeAsString(),
+                   SOCKET_PUBLISH_MULTIPART);
+        node2.poll(1e6);
+    }
+
+    assert(inbox_count_ == 2 * test_count);
+    assert(inbox_view_count_ == 2 * test_count);
+    assert(legacy_node.inbox_count == 2 * test_count);
+
+    std::cout << "all tests passed" << std::endl;
+}
+
+void node_inbox(goby::common::MarshallingScheme marshalling_scheme, const std::string& identifier,
+                const std::string& data, int socket_id)
+{
+    assert(identifier == identifier_);
+    assert(marshalling_scheme == goby::common::MARSHALLING_PROTOBUF);
+    assert(data == data_.SerializeAsString());
+    assert(socket_id == SOCKET_SUBSCRIBE);
+
+    ++inbox_count_;
+}
+
+void node_inbox_view(goby::common::MarshallingScheme marshalling_scheme,
+                     boost::string_ref identifier, boost::string_ref data, int socket_id)
+{
+    assert(identifier == identifier_);
+    assert(marshalling_scheme == goby::common::MARSHALLING_PROTOBUF);
+    assert(socket_id == SOCKET_SUBSCRIBE);
+
+    goby::common::protobuf::ZeroMQServiceConfig received;
+    received.ParseFromArray(data.data(), data.size());
+    assert(received.SerializeAsString() == data_.SerializeAsString());
+
+    std::cout << "Received: " << received.ShortDebugString() << std::endl;
+    ++inbox_view_count_;
+}
@@ -0,0 +1,171 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests ZeroMQService with the dedicated I/O thread (lock-free inbox / outbox) running on both
+// the publisher and the subscriber
+
+#include "goby/common/zeromq_service.h"
+
+void node_inbox(goby::common::MarshallingScheme marshalling_scheme, const std::string& identifier,
+                const std::string& data, int socket_id);
+
+const std::string identifier_ = "CFG/";
+// also matches the subscription to identifier_, but past max_latency_identifiers
+const std::string other_identifier_ = "CFG/OTHER/";
+int inbox_count_ = 0;
+goby::common::protobuf::ZeroMQServiceConfig data_;
+
+enum
+{
+    SOCKET_SUBSCRIBE = 240,
+    SOCKET_PUBLISH = 211
+};
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::common::ZeroMQService node1;
+    // must share context for ipc
+    goby::common::ZeroMQService node2(node1.zmq_context());
+
+    goby::common::protobuf::ZeroMQServiceConfig publisher_cfg, subscriber_cfg;
+    {
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* subscriber_socket =
+            subscriber_cfg.add_socket();
+        subscriber_socket->set_socket_type(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::SUBSCRIBE);
+        subscriber_socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::IPC);
+        subscriber_socket->set_connect_or_bind(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::CONNECT);
+        subscriber_socket->set_socket_id(SOCKET_SUBSCRIBE);
+        subscriber_socket->set_socket_name("test6_ipc_socket");
+    }
+
+    {
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* publisher_socket =
+            publisher_cfg.add_socket();
+        publisher_socket->set_socket_type(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::PUBLISH);
+        publisher_socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::IPC);
+        publisher_socket->set_connect_or_bind(
+            goby::common::protobuf::ZeroMQServiceConfig::Socket::BIND);
+        publisher_socket->set_socket_name("test6_ipc_socket");
+        publisher_socket->set_socket_id(SOCKET_PUBLISH);
+    }
+
+    data_ = subscriber_cfg;
+
+    node1.set_cfg(publisher_cfg);
+    node2.set_cfg(subscriber_cfg);
+    node2.connect_inbox_slot(&node_inbox);
+
+    // room for every subscribed packet, as node2 only drains its inbox after all are sent
+    const int test_count = 10;
+    const int inbox_capacity = 2 * test_count;
+
+    goby::common::protobuf::ZeroMQIOThreadConfig io_cfg;
+    io_cfg.set_enable(true);
+    io_cfg.set_inbox_capacity(inbox_capacity);
+    io_cfg.set_max_latency_identifiers(1);
+    node1.start_io_thread(io_cfg);
+    node2.start_io_thread(io_cfg);
+    assert(node1.io_thread_running() && node2.io_thread_running());
+
+    // no reconfiguring once the I/O thread owns the sockets
+    bool threw = false;
+    try
+    {
+        node2.merge_cfg(subscriber_cfg);
+    }
+    catch (goby::Exception& e)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    // queued for the I/O thread
+    node2.subscribe(goby::common::MARSHALLING_PROTOBUF, identifier_, SOCKET_SUBSCRIBE);
+
+    usleep(1e5);
+
+    for (int i = 0; i < test_count; ++i)
+    {
+        node1.send(goby::common::MARSHALLING_PROTOBUF, identifier_, data_, SOCKET_PUBLISH);
+        // not subscribed for
+        node1.send(goby::common::MARSHALLING_DCCL, identifier_, data_, SOCKET_PUBLISH);
+    }
+    for (int i = 0; i < test_count; ++i)
+        node1.send(goby::common::MARSHALLING_PROTOBUF, other_identifier_, data_, SOCKET_PUBLISH);
+
+    for (int i = 0; i < 100 && inbox_count_ < 2 * test_count; ++i) node2.poll(1e5);
+
+    assert(inbox_count_ == 2 * test_count);
+
+    goby::common::protobuf::ZeroMQIOThreadStatus status;
+    node2.io_thread_status(&status);
+    std::cout << status.DebugString() << std::endl;
+    assert(status.inbox_received() == 2 * test_count);
+    assert(status.inbox_dropped() == 0);
+    assert(status.inbox_capacity() == inbox_capacity);
+    assert(status.handler_latency_size() == 1);
+    assert(status.handler_latency(0).identifier() == identifier_);
+    assert(status.handler_latency(0).count() == test_count);
+    assert(status.latency_untracked() == test_count);
+
+    node1.io_thread_status(&status);
+    assert(status.outbox_dropped() == 0);
+
+    // overflow: node2 does not drain while three inboxes' worth arrive, so exactly two are dropped
+    const int overflow_count = 3 * inbox_capacity;
+    for (int i = 0; i < overflow_count; ++i)
+        node1.send(goby::common::MARSHALLING_PROTOBUF, identifier_, data_, SOCKET_PUBLISH);
+
+    for (int i = 0; i < 100 && status.inbox_received() < 2 * test_count + overflow_count; ++i)
+    {
+        usleep(1e4);
+        node2.io_thread_status(&status);
+    }
+    assert(status.inbox_received() == 2 * test_count + overflow_count);
+    assert(status.inbox_dropped() == overflow_count - inbox_capacity);
+
+    while (node2.poll(0)) {}
+    assert(inbox_count_ == 2 * test_count + inbox_capacity);
+    node2.io_thread_status(&status);
+    assert(status.inbox_received() == inbox_count_ + status.inbox_dropped());
+
+    node2.stop_io_thread();
+    assert(!node2.io_thread_running());
+
+    std::cout << "all tests passed" << std::endl;
+}
+
+void node_inbox(goby::common::MarshallingScheme marshalling_scheme, const std::string& identifier,
+                const std::string& data, int socket_id)
+{
+    assert(identifier == identifier_ || identifier == other_identifier_);
+    assert(marshalling_scheme == goby::common::MARSHALLING_PROTOBUF);
+    assert(data == data_.SerializeAsString());
+    assert(socket_id == SOCKET_SUBSCRIBE);
+
+    ++inbox_count_;
+}
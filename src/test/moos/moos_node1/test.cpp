@@ -0,0 +1,124 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests MOOSNode send and receive over an inproc socket, and that newest() and newest_substr()
+// return the latest value of each variable
+
+#include <cassert>
+#include <iostream>
+
+#include "goby/common/zeromq_service.h"
+#include "goby/moos/moos_node.h"
+
+using goby::common::protobuf::ZeroMQServiceConfig;
+
+enum
+{
+    SOCKET_SUBSCRIBE = 240,
+    SOCKET_PUBLISH = 211
+};
+
+class MOOSTester : public goby::moos::MOOSNode
+{
+  public:
+    MOOSTester(goby::common::ZeroMQService* service) : goby::moos::MOOSNode(service), count_(0)
+    {
+        subscribe("", SOCKET_SUBSCRIBE);
+    }
+
+    void publish(const CMOOSMsg& msg) { send(msg, SOCKET_PUBLISH); }
+
+    int count() { return count_; }
+
+  private:
+    void moos_inbox(CMOOSMsg& msg)
+    {
+        // the message passed is the newest() entry itself
+        assert(&msg == &newest(msg.GetKey()));
+        ++count_;
+    }
+
+    int count_;
+};
+
+void send_and_wait(MOOSTester* tester, goby::common::ZeroMQService* service, const CMOOSMsg& msg)
+{
+    int expected = tester->count() + 1;
+    tester->publish(msg);
+    while (tester->count() < expected && service->poll(1e6)) {}
+    assert(tester->count() == expected);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::common::ZeroMQService service;
+
+    ZeroMQServiceConfig cfg;
+    ZeroMQServiceConfig::Socket* publisher_socket = cfg.add_socket();
+    publisher_socket->set_socket_type(ZeroMQServiceConfig::Socket::PUBLISH);
+    publisher_socket->set_transport(ZeroMQServiceConfig::Socket::INPROC);
+    publisher_socket->set_connect_or_bind(ZeroMQServiceConfig::Socket::BIND);
+    publisher_socket->set_socket_name("moos_node1");
+    publisher_socket->set_socket_id(SOCKET_PUBLISH);
+
+    ZeroMQServiceConfig::Socket* subscriber_socket = cfg.add_socket();
+    subscriber_socket->set_socket_type(ZeroMQServiceConfig::Socket::SUBSCRIBE);
+    subscriber_socket->set_transport(ZeroMQServiceConfig::Socket::INPROC);
+    subscriber_socket->set_connect_or_bind(ZeroMQServiceConfig::Socket::CONNECT);
+    subscriber_socket->set_socket_name("moos_node1");
+    subscriber_socket->set_socket_id(SOCKET_SUBSCRIBE);
+
+    service.set_cfg(cfg);
+
+    MOOSTester tester(&service);
+    usleep(1e4);
+
+    send_and_wait(&tester, &service, CMOOSMsg(MOOS_NOTIFY, "BOB", 1.0));
+    send_and_wait(&tester, &service, CMOOSMsg(MOOS_NOTIFY, "BIG", "big"));
+    send_and_wait(&tester, &service, CMOOSMsg(MOOS_NOTIFY, "ALICE", 3.0));
+
+    CMOOSMsg& bob = tester.newest("BOB");
+    assert(bob.IsDouble() && bob.GetDouble() == 1.0);
+    assert(tester.newest("BIG").IsString() && tester.newest("BIG").GetString() == "big");
+
+    // the reference from newest() sees the update
+    send_and_wait(&tester, &service, CMOOSMsg(MOOS_NOTIFY, "BOB", 2.0));
+    assert(bob.GetDouble() == 2.0);
+    assert(&bob == &tester.newest("BOB"));
+
+    std::vector<CMOOSMsg> b_vars = tester.newest_substr("B*");
+    assert(b_vars.size() == 2);
+    assert(b_vars[0].GetKey() == "BIG" && b_vars[0].GetString() == "big");
+    assert(b_vars[1].GetKey() == "BOB" && b_vars[1].GetDouble() == 2.0);
+
+    std::vector<CMOOSMsg> exact = tester.newest_substr("ALICE");
+    assert(exact.size() == 1 && exact[0].GetDouble() == 3.0);
+
+    assert(tester.newest_substr("AL").empty());
+    assert(tester.newest_substr("C*").empty());
+    assert(tester.newest_substr("*").size() == 3);
+
+    std::cout << "all tests passed" << std::endl;
+}
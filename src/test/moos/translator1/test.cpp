@@ -455,6 +455,78 @@ int main(int argc, char* argv[])
     assert(embedded_test_out->SerializePartialAsString() ==
            embedded_test.SerializePartialAsString());
 
+    // precompiled formats: "%%" is a literal; other boost::format directives fall back to
+    // boost::format
+    {
+        typedef MOOSTranslation<protobuf::TranslatorEntry::TECHNIQUE_FORMAT> FormatTranslation;
+        google::protobuf::RepeatedPtrField<protobuf::TranslatorEntry::PublishSerializer::Algorithm>
+            no_algorithms;
+
+        std::string out;
+        FormatTranslation::Program program =
+            FormatTranslation::compile_serializer("uint64=%106.1% (100%%),em0.em1.val=%37:2:1%");
+        assert(program.compiled);
+        FormatTranslation::serialize(&out, embedded_test, no_algorithms, program, ",");
+        goby::glog << "Compiled format: " << out << std::endl;
+        assert(out == "uint64=100 (100%),em0.em1.val=45");
+
+        program = FormatTranslation::compile_serializer("uint64={%106$s}");
+        assert(!program.compiled);
+        FormatTranslation::serialize(&out, embedded_test, no_algorithms, program, ",");
+        goby::glog << "boost::format fallback: " << out << std::endl;
+        assert(out == "uint64={0,100,200}");
+
+        // the compiled formats must match the boost::format implementation exactly
+        TestMsg populated;
+        populate_test_msg(&populated);
+        FirstFieldHighest first_highest;
+        first_highest.set_highest(7);
+        first_highest.set_value(1.5);
+        first_highest.add_list(1);
+        first_highest.add_list(2);
+
+        const char* test_msg_formats[] = {
+            "%1%,%2%,%3%,%4%,%5%,%6%,%7%,%8%,%9%,%10%,%11%,%12%",
+            "%13%;%14%;%15%;%16%;%17%;%18%;%36%;%37%",
+            "%101%|%102%|%103%|%104%|%105%|%106%|%107%|%108%|%109%",
+            "%110%|%111%|%112%|%113%|%114%|%115%|%116%|%117%",
+            "%106%;%106.2%;%106.7%;%116.1%;%118.0%",
+            "%37:2:1%/%37:1%/%117.1:1%/%117.0:3%/%17:2:3%",
+            "%1000%"};
+        const char* first_highest_formats[] = {"%1%,%2%,%3%,%4%,%5%,%6%", "%3.1%,%5.0%"};
+
+        std::vector<std::pair<const google::protobuf::Message*, std::string> > cases;
+        for (int i = 0, n = sizeof(test_msg_formats) / sizeof(test_msg_formats[0]); i < n; ++i)
+        {
+            cases.push_back(std::make_pair(&embedded_test, test_msg_formats[i]));
+            cases.push_back(std::make_pair(&populated, test_msg_formats[i]));
+        }
+        for (int i = 0, n = sizeof(first_highest_formats) / sizeof(first_highest_formats[0]);
+             i < n; ++i)
+            cases.push_back(std::make_pair(&first_highest, first_highest_formats[i]));
+
+        for (int i = 0, n = cases.size(); i < n; ++i)
+        {
+            program = FormatTranslation::compile_serializer(cases[i].second);
+            assert(program.compiled);
+
+            FormatTranslation::Program boost_format_program;
+            boost_format_program.format = cases[i].second;
+
+            std::string boost_format_out;
+            FormatTranslation::serialize(&out, *cases[i].first, no_algorithms, program, ",");
+            FormatTranslation::serialize(&boost_format_out, *cases[i].first, no_algorithms,
+                                         boost_format_program, ",");
+            goby::glog << cases[i].second << ": " << out << std::endl;
+            assert(out == boost_format_out);
+        }
+
+        // field 5 is declared first, so it is past the last argument and left empty
+        FormatTranslation::serialize(&out, first_highest, no_algorithms,
+                                     first_highest_formats[0], ",");
+        assert(out == "unknown,1.5,1,2,,,");
+    }
+
     std::cout << "all tests passed" << std::endl;
 }
 
@@ -0,0 +1,152 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests MOOSWildcardIndex against a linear MOOSWildCmp scan, and compares their speed
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "goby/moos/moos_wildcard_index.h"
+#include "goby/util/as.h"
+
+typedef std::pair<std::string, std::string> Pattern;
+
+void linear_match(const std::vector<Pattern>& patterns, const std::string& key,
+                  const std::string& source, std::vector<int>* matches)
+{
+    matches->clear();
+    for (int i = 0, n = patterns.size(); i < n; ++i)
+    {
+        if (MOOSWildCmp(patterns[i].first, key) && MOOSWildCmp(patterns[i].second, source))
+            matches->push_back(i);
+    }
+}
+
+// returns microseconds per message for the linear scan (first) and the index (second)
+std::pair<double, double> run(int num_patterns, int num_messages)
+{
+    const char* prefixes[] = {"NAV_", "ACOMMS_", "DESIRED_", "IFS_", "NODE_REPORT", "STATUS_"};
+    const char* apps[] = {"*", "pAcommsHandler", "pHelmIvP", "iFrontSeat*", "u?imulator"};
+    const int num_prefixes = sizeof(prefixes) / sizeof(prefixes[0]);
+    const int num_apps = sizeof(apps) / sizeof(apps[0]);
+
+    std::srand(num_patterns);
+
+    // patterns stored in Pattern order, so index order and linear order agree
+    std::set<Pattern> pattern_set;
+    pattern_set.insert(Pattern("*", "*"));
+    pattern_set.insert(Pattern("NAV_*", "*"));
+    pattern_set.insert(Pattern("*_STATUS", "pHelmIvP"));
+    pattern_set.insert(Pattern("ACOMMS_??", "*"));
+    while (static_cast<int>(pattern_set.size()) < num_patterns)
+    {
+        std::string var = prefixes[std::rand() % num_prefixes] +
+                          goby::util::as<std::string>(std::rand() % (num_patterns / 4 + 1));
+        if (std::rand() % 2)
+            var += "*";
+        pattern_set.insert(Pattern(var, apps[std::rand() % num_apps]));
+    }
+    std::vector<Pattern> patterns(pattern_set.begin(), pattern_set.end());
+
+    goby::moos::MOOSWildcardIndex<int> index;
+    for (int i = 0, n = patterns.size(); i < n; ++i) index.insert(patterns[i], i);
+    assert(index.size() == patterns.size());
+
+    std::vector<std::pair<std::string, std::string> > mail;
+    const char* sources[] = {"pAcommsHandler", "pHelmIvP", "iFrontSeat_bluefin", "uSimulator"};
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string key = prefixes[std::rand() % num_prefixes] +
+                          goby::util::as<std::string>(std::rand() % (num_patterns / 2 + 1));
+        if (std::rand() % 3 == 0)
+            key += "_STATUS";
+        mail.push_back(std::make_pair(key, sources[std::rand() % 4]));
+    }
+    mail.push_back(std::make_pair("ACOMMS_RX", "pAcommsHandler"));
+
+    std::vector<int> matches;
+    for (int i = 0, n = mail.size(); i < n; ++i)
+    {
+        linear_match(patterns, mail[i].first, mail[i].second, &matches);
+        // twice: once computing, once memoized
+        for (int j = 0; j < 2; ++j) assert(index.match(mail[i].first, mail[i].second) == matches);
+    }
+
+    std::pair<double, double> us_per_message;
+    int total = 0;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (int i = 0; i < num_messages; ++i)
+    {
+        const std::pair<std::string, std::string>& m = mail[i % mail.size()];
+        linear_match(patterns, m.first, m.second, &matches);
+        total += matches.size();
+    }
+    boost::posix_time::ptime middle = boost::posix_time::microsec_clock::universal_time();
+    for (int i = 0; i < num_messages; ++i)
+    {
+        const std::pair<std::string, std::string>& m = mail[i % mail.size()];
+        total -= index.match(m.first, m.second).size();
+    }
+    boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time();
+    assert(total == 0);
+
+    us_per_message.first = double((middle - start).total_microseconds()) / num_messages;
+    us_per_message.second = double((end - middle).total_microseconds()) / num_messages;
+    return us_per_message;
+}
+
+int main(int argc, char* argv[])
+{
+    int num_messages = (argc > 1) ? goby::util::as<int>(argv[1]) : 20000;
+
+    {
+        // memoized results must be dropped when patterns are added or the cache is full
+        goby::moos::MOOSWildcardIndex<int> index(2);
+        index.insert(Pattern("NAV_*", "*"), 1);
+        assert(index.match("NAV_X", "pHelmIvP") == std::vector<int>(1, 1));
+        assert(index.match("NAV_Y", "pHelmIvP").size() == 1);
+        assert(index.match("DEPTH", "pHelmIvP").empty());
+        index.insert(Pattern("*", "pHelm*"), 0);
+        std::vector<int> expected;
+        expected.push_back(0);
+        expected.push_back(1);
+        assert(index.match("NAV_X", "pHelmIvP") == expected);
+        assert(index.match("NAV_X", "iFrontSeat") == std::vector<int>(1, 1));
+        assert(index.match("DEPTH", "pHelmIvP") == std::vector<int>(1, 0));
+    }
+
+    int num_patterns[] = {10, 100, 1000};
+    for (int i = 0, n = sizeof(num_patterns) / sizeof(num_patterns[0]); i < n; ++i)
+    {
+        std::pair<double, double> us_per_message = run(num_patterns[i], num_messages);
+        std::cout << num_patterns[i] << " patterns: linear MOOSWildCmp " << us_per_message.first
+                  << " us/msg, MOOSWildcardIndex " << us_per_message.second << " us/msg"
+                  << std::endl;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
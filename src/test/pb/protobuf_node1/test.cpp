@@ -0,0 +1,168 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests (and times) dispatch of received messages to many StaticProtobufNode subscriptions
+// and that multiple subscriptions to the same type share a single parsed message, and that
+// traffic without subscriptions is not cached
+
+#include "goby/common/zeromq_service.h"
+#include "goby/pb/protobuf_node.h"
+
+#include <boost/bind.hpp>
+
+using goby::common::protobuf::ZeroMQServiceConfig;
+
+enum
+{
+    SOCKET_SUBSCRIBE = 240,
+    SOCKET_PUBLISH = 211
+};
+
+const int num_groups = 500;
+const int num_messages = 20000;
+
+// use the ZeroMQ configuration itself as a convenient message type
+typedef ZeroMQServiceConfig TestMsg;
+
+class DispatchTester : public goby::pb::StaticProtobufNode
+{
+  public:
+    DispatchTester(goby::common::ZeroMQService* service, int num_subscriptions)
+        : goby::pb::StaticProtobufNode(service), received_(num_groups, 0), shared_count_(0),
+          last_shared_(0)
+    {
+        for (int i = 0; i < num_subscriptions; ++i)
+            subscribe<TestMsg>(SOCKET_SUBSCRIBE,
+                               boost::bind(&DispatchTester::handle, this, _1, i),
+                               group_name(i));
+
+        for (int i = 0; i < num_shared; ++i)
+            subscribe<TestMsg>(SOCKET_SUBSCRIBE, &DispatchTester::handle_shared, this, "shared");
+    }
+
+    static const int num_shared = 5;
+
+    static std::string group_name(int i) { return "group" + goby::util::as<std::string>(i); }
+
+    void handle(const TestMsg& msg, int group_index)
+    {
+        assert(msg.socket(0).socket_id() == static_cast<unsigned>(group_index));
+        ++received_[group_index];
+    }
+
+    void handle_shared(const TestMsg& msg)
+    {
+        // every handler should see the very same (parsed once) message
+        if (shared_count_ % num_shared != 0)
+            assert(&msg == last_shared_);
+        last_shared_ = &msg;
+        ++shared_count_;
+    }
+
+    int received(int group_index) { return received_[group_index]; }
+    int shared_count() { return shared_count_; }
+    std::size_t cached_identifiers() const { return dispatch_table_size(); }
+
+  private:
+    std::vector<int> received_;
+    int shared_count_;
+    const TestMsg* last_shared_;
+};
+
+double run(int num_subscriptions)
+{
+    goby::common::ZeroMQService service;
+
+    ZeroMQServiceConfig cfg;
+    ZeroMQServiceConfig::Socket* publisher_socket = cfg.add_socket();
+    publisher_socket->set_socket_type(ZeroMQServiceConfig::Socket::PUBLISH);
+    publisher_socket->set_transport(ZeroMQServiceConfig::Socket::INPROC);
+    publisher_socket->set_connect_or_bind(ZeroMQServiceConfig::Socket::BIND);
+    publisher_socket->set_socket_name("protobuf_node1");
+    publisher_socket->set_socket_id(SOCKET_PUBLISH);
+
+    ZeroMQServiceConfig::Socket* subscriber_socket = cfg.add_socket();
+    subscriber_socket->set_socket_type(ZeroMQServiceConfig::Socket::SUBSCRIBE);
+    subscriber_socket->set_transport(ZeroMQServiceConfig::Socket::INPROC);
+    subscriber_socket->set_connect_or_bind(ZeroMQServiceConfig::Socket::CONNECT);
+    subscriber_socket->set_socket_name("protobuf_node1");
+    subscriber_socket->set_socket_id(SOCKET_SUBSCRIBE);
+
+    service.set_cfg(cfg);
+
+    DispatchTester tester(&service, num_subscriptions);
+    usleep(1e4);
+
+    // only publish to the last group so that a linear search would have to look at every subscription
+    const int group_index = num_subscriptions - 1;
+    TestMsg msg;
+    ZeroMQServiceConfig::Socket* socket = msg.add_socket();
+    socket->set_socket_type(ZeroMQServiceConfig::Socket::PUBLISH);
+    socket->set_socket_id(group_index);
+
+    boost::posix_time::ptime start = goby::common::goby_time();
+    for (int i = 0; i < num_messages; ++i)
+    {
+        tester.send(msg, SOCKET_PUBLISH, DispatchTester::group_name(group_index));
+        while (service.poll(0)) {}
+    }
+    while (service.poll(1e5)) {}
+    boost::posix_time::ptime end = goby::common::goby_time();
+
+    assert(tester.received(group_index) == num_messages);
+    for (int i = 0; i < group_index; ++i) assert(tester.received(i) == 0);
+
+    const int shared_test_count = 3;
+    for (int i = 0; i < shared_test_count; ++i)
+    {
+        tester.send(msg, SOCKET_PUBLISH, "shared");
+        service.poll(1e6);
+    }
+    assert(tester.shared_count() == shared_test_count * DispatchTester::num_shared);
+
+    // receive every group, most of which nothing subscribes to
+    const std::size_t cached = tester.cached_identifiers();
+    service.subscribe_all(SOCKET_SUBSCRIBE);
+    usleep(1e4);
+    for (int i = 0; i < 1000; ++i)
+    {
+        tester.send(msg, SOCKET_PUBLISH, "unsubscribed" + goby::util::as<std::string>(i));
+        while (service.poll(0)) {}
+    }
+    while (service.poll(1e5)) {}
+    assert(tester.cached_identifiers() == cached);
+
+    return num_messages / ((end - start).total_microseconds() / 1.0e6);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    double rate_one = run(1);
+    double rate_many = run(num_groups);
+
+    std::cout << "1 subscription: " << rate_one << " messages/s" << std::endl;
+    std::cout << num_groups << " subscriptions: " << rate_many << " messages/s" << std::endl;
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,141 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests that DynamicProtobufNode passes one parsed message to every handler for a group, and
+// that it still creates messages correctly after the DynamicProtobufManager has been reset
+
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/text_format.h>
+
+#include "goby/common/zeromq_service.h"
+#include "goby/pb/protobuf_node.h"
+#include "goby/util/dynamic_protobuf_manager.h"
+
+using goby::common::protobuf::ZeroMQServiceConfig;
+using goby::util::DynamicProtobufManager;
+
+enum
+{
+    SOCKET_SUBSCRIBE = 240,
+    SOCKET_PUBLISH = 211
+};
+
+const std::string group_ = "dynamic";
+const std::string type_name_ = "DynamicNodeTestMsg";
+
+class DynamicTester : public goby::pb::DynamicProtobufNode
+{
+  public:
+    DynamicTester(goby::common::ZeroMQService* service)
+        : goby::pb::DynamicProtobufNode(service), count_(0)
+    {
+        for (int i = 0; i < num_handlers; ++i)
+            subscribe(SOCKET_SUBSCRIBE, &DynamicTester::handle, this, group_);
+    }
+
+    static const int num_handlers = 3;
+
+    void publish(const google::protobuf::Message& msg) { send(msg, SOCKET_PUBLISH, group_); }
+
+    void handle(boost::shared_ptr<google::protobuf::Message> msg)
+    {
+        // every handler should see the very same (parsed once) message
+        if (count_ % num_handlers != 0)
+            assert(msg == last_);
+        last_ = msg;
+        ++count_;
+    }
+
+    int count() { return count_; }
+    boost::shared_ptr<google::protobuf::Message> last() { return last_; }
+    void clear_last() { last_.reset(); }
+
+  private:
+    int count_;
+    boost::shared_ptr<google::protobuf::Message> last_;
+};
+
+// loads the test type into the DynamicProtobufManager and returns a message of it
+boost::shared_ptr<google::protobuf::Message> make_test_msg(double value)
+{
+    google::protobuf::FileDescriptorProto file_proto;
+    google::protobuf::TextFormat::ParseFromString(
+        "name: \"goby/test/pb/protobuf_node2/test.proto\" "
+        "message_type { name: \"" + type_name_ + "\" field { name: \"value\" number: 1 "
+        "label: LABEL_REQUIRED type: TYPE_DOUBLE } }",
+        &file_proto);
+    if (!DynamicProtobufManager::find_descriptor(type_name_))
+        DynamicProtobufManager::add_protobuf_file(file_proto);
+
+    boost::shared_ptr<google::protobuf::Message> msg =
+        DynamicProtobufManager::new_protobuf_message(type_name_);
+    msg->GetReflection()->SetDouble(msg.get(), msg->GetDescriptor()->FindFieldByNumber(1), value);
+    return msg;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::common::ZeroMQService service;
+
+    ZeroMQServiceConfig cfg;
+    ZeroMQServiceConfig::Socket* publisher_socket = cfg.add_socket();
+    publisher_socket->set_socket_type(ZeroMQServiceConfig::Socket::PUBLISH);
+    publisher_socket->set_transport(ZeroMQServiceConfig::Socket::INPROC);
+    publisher_socket->set_connect_or_bind(ZeroMQServiceConfig::Socket::BIND);
+    publisher_socket->set_socket_name("protobuf_node2");
+    publisher_socket->set_socket_id(SOCKET_PUBLISH);
+
+    ZeroMQServiceConfig::Socket* subscriber_socket = cfg.add_socket();
+    subscriber_socket->set_socket_type(ZeroMQServiceConfig::Socket::SUBSCRIBE);
+    subscriber_socket->set_transport(ZeroMQServiceConfig::Socket::INPROC);
+    subscriber_socket->set_connect_or_bind(ZeroMQServiceConfig::Socket::CONNECT);
+    subscriber_socket->set_socket_name("protobuf_node2");
+    subscriber_socket->set_socket_id(SOCKET_SUBSCRIBE);
+
+    service.set_cfg(cfg);
+
+    DynamicTester tester(&service);
+    usleep(1e4);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        {
+            boost::shared_ptr<google::protobuf::Message> msg = make_test_msg(i + 0.5);
+            tester.publish(*msg);
+            while (tester.count() < (i + 1) * DynamicTester::num_handlers && service.poll(1e6)) {}
+            assert(tester.count() == (i + 1) * DynamicTester::num_handlers);
+
+            boost::shared_ptr<google::protobuf::Message> received = tester.last();
+            assert(received->GetDescriptor() ==
+                   DynamicProtobufManager::find_descriptor(type_name_));
+            assert(received->SerializeAsString() == msg->SerializeAsString());
+            tester.clear_last();
+        }
+
+        // drops the descriptors and message factory of the dynamically loaded type
+        DynamicProtobufManager::reset();
+    }
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,159 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// load benchmark for goby_store_server: many simulated modems, each sending bursts of frames and
+// polling for the others' traffic as PBDriver does. Requires a goby_store_server replying on
+// tcp://127.0.0.1:54321 (the same as goby_test_pbdriver1), e.g.
+//   goby_store_server --reply_socket 'socket_type: REPLY transport: TCP
+//     connect_or_bind: BIND ethernet_port: 54321' --db_file_dir /tmp
+//
+// usage: goby_test_store_server_load1 [num_modems] [num_rounds] [frames_per_request]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "goby/acomms/protobuf/store_server.pb.h"
+#include "goby/common/logger.h"
+#include "goby/common/time.h"
+#include "goby/common/zeromq_service.h"
+#include "goby/pb/protobuf_node.h"
+
+using namespace goby::common::logger;
+using goby::common::goby_time;
+using goby::glog;
+
+class SimulatedModem : public goby::pb::StaticProtobufNode
+{
+  public:
+    SimulatedModem(goby::common::ZeroMQService* zeromq_service, int modem_id, int num_modems)
+        : StaticProtobufNode(zeromq_service), zeromq_service_(zeromq_service),
+          modem_id_(modem_id), num_modems_(num_modems), waiting_for_reply_(false), received_(0)
+    {
+        on_receipt<goby::acomms::protobuf::StoreServerResponse>(
+            0, &SimulatedModem::handle_response, this);
+
+        goby::common::protobuf::ZeroMQServiceConfig service_cfg;
+        goby::common::protobuf::ZeroMQServiceConfig::Socket* socket = service_cfg.add_socket();
+        socket->set_socket_type(goby::common::protobuf::ZeroMQServiceConfig::Socket::REQUEST);
+        socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::TCP);
+        socket->set_connect_or_bind(goby::common::protobuf::ZeroMQServiceConfig::Socket::CONNECT);
+        socket->set_ethernet_address("127.0.0.1");
+        socket->set_ethernet_port(54321);
+        socket->set_socket_id(0);
+        zeromq_service_->set_cfg(service_cfg);
+    }
+
+    // returns the round trip time in seconds
+    double request(int num_frames)
+    {
+        goby::acomms::protobuf::StoreServerRequest request;
+        request.set_modem_id(modem_id_);
+        for (int i = 0; i < num_frames; ++i)
+        {
+            goby::acomms::protobuf::ModemTransmission* msg = request.add_outbox();
+            msg->set_src(modem_id_);
+            msg->set_dest(1 + (modem_id_ + i) % num_modems_);
+            msg->set_type(goby::acomms::protobuf::ModemTransmission::DATA);
+            msg->add_frame(std::string(64, static_cast<char>(i)));
+        }
+
+        double start = goby_time<double>();
+        waiting_for_reply_ = true;
+        send(request, 0);
+        while (waiting_for_reply_) zeromq_service_->poll(10000);
+        return goby_time<double>() - start;
+    }
+
+    int received() const { return received_; }
+
+  private:
+    void handle_response(const goby::acomms::protobuf::StoreServerResponse& response)
+    {
+        received_ += response.inbox_size();
+        waiting_for_reply_ = false;
+    }
+
+  private:
+    goby::common::ZeroMQService* zeromq_service_;
+    int modem_id_;
+    int num_modems_;
+    bool waiting_for_reply_;
+    int received_;
+};
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::VERBOSE, &std::clog);
+    goby::glog.set_name(argv[0]);
+
+    const int num_modems = argc > 1 ? std::atoi(argv[1]) : 20;
+    const int num_rounds = argc > 2 ? std::atoi(argv[2]) : 100;
+    const int frames_per_request = argc > 3 ? std::atoi(argv[3]) : 8;
+
+    std::vector<boost::shared_ptr<goby::common::ZeroMQService> > services;
+    std::vector<boost::shared_ptr<SimulatedModem> > modems;
+    for (int i = 0; i < num_modems; ++i)
+    {
+        services.push_back(boost::shared_ptr<goby::common::ZeroMQService>(
+            new goby::common::ZeroMQService));
+        modems.push_back(boost::shared_ptr<SimulatedModem>(
+            new SimulatedModem(services.back().get(), i + 1, num_modems)));
+    }
+
+    // modems take turns as they would relaying through a shore hub
+    std::vector<double> latency;
+    double start = goby_time<double>();
+    for (int round = 0; round < num_rounds; ++round)
+    {
+        for (int i = 0; i < num_modems; ++i)
+            latency.push_back(modems[i]->request(frames_per_request));
+    }
+    double elapsed = goby_time<double>() - start;
+
+    std::sort(latency.begin(), latency.end());
+    int received = 0;
+    for (int i = 0; i < num_modems; ++i) received += modems[i]->received();
+
+    glog.is(VERBOSE) && glog << num_modems << " modems, " << latency.size() << " requests of "
+                             << frames_per_request << " frames in " << elapsed << " s: "
+                             << latency.size() / elapsed << " requests/s, "
+                             << latency.size() * frames_per_request / elapsed
+                             << " frames inserted/s, " << received << " frames delivered"
+                             << std::endl;
+    glog.is(VERBOSE) && glog << "round trip (ms): median " << 1e3 * latency[latency.size() / 2]
+                             << ", 99th percentile " << 1e3 * latency[latency.size() * 99 / 100]
+                             << ", max " << 1e3 * latency.back() << std::endl;
+
+    // every frame except a modem's own reaches every modem once the last round has been polled
+    for (int i = 0; i < num_modems; ++i) modems[i]->request(0);
+    received = 0;
+    for (int i = 0; i < num_modems; ++i) received += modems[i]->received();
+    const int expected = num_rounds * frames_per_request * num_modems * (num_modems - 1);
+    if (received != expected)
+    {
+        glog.is(WARN) && glog << "expected " << expected << " frames delivered, got " << received
+                              << std::endl;
+        return 1;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+}
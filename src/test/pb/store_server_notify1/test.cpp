@@ -0,0 +1,184 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// checks PBDriver's use of goby_store_server's notifications: a frame from modem 1 reaches
+// modem 2 well within idle_query_interval_seconds, and an idle driver only queries the server
+// once per idle interval. Requires a goby_store_server replying on tcp://127.0.0.1:54321 and
+// publishing notifications on tcp://127.0.0.1:54322, e.g.
+//   goby_store_server --reply_socket 'socket_type: REPLY transport: TCP
+//     connect_or_bind: BIND ethernet_port: 54321' --notify_socket 'socket_type: PUBLISH
+//     transport: TCP connect_or_bind: BIND ethernet_port: 54322 socket_id: 1' --db_file_dir /tmp
+//
+// usage: goby_test_store_server_notify1 [idle_query_interval_seconds] [num_frames]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "goby/acomms/connect.h"
+#include "goby/common/logger.h"
+#include "goby/common/time.h"
+#include "goby/pb/pb_modem_driver.h"
+
+using namespace goby::common::logger;
+using goby::common::goby_time;
+using goby::glog;
+
+enum
+{
+    REQUEST_SOCKET_ID = 0,
+    NOTIFY_SOCKET_ID = 1
+};
+
+int requests_sent = 0;
+int frames_received = 0;
+
+void count_request(goby::common::MarshallingScheme marshalling_scheme,
+                   const std::string& identifier, int socket_id)
+{
+    if (socket_id == REQUEST_SOCKET_ID)
+        ++requests_sent;
+}
+
+void handle_receive(const goby::acomms::protobuf::ModemTransmission& msg)
+{
+    if (msg.type() == goby::acomms::protobuf::ModemTransmission::DATA && msg.src() == 1)
+        frames_received += msg.frame_size();
+}
+
+// runs both drivers as their applications would, every millisecond
+void run(goby::pb::PBDriver* driver1, goby::pb::PBDriver* driver2, double seconds,
+         int until_received = -1)
+{
+    double end = goby_time<double>() + seconds;
+    while (goby_time<double>() < end && frames_received != until_received)
+    {
+        driver1->do_work();
+        driver2->do_work();
+        usleep(1000);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::common::logger::VERBOSE, &std::clog);
+    goby::glog.set_name(argv[0]);
+
+    const double idle_interval = argc > 1 ? std::atof(argv[1]) : 5;
+    const int num_frames = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    goby::acomms::protobuf::DriverConfig cfg1, cfg2;
+    cfg1.set_modem_id(1);
+
+    goby::common::protobuf::ZeroMQServiceConfig::Socket* request_socket =
+        cfg1.MutableExtension(PBDriverConfig::request_socket);
+    request_socket->set_socket_type(goby::common::protobuf::ZeroMQServiceConfig::Socket::REQUEST);
+    request_socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::TCP);
+    request_socket->set_connect_or_bind(
+        goby::common::protobuf::ZeroMQServiceConfig::Socket::CONNECT);
+    request_socket->set_ethernet_address("127.0.0.1");
+    request_socket->set_ethernet_port(54321);
+    request_socket->set_socket_id(REQUEST_SOCKET_ID);
+
+    goby::common::protobuf::ZeroMQServiceConfig::Socket* notify_socket =
+        cfg1.MutableExtension(PBDriverConfig::notify_socket);
+    notify_socket->set_socket_type(goby::common::protobuf::ZeroMQServiceConfig::Socket::SUBSCRIBE);
+    notify_socket->set_transport(goby::common::protobuf::ZeroMQServiceConfig::Socket::TCP);
+    notify_socket->set_connect_or_bind(
+        goby::common::protobuf::ZeroMQServiceConfig::Socket::CONNECT);
+    notify_socket->set_ethernet_address("127.0.0.1");
+    notify_socket->set_ethernet_port(54322);
+    notify_socket->set_socket_id(NOTIFY_SOCKET_ID);
+
+    cfg1.SetExtension(PBDriverConfig::idle_query_interval_seconds, idle_interval);
+    cfg1.AddExtension(PBDriverConfig::rate_to_frames, 1);
+    cfg1.AddExtension(PBDriverConfig::rate_to_bytes, 32);
+
+    cfg2 = cfg1;
+    cfg2.set_modem_id(2);
+
+    goby::common::ZeroMQService zeromq_service1, zeromq_service2;
+    goby::pb::PBDriver driver1(&zeromq_service1), driver2(&zeromq_service2);
+    goby::acomms::connect(&driver2.signal_receive, &handle_receive);
+    zeromq_service2.post_send_hooks.connect(&count_request);
+
+    driver1.startup(cfg1);
+    driver2.startup(cfg2);
+
+    // a restarted driver should subscribe and handle notifications just the same
+    zeromq_service2.close_all();
+    driver2.startup(cfg2);
+
+    // first requests and the subscriptions to the notifications
+    run(&driver1, &driver2, 1);
+
+    std::vector<double> latency;
+    for (int i = 0; i < num_frames; ++i)
+    {
+        goby::acomms::protobuf::ModemTransmission msg;
+        msg.set_type(goby::acomms::protobuf::ModemTransmission::DATA);
+        msg.set_src(1);
+        msg.set_dest(2);
+        msg.set_rate(0);
+        msg.set_ack_requested(false);
+        msg.add_frame(std::string(32, static_cast<char>(i)));
+
+        double start = goby_time<double>();
+        driver1.handle_initiate_transmission(msg);
+        run(&driver1, &driver2, 2 * idle_interval, i + 1);
+        if (frames_received != i + 1)
+        {
+            glog.is(WARN) && glog << "frame " << i << " was not received" << std::endl;
+            return 1;
+        }
+        latency.push_back(goby_time<double>() - start);
+    }
+    std::sort(latency.begin(), latency.end());
+
+    glog.is(VERBOSE) && glog << num_frames << " frames, latency (ms): median "
+                             << 1e3 * latency[latency.size() / 2] << ", max "
+                             << 1e3 * latency.back() << " (idle_query_interval_seconds: "
+                             << idle_interval << ")" << std::endl;
+
+    // without notifications a frame waits for the receiver's next poll
+    if (latency.back() > idle_interval / 4)
+    {
+        glog.is(WARN) && glog << "frames were not requested on notification" << std::endl;
+        return 1;
+    }
+
+    // once the last frame's exchanges are over, an idle driver only polls at the idle interval
+    run(&driver1, &driver2, 1);
+    const int idle_intervals = 3;
+    requests_sent = 0;
+    run(&driver1, &driver2, idle_intervals * idle_interval);
+
+    glog.is(VERBOSE) && glog << "idle: " << requests_sent << " requests in " << idle_intervals
+                             << " idle intervals" << std::endl;
+
+    if (requests_sent < idle_intervals - 1 || requests_sent > idle_intervals)
+    {
+        glog.is(WARN) && glog << "expected one request per idle interval" << std::endl;
+        return 1;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+}
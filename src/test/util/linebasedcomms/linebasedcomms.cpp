@@ -0,0 +1,109 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests the high throughput (ring buffer) read mode of LineBasedInterface: order for both access
+// orders, wrap-around and overwriting the oldest lines when full
+
+#include <cassert>
+#include <iostream>
+
+#include "goby/util/as.h"
+#include "goby/util/linebasedcomms/interface.h"
+
+// stands in for a connection, storing lines as LineBasedConnection does
+class RingTester : public goby::util::LineBasedInterface
+{
+  public:
+    RingTester() : goby::util::LineBasedInterface("\r\n") {}
+
+    void receive(int first, int last)
+    {
+        boost::mutex::scoped_lock lock(in_mutex());
+        for (int i = first; i <= last; ++i) in_ring_push().set_data(goby::util::as<std::string>(i));
+    }
+
+  private:
+    void do_start() {}
+    void do_write(const goby::util::protobuf::Datagram& line) {}
+    void do_close(const boost::system::error_code& error) {}
+};
+
+std::string read(RingTester* ring, goby::util::LineBasedInterface::AccessOrder order)
+{
+    std::string s;
+    assert(ring->readline(&s, order));
+    return s;
+}
+
+int main()
+{
+    RingTester ring;
+    assert(!ring.high_throughput());
+    ring.set_high_throughput(4);
+    assert(ring.high_throughput());
+
+    std::string s;
+    assert(!ring.readline(&s));
+
+    // two past capacity: the two oldest are overwritten
+    ring.receive(0, 5);
+    assert(ring.in_dropped() == 2);
+    assert(read(&ring, goby::util::LineBasedInterface::OLDEST_FIRST) == "2");
+    assert(read(&ring, goby::util::LineBasedInterface::NEWEST_FIRST) == "5");
+
+    std::vector<goby::util::protobuf::Datagram> lines;
+    assert(ring.readlines(&lines, 1) == 1);
+    assert(lines[0].data() == "3");
+
+    goby::util::protobuf::Datagram datagram;
+    assert(ring.readline(&datagram, goby::util::LineBasedInterface::NEWEST_FIRST));
+    assert(datagram.data() == "4");
+    assert(!ring.readline(&datagram));
+
+    // begins part way round the ring, so this wraps around and overwrites several times
+    ring.receive(6, 15);
+    assert(ring.in_dropped() == 8);
+    assert(ring.readlines(&lines) == 4);
+    for (int i = 0; i < 4; ++i) assert(lines[i].data() == goby::util::as<std::string>(12 + i));
+    assert(ring.readlines(&lines) == 0);
+
+    // not full: nothing dropped, and newest first reads back in reverse
+    ring.receive(16, 18);
+    assert(ring.in_dropped() == 8);
+    assert(read(&ring, goby::util::LineBasedInterface::NEWEST_FIRST) == "18");
+    assert(read(&ring, goby::util::LineBasedInterface::NEWEST_FIRST) == "17");
+    assert(read(&ring, goby::util::LineBasedInterface::NEWEST_FIRST) == "16");
+    assert(!ring.readline(&s, goby::util::LineBasedInterface::NEWEST_FIRST));
+
+    // full after wrapping, read oldest first in pieces
+    ring.receive(19, 23);
+    assert(ring.in_dropped() == 9);
+    assert(ring.readlines(&lines, 3) == 3);
+    for (int i = 0; i < 3; ++i) assert(lines[i].data() == goby::util::as<std::string>(20 + i));
+    assert(read(&ring, goby::util::LineBasedInterface::OLDEST_FIRST) == "23");
+    assert(!ring.readline(&s));
+
+    ring.receive(24, 25);
+    ring.clear();
+    assert(!ring.readline(&s));
+
+    std::cout << "all tests passed" << std::endl;
+}
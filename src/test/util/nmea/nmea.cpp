@@ -19,6 +19,8 @@
 // You should have received a copy of the GNU General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <boost/assign.hpp>
+
 #include "goby/util/binary.h"
 #include "goby/util/linebasedcomms.h"
 
@@ -64,6 +66,78 @@ int main()
         assert(nmea.as<int>(2) == 1);
     }
 
+    {
+        goby::util::NMEATokenizer tokens;
+        tokens.parse("$YXXDR,A,0.3,D,PTCH,A,13.3,D,ROLL*6f ");
+        goby::util::NMEASentence nmea("$YXXDR,A,0.3,D,PTCH,A,13.3,D,ROLL*6f ");
+        assert(tokens.size() == nmea.size());
+        for (std::size_t i = 0, n = nmea.size(); i < n; ++i) assert(tokens[i] == nmea[i]);
+        assert(tokens.sentence_id() == "XDR");
+        assert(tokens.talker_id() == "YX");
+        assert(tokens.as<double>(6) == 13.3);
+
+        std::string raw;
+        tokens.message_cs(&raw);
+        assert(raw == nmea.message());
+
+        goby::util::NMEASentence copy;
+        tokens.to_sentence(&copy);
+        assert(copy.message() == nmea.message());
+
+        // checksum is optional for VALIDATE, mandatory for REQUIRE
+        tokens.parse("$CCTXD,2,1,1");
+        assert(tokens.size() == 4 && !tokens.has_checksum());
+
+        bool threw = false;
+        try
+        {
+            tokens.parse("$CCTXD,2,1,1", goby::util::NMEASentence::REQUIRE);
+        }
+        catch (goby::util::bad_nmea_sentence&)
+        {
+            threw = true;
+        }
+        assert(threw);
+
+        threw = false;
+        try
+        {
+            tokens.parse("$CCTXD,2,1,1*57");
+        }
+        catch (goby::util::bad_nmea_sentence&)
+        {
+            threw = true;
+        }
+        assert(threw);
+
+        // no limit on the number of fields; a shorter line afterwards reuses the storage
+        std::string long_line = "$CCLNG";
+        for (int i = 0; i < 500; ++i) long_line += "," + goby::util::as<std::string>(i);
+        tokens.parse(long_line);
+        assert(tokens.size() == 501);
+        assert(tokens.as<int>(500) == 499);
+        assert(tokens.size() == goby::util::NMEASentence(long_line).size());
+
+        tokens.parse("$CCTXD,2,1,1");
+        assert(tokens.size() == 4 && tokens[3] == "1");
+    }
+
+    {
+        goby::util::NMEAIDMap<int> ids;
+        boost::assign::insert(ids)("DRQ", 1)("RXD", 2)("CFG", 3)("$BFNVG", 4);
+        assert(ids.size() == 4);
+
+        goby::util::NMEATokenizer tokens;
+        tokens.parse("$CADRQ,000000,1,0,0,32,1*44");
+        assert(ids.find(tokens.sentence_id()) && *ids.find(tokens.sentence_id()) == 1);
+        assert(*ids.find(std::string("$BFNVG")) == 4);
+        assert(ids.find(std::string("XXX")) == 0);
+        assert(ids.find_or(tokens.front(), -1) == -1);
+
+        ids.insert("RXD", 5);
+        assert(ids.size() == 4 && *ids.find(std::string("RXD")) == 5);
+    }
+
     std::cout << "all tests passed" << std::endl;
 
     return 0;
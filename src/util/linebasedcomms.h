@@ -28,7 +28,9 @@
 #include "goby/util/linebasedcomms/client_base.h"
 #include "goby/util/linebasedcomms/connection.h"
 #include "goby/util/linebasedcomms/interface.h"
+#include "goby/util/linebasedcomms/nmea_id_map.h"
 #include "goby/util/linebasedcomms/nmea_sentence.h"
+#include "goby/util/linebasedcomms/nmea_tokenizer.h"
 #include "goby/util/linebasedcomms/serial_client.h"
 #include "goby/util/linebasedcomms/tcp_client.h"
 #include "goby/util/linebasedcomms/tcp_server.h"
@@ -23,6 +23,8 @@
 #ifndef ASIOLineBasedConnection20100715H
 #define ASIOLineBasedConnection20100715H
 
+#include <cstring>
+
 #include "goby/common/logger.h"
 #include "goby/common/time.h"
 #include "interface.h"
@@ -79,6 +81,14 @@ template <typename ASIOAsyncReadStream> class LineBasedConnection
             return socket_close(error);
         }
 
+        if (interface_->high_throughput())
+        {
+            if (read_lines())
+                interface_->notify_read();
+            read_start();
+            return;
+        }
+
         std::istream is(&buffer_);
         std::string& line = *in_datagram_.mutable_data();
 
@@ -95,9 +105,51 @@ template <typename ASIOAsyncReadStream> class LineBasedConnection
             boost::mutex::scoped_lock lock(interface_->in_mutex());
             interface_->in().push_back(in_datagram_);
         }
+        interface_->notify_read();
         read_start(); // start waiting for another asynchronous read again
     }
 
+    // high throughput mode: stores all the complete lines in buffer_ under one lock
+    // returns true if any lines were stored
+    bool read_lines()
+    {
+        const char last = interface_->delimiter().at(interface_->delimiter().length() - 1);
+        const char* begin = boost::asio::buffer_cast<const char*>(buffer_.data());
+        const char* end = begin + buffer_.size();
+
+        // the same for every line in this read
+        src_ = remote_endpoint();
+        dest_ = local_endpoint();
+        double now = goby::common::goby_time<double>();
+
+        const char* line_begin = begin;
+        {
+            boost::mutex::scoped_lock lock(interface_->in_mutex());
+            while (const char* line_end =
+                       static_cast<const char*>(std::memchr(line_begin, last, end - line_begin)))
+            {
+                protobuf::Datagram& datagram = interface_->in_ring_push();
+                // as std::getline: excludes the last character of the delimiter
+                datagram.mutable_data()->assign(line_begin, line_end);
+
+                // the slot is reused, so clear any fields from the previous line
+                if (!src_.empty())
+                    datagram.set_src(src_);
+                else
+                    datagram.clear_src();
+                if (!dest_.empty())
+                    datagram.set_dest(dest_);
+                else
+                    datagram.clear_dest();
+                datagram.set_time(now);
+
+                line_begin = line_end + 1;
+            }
+        }
+        buffer_.consume(line_begin - begin);
+        return line_begin != begin;
+    }
+
     void write_complete(const boost::system::error_code& error)
     { // the asynchronous read operation has now completed or failed and returned an error
         if (error == boost::asio::error::operation_aborted)
@@ -128,6 +180,9 @@ template <typename ASIOAsyncReadStream> class LineBasedConnection
     LineBasedInterface* interface_;
     boost::asio::streambuf buffer_;
     protobuf::Datagram in_datagram_;
+    // endpoints of the current read (high throughput mode)
+    std::string src_;
+    std::string dest_;
     std::deque<protobuf::Datagram> out_; // buffered write data
 };
 } // namespace util
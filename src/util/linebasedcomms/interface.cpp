@@ -25,7 +25,7 @@
 #include "goby/common/logger.h"
 
 goby::util::LineBasedInterface::LineBasedInterface(const std::string& delimiter)
-    : work_(io_service_), active_(false)
+    : in_ring_begin_(0), in_ring_size_(0), in_dropped_(0), work_(io_service_), active_(false)
 {
     goby::glog.set_lock_action(goby::common::logger_lock::lock);
 
@@ -49,12 +49,74 @@ void goby::util::LineBasedInterface::clear()
 {
     boost::mutex::scoped_lock lock(in_mutex_);
     in_.clear();
+    in_ring_begin_ = 0;
+    in_ring_size_ = 0;
+}
+
+void goby::util::LineBasedInterface::set_high_throughput(std::size_t ring_capacity)
+{
+    boost::mutex::scoped_lock lock(in_mutex_);
+    in_ring_.clear();
+    in_ring_.resize(ring_capacity);
+    in_ring_begin_ = 0;
+    in_ring_size_ = 0;
+}
+
+goby::uint64 goby::util::LineBasedInterface::in_dropped() const
+{
+    boost::mutex::scoped_lock lock(in_mutex_);
+    return in_dropped_;
+}
+
+goby::util::protobuf::Datagram& goby::util::LineBasedInterface::in_ring_pop(AccessOrder order)
+{
+    std::size_t index = in_ring_begin_;
+    switch (order)
+    {
+        case NEWEST_FIRST: index = (in_ring_begin_ + in_ring_size_ - 1) % in_ring_.size(); break;
+
+        case OLDEST_FIRST: in_ring_begin_ = (in_ring_begin_ + 1) % in_ring_.size(); break;
+    }
+    --in_ring_size_;
+    return in_ring_[index];
+}
+
+std::size_t goby::util::LineBasedInterface::readlines(std::vector<protobuf::Datagram>* msgs,
+                                                      std::size_t max_lines /* = 0 */)
+{
+    boost::mutex::scoped_lock lock(in_mutex_);
+
+    std::size_t available = high_throughput() ? in_ring_size_ : in_.size();
+    std::size_t n = (max_lines && max_lines < available) ? max_lines : available;
+    msgs->resize(n);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (high_throughput())
+        {
+            (*msgs)[i].Swap(&in_ring_pop(OLDEST_FIRST));
+        }
+        else
+        {
+            (*msgs)[i].Swap(&in_.front());
+            in_.pop_front();
+        }
+    }
+    return n;
 }
 
 bool goby::util::LineBasedInterface::readline(protobuf::Datagram* msg,
                                               AccessOrder order /* = OLDEST_FIRST */)
 {
-    if (in_.empty())
+    if (high_throughput())
+    {
+        boost::mutex::scoped_lock lock(in_mutex_);
+        if (!in_ring_size_)
+            return false;
+        msg->Swap(&in_ring_pop(order));
+        return true;
+    }
+    else if (in_.empty())
     {
         return false;
     }
@@ -80,7 +142,15 @@ bool goby::util::LineBasedInterface::readline(protobuf::Datagram* msg,
 bool goby::util::LineBasedInterface::readline(std::string* s,
                                               AccessOrder order /* = OLDEST_FIRST */)
 {
-    if (in_.empty())
+    if (high_throughput())
+    {
+        boost::mutex::scoped_lock lock(in_mutex_);
+        if (!in_ring_size_)
+            return false;
+        s->swap(*in_ring_pop(order).mutable_data());
+        return true;
+    }
+    else if (in_.empty())
     {
         return false;
     }
@@ -26,10 +26,12 @@
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
 #include <boost/thread.hpp>
 #include <deque>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "goby/common/time.h"
 #include "goby/util/protobuf/linebasedcomms.pb.h"
@@ -68,6 +70,26 @@ class LineBasedInterface
     bool readline(std::string* s, AccessOrder order = OLDEST_FIRST);
     bool readline(protobuf::Datagram* msg, AccessOrder order = OLDEST_FIRST);
 
+    /// \brief moves up to max_lines (0 for no limit) buffered lines, oldest first, into msgs with a single lock of the read buffer
+    ///
+    /// The Datagrams already in msgs are exchanged with the buffered ones rather than copied, so reusing the same vector avoids allocation.
+    /// \return number of lines read (the new size of msgs)
+    std::size_t readlines(std::vector<protobuf::Datagram>* msgs, std::size_t max_lines = 0);
+
+    /// \brief read into a fixed size ring of reusable Datagrams instead of a growing queue (call before start())
+    ///
+    /// In this mode each read scans the received bytes for the delimiter directly and stores every complete line it finds under a single lock, reusing the memory of the Datagram it overwrites. If the ring is full, the oldest line is discarded (see in_dropped()).
+    /// \param ring_capacity maximum number of lines held; 0 returns to the default (unbounded queue) mode
+    void set_high_throughput(std::size_t ring_capacity);
+    bool high_throughput() const { return !in_ring_.empty(); }
+    /// \brief number of lines discarded because the ring was full (high throughput mode)
+    uint64 in_dropped() const;
+
+    /// \brief function called each time one or more new lines are available to readline() (call before start())
+    ///
+    /// The callback runs in the I/O thread of this interface, so it should do no more than wake up the thread that reads the lines.
+    void set_read_callback(const boost::function<void()>& callback) { read_callback_ = callback; }
+
     // write a line to the buffer
     void write(const std::string& s)
     {
@@ -97,15 +119,44 @@ class LineBasedInterface
     std::string delimiter_;
     boost::asio::io_service io_service_; // the main IO service that runs this connection
     std::deque<protobuf::Datagram> in_;  // buffered read data
-    boost::mutex in_mutex_;
+    mutable boost::mutex in_mutex_;
+
+    // buffered read data in high throughput mode: in_ring_size_ lines starting at in_ring_begin_
+    std::vector<protobuf::Datagram> in_ring_;
+    std::size_t in_ring_begin_;
+    std::size_t in_ring_size_;
+    uint64 in_dropped_;
+
+    boost::function<void()> read_callback_;
 
     template <typename ASIOAsyncReadStream> friend class LineBasedConnection;
 
     std::string& delimiter() { return delimiter_; }
     std::deque<goby::util::protobuf::Datagram>& in() { return in_; }
     boost::mutex& in_mutex() { return in_mutex_; }
+    // call with in_mutex() unlocked
+    void notify_read()
+    {
+        if (read_callback_)
+            read_callback_();
+    }
+
+    // high throughput mode: slot for a new line, overwriting the oldest if the ring is full (call with in_mutex() locked)
+    protobuf::Datagram& in_ring_push()
+    {
+        if (in_ring_size_ == in_ring_.size())
+        {
+            in_ring_begin_ = (in_ring_begin_ + 1) % in_ring_.size();
+            --in_ring_size_;
+            ++in_dropped_;
+        }
+        return in_ring_[(in_ring_begin_ + in_ring_size_++) % in_ring_.size()];
+    }
 
   private:
+    // high throughput mode: removes a line from the ring (call with in_mutex_ locked and in_ring_size_ > 0)
+    protobuf::Datagram& in_ring_pop(AccessOrder order);
+
     class IOLauncher
     {
       public:
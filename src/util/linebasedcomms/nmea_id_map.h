@@ -0,0 +1,144 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef NMEAIDMap20181105H
+#define NMEAIDMap20181105H
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "goby/util/primitive_types.h"
+#include "goby/util/linebasedcomms/nmea_tokenizer.h"
+
+namespace goby
+{
+namespace util
+{
+/// \brief Maps short NMEA identifiers (up to eight characters, such as the sentence id "DRQ" or the whole talker "$CADRQ") to values using a perfect (collision free) hash, so a lookup is one division and one comparison with no allocation.
+///
+/// The hash table is rebuilt on the first lookup after an insert(), so fill the map during setup.
+template <typename Value> class NMEAIDMap
+{
+  public:
+    typedef std::pair<std::string, Value> value_type;
+
+    NMEAIDMap() : modulus_(1), stale_(false) {}
+
+    void insert(const value_type& entry) { insert(entry.first, entry.second); }
+
+    /// \brief adds id, or replaces its value if already present
+    /// \throw std::invalid_argument if id is empty or longer than eight characters
+    void insert(const std::string& id, const Value& value)
+    {
+        goby::uint64 k;
+        if (!key(id.data(), id.size(), &k))
+            throw std::invalid_argument("NMEAIDMap: id must be 1-8 characters: '" + id + "'");
+
+        for (typename std::vector<Entry>::iterator it = entries_.begin(), end = entries_.end();
+             it != end; ++it)
+        {
+            if (it->key == k)
+            {
+                it->value = value;
+                return;
+            }
+        }
+        entries_.push_back(Entry(k, value));
+        stale_ = true;
+    }
+
+    /// \return pointer to the value for id, or 0 if id has not been inserted
+    const Value* find(const NMEAField& id) const { return find(id.data(), id.size()); }
+    const Value* find(const std::string& id) const { return find(id.data(), id.size()); }
+    const Value* find(const char* id, std::size_t size) const
+    {
+        goby::uint64 k;
+        if (entries_.empty() || !key(id, size, &k))
+            return 0;
+        if (stale_)
+            rebuild();
+        int index = slots_[k % modulus_];
+        return (index >= 0 && entries_[index].key == k) ? &entries_[index].value : 0;
+    }
+
+    /// \return value for id, or default_value if id has not been inserted
+    Value find_or(const NMEAField& id, const Value& default_value) const
+    {
+        const Value* value = find(id);
+        return value ? *value : default_value;
+    }
+
+    std::size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+  private:
+    struct Entry
+    {
+        Entry(goby::uint64 k, const Value& v) : key(k), value(v) {}
+        goby::uint64 key;
+        Value value;
+    };
+
+    // packs the (at most eight) characters into an integer; ids never contain '\0'
+    static bool key(const char* id, std::size_t size, goby::uint64* k)
+    {
+        if (size == 0 || size > sizeof(goby::uint64))
+            return false;
+        *k = 0;
+        for (std::size_t i = 0; i < size; ++i)
+            *k = (*k << 8) | static_cast<unsigned char>(id[i]);
+        return true;
+    }
+
+    // finds the smallest modulus that maps every key to a different slot
+    void rebuild() const
+    {
+        std::vector<goby::uint64> slots(entries_.size());
+        for (modulus_ = entries_.size();; ++modulus_)
+        {
+            for (std::size_t i = 0, n = entries_.size(); i < n; ++i)
+                slots[i] = entries_[i].key % modulus_;
+            std::sort(slots.begin(), slots.end());
+            if (std::adjacent_find(slots.begin(), slots.end()) == slots.end())
+                break;
+        }
+
+        slots_.assign(modulus_, -1);
+        for (std::size_t i = 0, n = entries_.size(); i < n; ++i)
+            slots_[entries_[i].key % modulus_] = i;
+        stale_ = false;
+    }
+
+    std::vector<Entry> entries_;
+
+    mutable goby::uint64 modulus_;
+    // index into entries_ for each key % modulus_, or -1
+    mutable std::vector<int> slots_;
+    mutable bool stale_;
+};
+} // namespace util
+} // namespace goby
+
+#endif
@@ -0,0 +1,130 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cctype>
+
+#include "nmea_tokenizer.h"
+
+namespace
+{
+// value of a hexadecimal digit, or -1
+int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    else if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    else
+        return -1;
+}
+} // namespace
+
+void goby::util::NMEATokenizer::parse(const char* begin, const char* end,
+                                      NMEASentence::strategy cs_strat /*= VALIDATE*/)
+{
+    size_ = 0;
+    has_checksum_ = false;
+    checksum_ = 0;
+
+    // Silently drop leading/trailing whitespace if present.
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(*(end - 1)))) --end;
+    message_ = NMEAField(begin, end - begin);
+
+    if (begin == end)
+        throw bad_nmea_sentence("NMEASentence: no message provided.");
+    if (*begin != '$' && *begin != '!')
+        throw bad_nmea_sentence("NMEASentence: no $ or !: '" + message_.str() + "'.");
+
+    // Check if the checksum exists and is correctly placed, and strip it.
+    const char* body_end = end;
+    unsigned cs = 0;
+    if (end - begin > 3 && *(end - 3) == '*')
+    {
+        int high = hex_value(*(end - 2)), low = hex_value(*(end - 1));
+        if (high >= 0 && low >= 0)
+        {
+            has_checksum_ = true;
+            cs = (high << 4) | low;
+        }
+        body_end = end - 3;
+    }
+
+    if (cs_strat == NMEASentence::REQUIRE && !has_checksum_)
+        throw bad_nmea_sentence("NMEASentence: no checksum: '" +
+                                std::string(begin, body_end) + "'.");
+
+    // split on commas and calculate the checksum (of the characters after the
+    // $ up to the first *) in one pass
+    bool in_checksum = true;
+    const char* field_begin = begin;
+    for (const char* p = begin + 1; p <= body_end; ++p)
+    {
+        if (p == body_end || *p == ',')
+        {
+            NMEAField field(field_begin, p - field_begin);
+            if (size_ < fields_.size())
+                fields_[size_] = field;
+            else
+                fields_.push_back(field);
+            ++size_;
+            field_begin = p + 1;
+        }
+
+        if (p < body_end)
+        {
+            if (*p == '*')
+                in_checksum = false;
+            if (in_checksum)
+                checksum_ ^= *p;
+        }
+    }
+
+    if (has_checksum_ &&
+        (cs_strat == NMEASentence::REQUIRE || cs_strat == NMEASentence::VALIDATE) &&
+        checksum_ != cs)
+        throw bad_nmea_sentence("NMEASentence: bad checksum: '" + std::string(begin, body_end) +
+                                "'.");
+
+    if (NMEASentence::enforce_talker_length && fields_[0].size() != 6)
+        throw bad_nmea_sentence("NMEASentence: bad talker length '" +
+                                std::string(begin, body_end) + "'.");
+}
+
+void goby::util::NMEATokenizer::message_cs(std::string* out) const
+{
+    static const char hex_digits[] = "0123456789ABCDEF";
+    const NMEAField bare = message_no_cs();
+    out->reserve(bare.size() + 3);
+    out->assign(bare.data(), bare.size());
+    *out += '*';
+    *out += hex_digits[checksum_ >> 4];
+    *out += hex_digits[checksum_ & 0xF];
+}
+
+void goby::util::NMEATokenizer::to_sentence(NMEASentence* nmea) const
+{
+    nmea->resize(size_);
+    for (std::size_t i = 0; i < size_; ++i) (*nmea)[i].assign(fields_[i].data(), fields_[i].size());
+}
@@ -0,0 +1,157 @@
+// Copyright 2009-2018 Toby Schneider (http://gobysoft.org/index.wt/people/toby)
+//                     GobySoft, LLC (2013-)
+//                     Massachusetts Institute of Technology (2007-2014)
+//                     Community contributors (see AUTHORS file)
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef NMEATokenizer20181105H
+#define NMEATokenizer20181105H
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "goby/util/as.h"
+#include "goby/util/linebasedcomms/nmea_sentence.h"
+
+namespace goby
+{
+namespace util
+{
+/// \brief Part of an NMEA sentence (e.g. one field). Refers to the characters of the original line rather than copying them, so the line must outlive the NMEAField.
+class NMEAField
+{
+  public:
+    NMEAField() : data_(0), size_(0) {}
+    NMEAField(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    char operator[](std::size_t i) const { return data_[i]; }
+
+    /// \brief copy of the characters (fields short enough for the small string buffer of std::string do not allocate)
+    std::string str() const { return std::string(data_, size_); }
+    template <typename T> T as() const { return goby::util::as<T>(str()); }
+
+    /// \brief subrange starting at pos of at most n characters
+    NMEAField substr(std::size_t pos, std::size_t n = std::string::npos) const
+    {
+        if (pos > size_)
+            pos = size_;
+        return NMEAField(data_ + pos, std::min(n, size_ - pos));
+    }
+
+    bool operator==(const NMEAField& other) const
+    {
+        return size_ == other.size_ && std::memcmp(data_, other.data_, size_) == 0;
+    }
+    bool operator==(const char* s) const
+    {
+        return std::strncmp(data_, s, size_) == 0 && s[size_] == '\0';
+    }
+    bool operator==(const std::string& s) const
+    {
+        return size_ == s.size() && std::memcmp(data_, s.data(), size_) == 0;
+    }
+    template <typename T> bool operator!=(const T& other) const { return !(*this == other); }
+
+  private:
+    const char* data_;
+    std::size_t size_;
+};
+
+/// \brief Splits an NMEA sentence into NMEAFields without copying it.
+///
+/// Memory is only allocated when a line has more fields than any line the tokenizer has parsed before. Accepts the same sentences as NMEASentence(std::string, strategy): the checksum is validated in the same pass that finds the commas. The fields refer to the line given to parse(), so it must remain unchanged while they are used. A tokenizer can be reused for any number of lines.
+class NMEATokenizer
+{
+  public:
+    NMEATokenizer() : size_(0), has_checksum_(false), checksum_(0) {}
+
+    /// \brief tokenize a line (leading and trailing whitespace are ignored)
+    ///
+    /// \throw bad_nmea_sentence if the line is not a valid NMEA sentence for the given strategy
+    void parse(const std::string& line, NMEASentence::strategy cs_strat = NMEASentence::VALIDATE)
+    {
+        parse(line.data(), line.data() + line.size(), cs_strat);
+    }
+    void parse(const char* line, NMEASentence::strategy cs_strat = NMEASentence::VALIDATE)
+    {
+        parse(line, line + std::strlen(line), cs_strat);
+    }
+    void parse(const char* begin, const char* end,
+               NMEASentence::strategy cs_strat = NMEASentence::VALIDATE);
+
+    /// \brief number of fields (including the talker, e.g. "$CADRQ")
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const NMEAField& operator[](std::size_t i) const { return fields_[i]; }
+    /// \throw std::out_of_range (as NMEASentence::at())
+    const NMEAField& at(std::size_t i) const
+    {
+        if (i >= size_)
+            throw std::out_of_range("NMEATokenizer: no field " + goby::util::as<std::string>(i));
+        return fields_[i];
+    }
+    const NMEAField& front() const { return at(0); }
+
+    template <typename T> T as(std::size_t i) const { return at(i).as<T>(); }
+
+    // first two after the $ (CC)
+    NMEAField talker_id() const { return empty() ? NMEAField() : fields_[0].substr(1, 2); }
+
+    // last three (CFG)
+    NMEAField sentence_id() const { return empty() ? NMEAField() : fields_[0].substr(3); }
+
+    /// \brief the sentence as given, including the checksum (if any) but not surrounding whitespace
+    const NMEAField& message() const { return message_; }
+
+    /// \brief the sentence as given without the checksum
+    NMEAField message_no_cs() const
+    {
+        return has_checksum_ ? message_.substr(0, message_.size() - 3) : message_;
+    }
+
+    /// \brief true if the sentence ended with a valid *HH checksum field
+    bool has_checksum() const { return has_checksum_; }
+    /// \brief checksum calculated from the sentence (as NMEASentence::checksum())
+    unsigned char checksum() const { return checksum_; }
+
+    /// \brief writes the sentence with its calculated checksum (as NMEASentence::message()) into *out, reusing its storage
+    void message_cs(std::string* out) const;
+
+    /// \brief copies the fields into an NMEASentence, reusing its existing strings
+    void to_sentence(NMEASentence* nmea) const;
+
+  private:
+    // grows to the largest number of fields seen, and is reused (fields past size_ are stale)
+    std::vector<NMEAField> fields_;
+    std::size_t size_;
+    NMEAField message_;
+    bool has_checksum_;
+    unsigned char checksum_;
+};
+} // namespace util
+} // namespace goby
+
+#endif